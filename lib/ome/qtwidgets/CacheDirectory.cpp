@@ -0,0 +1,152 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/CacheDirectory.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStandardPaths>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    CacheDirectory::CacheDirectory(const QString& subdirectory):
+      subdirectory(subdirectory),
+      mutex(),
+      initialised(false),
+      directory()
+    {
+    }
+
+    QString
+    CacheDirectory::get() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!initialised)
+        {
+          QString base(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+          if (!base.isEmpty())
+            directory = base + "/" + subdirectory;
+          initialised = true;
+        }
+      return directory;
+    }
+
+    void
+    CacheDirectory::set(const QString& directory)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->directory = directory;
+      initialised = true;
+    }
+
+    QString
+    CacheDirectory::file(const QString& key,
+                         const QString& suffix) const
+    {
+      QString dir(get());
+      if (dir.isEmpty())
+        return QString();
+
+      QString hash(QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()));
+      return dir + "/" + hash + suffix;
+    }
+
+    FileIdentity::FileIdentity():
+      path(),
+      size(-1),
+      modified(-1)
+    {
+    }
+
+    FileIdentity::FileIdentity(const QString& file):
+      path(),
+      size(-1),
+      modified(-1)
+    {
+      QFileInfo info(file);
+      if (info.exists())
+        {
+          path = info.canonicalFilePath();
+          size = info.size();
+          modified = info.lastModified().toMSecsSinceEpoch();
+        }
+    }
+
+    bool
+    FileIdentity::operator== (const FileIdentity& rhs) const
+    {
+      return !path.isEmpty() &&
+        path == rhs.path &&
+        size == rhs.size &&
+        modified == rhs.modified;
+    }
+
+    bool
+    FileIdentity::operator!= (const FileIdentity& rhs) const
+    {
+      return !(*this == rhs);
+    }
+
+    QDataStream&
+    operator<< (QDataStream&        stream,
+                const FileIdentity& identity)
+    {
+      stream << identity.path << identity.size << identity.modified;
+      return stream;
+    }
+
+    QDataStream&
+    operator>> (QDataStream&  stream,
+                FileIdentity& identity)
+    {
+      stream >> identity.path >> identity.size >> identity.modified;
+      return stream;
+    }
+
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,196 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_CACHEDIRECTORY_H
+#define OME_QTWIDGETS_CACHEDIRECTORY_H
+
+#include <mutex>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QString>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * A cache directory.
+     *
+     * By default, a named subdirectory of the standard cache
+     * location of the application.  The directory may be changed,
+     * or caching disabled, at any time.
+     *
+     * This class is thread-safe.
+     */
+    class CacheDirectory
+    {
+    public:
+      /**
+       * Constructor.
+       *
+       * @param subdirectory the default subdirectory of the
+       * standard cache location.
+       */
+      explicit
+      CacheDirectory(const QString& subdirectory);
+
+      CacheDirectory(const CacheDirectory&) = delete;
+
+      CacheDirectory&
+      operator= (const CacheDirectory&) = delete;
+
+      /**
+       * Get the directory.
+       *
+       * @returns the directory, or an empty string if caching is
+       * disabled or no cache location is available.
+       */
+      QString
+      get() const;
+
+      /**
+       * Set the directory.
+       *
+       * @param directory the directory, or an empty string to
+       * disable caching.
+       */
+      void
+      set(const QString& directory);
+
+      /**
+       * Get the path of a cache file.
+       *
+       * @param key the cache key; the file is named by its SHA-1
+       * hash.
+       * @param suffix the file suffix.
+       * @returns the file path, or an empty string if caching is
+       * disabled.
+       */
+      QString
+      file(const QString& key,
+           const QString& suffix) const;
+
+    private:
+      /// Default subdirectory.
+      QString subdirectory;
+      /// Lock for the directory.
+      mutable std::mutex mutex;
+      /// Directory set or defaulted?
+      mutable bool initialised;
+      /// The directory.
+      mutable QString directory;
+    };
+
+    /**
+     * Identity of a file, for validating cache entries.
+     *
+     * A cache entry derived from a file is valid while the canonical
+     * path, size and modification time of the file are unchanged.
+     */
+    struct FileIdentity
+    {
+      /// Canonical path.
+      QString path;
+      /// Size (bytes).
+      qint64 size;
+      /// Modification time (ms since the epoch).
+      qint64 modified;
+
+      /// Constructor (null identity).
+      FileIdentity();
+
+      /**
+       * Constructor.
+       *
+       * @param file the file to identify.
+       */
+      explicit
+      FileIdentity(const QString& file);
+
+      /**
+       * Compare identities.
+       *
+       * @param rhs the identity to compare.
+       * @returns @c true if the identities match.
+       */
+      bool
+      operator== (const FileIdentity& rhs) const;
+
+      /**
+       * Compare identities.
+       *
+       * @param rhs the identity to compare.
+       * @returns @c true if the identities differ.
+       */
+      bool
+      operator!= (const FileIdentity& rhs) const;
+    };
+
+    /**
+     * Write a file identity.
+     *
+     * @param stream the stream to write to.
+     * @param identity the identity to write.
+     * @returns the stream.
+     */
+    QDataStream&
+    operator<< (QDataStream&        stream,
+                const FileIdentity& identity);
+
+    /**
+     * Read a file identity.
+     *
+     * @param stream the stream to read from.
+     * @param identity the identity to read.
+     * @returns the stream.
+     */
+    QDataStream&
+    operator>> (QDataStream&  stream,
+                FileIdentity& identity);
+
+  }
+}
+
+#endif // OME_QTWIDGETS_CACHEDIRECTORY_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,209 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_CAMERA2D_H
+#define OME_QTWIDGETS_CAMERA2D_H
+
+#include <cmath>
+
+#include <ome/qtwidgets/glm.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * 2D camera (modelview projection matrix manipulation).
+     *
+     * The camera state is expressed using the same integer units as
+     * the GLView2D slots (zoom and rotation are pixel drag
+     * distances), so that a camera may be copied from an interactive
+     * view and reused for offscreen rendering.
+     */
+    struct Camera2D
+    {
+      /// Projection type
+      enum ProjectionType
+        {
+          ORTHOGRAPHIC, ///< Orthographic projection.
+          PERSPECTIVE   ///< Perspective projection.
+        };
+
+      /// Constructor.
+      Camera2D():
+        projectionType(ORTHOGRAPHIC),
+        zoom(0),
+        xTran(0),
+        yTran(0),
+        zRot(0),
+        model(1.0f),
+        view(1.0f),
+        projection(1.0f)
+      {}
+
+      /// Projection type.
+      ProjectionType projectionType;
+      /// Zoom factor.
+      int zoom;
+      /// x translation
+      int xTran;
+      /// y translation.
+      int yTran;
+      /// Rotation factor.
+      int zRot;
+      /// Current model.
+      glm::mat4 model;
+      /// Current view.
+      glm::mat4 view;
+      /// Current projection.
+      glm::mat4 projection;
+
+      /**
+       * Get zoom factor.
+       *
+       * Convert linear signed zoom value to a factor (to the 10th
+       * power of the zoom value).
+       *
+       * @returns the zoom factor.
+       */
+      float
+      zoomfactor() const
+      {
+        return std::pow(10.0f, static_cast<float>(zoom)/1024.0f); /// @todo remove fixed size.
+      }
+
+      /**
+       * Get rotation factor.
+       *
+       * @returns the rotation factor (in radians).
+       */
+      float
+      rotation() const
+      {
+        return glm::radians(-static_cast<float>(zRot)/16.0f);
+      }
+
+      /**
+       * Update the view and projection matrices.
+       *
+       * The view is computed from the current translation, rotation
+       * and zoom, and the projection is sized to the specified
+       * render target size.
+       *
+       * @param width the render target width (pixels).
+       * @param height the render target height (pixels).
+       */
+      void
+      update(float width,
+             float height)
+      {
+        float zf = zoomfactor();
+
+        float xtr(static_cast<float>(xTran) / zf);
+        float ytr(static_cast<float>(yTran) / zf);
+
+        glm::vec3 tr(glm::rotateZ(glm::vec3(xtr, ytr, 0.0), rotation()));
+
+        view = glm::lookAt(glm::vec3(tr[0], tr[1], 5.0),
+                           glm::vec3(tr[0], tr[1], 0.0),
+                           glm::rotateZ(glm::vec3(0.0, 1.0, 0.0), rotation()));
+
+        float xrange = width / zf;
+        float yrange = height / zf;
+
+        projection = glm::ortho(-xrange, xrange,
+                                -yrange, yrange,
+                                0.0f, 10.0f);
+      }
+
+      /**
+       * Restrict the projection to a region of the render target.
+       *
+       * The region is magnified to fill the render target, so that
+       * a large image may be rendered in tiles.  Call after
+       * update().
+       *
+       * @param left the left edge (fraction of the target width).
+       * @param bottom the bottom edge (fraction of the target height).
+       * @param right the right edge (fraction of the target width).
+       * @param top the top edge (fraction of the target height).
+       */
+      void
+      crop(float left,
+           float bottom,
+           float right,
+           float top)
+      {
+        // Region in normalised device coordinates.
+        float l = (left * 2.0f) - 1.0f;
+        float r = (right * 2.0f) - 1.0f;
+        float b = (bottom * 2.0f) - 1.0f;
+        float t = (top * 2.0f) - 1.0f;
+
+        glm::mat4 region(1.0f);
+        region = glm::translate(region, glm::vec3(-(r + l) / (r - l), -(t + b) / (t - b), 0.0f));
+        region = glm::scale(region, glm::vec3(2.0f / (r - l), 2.0f / (t - b), 1.0f));
+        projection = region * projection;
+      }
+
+      /**
+       * Get modelview projection matrix.
+       *
+       * The separate model, view and projection matrices are
+       * combined to form a single matrix.
+       *
+       * @returns the modelview projection matrix.
+       */
+      glm::mat4
+      mvp() const
+      {
+        return projection * view * model;
+      }
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_CAMERA2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,626 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include <ome/files/VariantPixelBuffer.h>
+
+#include <ome/qtwidgets/CacheDirectory.h>
+#include <ome/qtwidgets/DatasetStatistics.h>
+#include <ome/qtwidgets/Trace.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+
+using ome::files::dimension_size_type;
+using ome::qtwidgets::CacheDirectory;
+using ome::qtwidgets::FileIdentity;
+using ome::qtwidgets::Histogram;
+
+namespace
+{
+
+  // Cache file identification.
+  const quint32 cache_magic = 0x4f4d5153; // "OMQS"
+  const quint32 cache_version = 1;
+
+  // Bins retained per plane for types which are not binned exactly.
+  const std::size_t compact_bins = 1024U;
+
+  CacheDirectory cache_directory("statistics");
+
+  /*
+   * Reduce a histogram channel to fewer bins by summing adjacent
+   * bins.
+   */
+  Histogram::Channel
+  reduce(const Histogram::Channel& channel,
+         std::size_t               nbins)
+  {
+    Histogram::Channel ret;
+    const std::size_t factor = std::max<std::size_t>(1U, (channel.bins.size() + nbins - 1) / nbins);
+    ret.bins.assign((channel.bins.size() + factor - 1) / factor, 0U);
+    for (std::size_t b = 0; b < channel.bins.size(); ++b)
+      ret.bins[b / factor] += channel.bins[b];
+    ret.min = channel.min;
+    ret.width = channel.width * static_cast<double>(factor);
+    ret.total = channel.total;
+    ret.exact = false;
+    return ret;
+  }
+
+  void
+  write_channel(QDataStream&              stream,
+                const Histogram::Channel& channel)
+  {
+    stream << channel.exact << channel.min << channel.width
+           << static_cast<quint64>(channel.total)
+           << static_cast<quint32>(channel.bins.size());
+    for (const auto& count : channel.bins)
+      stream << static_cast<quint64>(count);
+  }
+
+  void
+  read_channel(QDataStream&        stream,
+               Histogram::Channel& channel)
+  {
+    quint64 total;
+    quint32 nbins;
+    stream >> channel.exact >> channel.min >> channel.width >> total >> nbins;
+    channel.total = total;
+    if (stream.status() != QDataStream::Ok || nbins > (1U << 24))
+      {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return;
+      }
+    channel.bins.resize(nbins);
+    for (auto& count : channel.bins)
+      {
+        quint64 c;
+        stream >> c;
+        count = c;
+      }
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    DatasetStatistics::DatasetStatistics(ReaderFactory                   factory,
+                                         ome::files::dimension_size_type series,
+                                         QObject                        *parent):
+      QObject(parent),
+      pool(std::make_shared<ReaderPool>(factory)),
+      series(series),
+      planeCount(0),
+      channelCount(0),
+      planeChannels(),
+      nextPlane(0),
+      donePlanes(0),
+      failedPlanes(0),
+      cancelled(false),
+      complete(false),
+      cached(false),
+      controller(),
+      mutex(),
+      planes(),
+      channels(),
+      compact()
+    {
+    }
+
+    DatasetStatistics::DatasetStatistics(std::shared_ptr<ReaderPool>     pool,
+                                         ome::files::dimension_size_type series,
+                                         QObject                        *parent):
+      QObject(parent),
+      pool(pool),
+      series(series),
+      planeCount(0),
+      channelCount(0),
+      planeChannels(),
+      nextPlane(0),
+      donePlanes(0),
+      failedPlanes(0),
+      cancelled(false),
+      complete(false),
+      cached(false),
+      controller(),
+      mutex(),
+      planes(),
+      channels(),
+      compact()
+    {
+    }
+
+    DatasetStatistics::~DatasetStatistics()
+    {
+      cancel();
+    }
+
+    void
+    DatasetStatistics::start(unsigned int threads)
+    {
+      if (controller.joinable() || complete)
+        return;
+
+      if (!threads)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+      cancelled = false;
+      controller = std::thread(&DatasetStatistics::run, this, threads);
+    }
+
+    void
+    DatasetStatistics::cancel()
+    {
+      cancelled = true;
+      if (controller.joinable())
+        controller.join();
+    }
+
+    bool
+    DatasetStatistics::isComplete() const
+    {
+      return complete;
+    }
+
+    bool
+    DatasetStatistics::isCached() const
+    {
+      return cached;
+    }
+
+    ome::files::dimension_size_type
+    DatasetStatistics::getSeries() const
+    {
+      return series;
+    }
+
+    ome::files::dimension_size_type
+    DatasetStatistics::getPlaneCount() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return planeCount;
+    }
+
+    DatasetStatistics::PlaneStatistics
+    DatasetStatistics::getPlaneStatistics(ome::files::dimension_size_type plane) const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (plane < planes.size())
+        return planes[plane];
+      return PlaneStatistics();
+    }
+
+    Histogram
+    DatasetStatistics::getChannelHistogram(ome::files::dimension_size_type channel) const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (channel >= channels.size())
+        return Histogram();
+      if (!channels[channel].empty())
+        return Histogram(channels[channel]);
+      return Histogram(mergeCompact(channel));
+    }
+
+    std::pair<double, double>
+    DatasetStatistics::getChannelRange(ome::files::dimension_size_type channel,
+                                       double                          saturation) const
+    {
+      Histogram histogram(getChannelHistogram(channel));
+      if (!histogram.channels())
+        return std::make_pair(0.0, 0.0);
+      return histogram.range(0, saturation);
+    }
+
+    QString
+    DatasetStatistics::cacheDirectory()
+    {
+      return cache_directory.get();
+    }
+
+    void
+    DatasetStatistics::setCacheDirectory(const QString& directory)
+    {
+      cache_directory.set(directory);
+    }
+
+    void
+    DatasetStatistics::run(unsigned int threads)
+    {
+      QString file;
+      try
+        {
+          ReaderPool::Lease reader(pool->acquire(series));
+          if (!reader)
+            return;
+
+          const boost::optional<boost::filesystem::path>& current(reader->getCurrentFile());
+          if (current)
+            file = QString::fromStdString(current->string());
+
+          std::lock_guard<std::mutex> lock(mutex);
+          planeCount = reader->getImageCount();
+          channelCount = reader->getEffectiveSizeC();
+          planeChannels.resize(planeCount);
+          for (dimension_size_type p = 0; p < planeCount; ++p)
+            planeChannels[p] = reader->getZCTCoords(p)[1];
+          planes.assign(planeCount, PlaneStatistics());
+          channels.assign(channelCount, std::vector<Histogram::Channel>());
+          compact.assign(planeCount, std::vector<Histogram::Channel>());
+        }
+      catch (const std::exception& e)
+        {
+          std::cerr << "DatasetStatistics: Failed to read metadata: " << e.what() << std::endl;
+          return;
+        }
+
+      if (!file.isEmpty() && load(file))
+        {
+          donePlanes = planeCount;
+          cached = true;
+          complete = true;
+          emit progress(planeCount, planeCount);
+          emit finished();
+          return;
+        }
+
+      nextPlane = 0;
+      donePlanes = 0;
+      failedPlanes = 0;
+      const unsigned int nthreads = static_cast<unsigned int>(std::max<dimension_size_type>(1U, std::min<dimension_size_type>(std::min<dimension_size_type>(threads, pool->getMaxReaders()), planeCount)));
+      std::vector<std::thread> workers;
+      for (unsigned int t = 1; t < nthreads; ++t)
+        workers.push_back(std::thread(&DatasetStatistics::work, this));
+      // The controller thread also processes planes.
+      work();
+      for (auto& worker : workers)
+        worker.join();
+
+      if (cancelled || donePlanes != planeCount)
+        return;
+
+      // Partial statistics must not be cached, since the cache is
+      // only invalidated when the dataset changes.
+      if (failedPlanes)
+        {
+          std::cerr << "DatasetStatistics: " << failedPlanes << " of " << planeCount
+                    << " planes could not be read; statistics are incomplete" << std::endl;
+          return;
+        }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (dimension_size_type c = 0; c < channelCount; ++c)
+          if (channels[c].empty())
+            channels[c] = mergeCompact(c);
+        compact.clear();
+      }
+
+      complete = true;
+      if (!file.isEmpty())
+        save(file);
+      emit finished();
+    }
+
+    void
+    DatasetStatistics::work()
+    {
+      setTraceThreadName("DatasetStatistics");
+
+      ome::files::VariantPixelBuffer buf;
+      while (!cancelled)
+        {
+          dimension_size_type plane = nextPlane++;
+          if (plane >= planeCount)
+            break;
+
+          // Lease a reader for each plane only, so that the plane
+          // loaders sharing the pool are not starved for the whole
+          // pass.
+          ReaderPool::Lease reader(pool->acquire(series));
+          if (!reader)
+            {
+              std::cerr << "DatasetStatistics: No reader available for plane " << plane << std::endl;
+              ++failedPlanes;
+            }
+          else
+            {
+              try
+                {
+                  {
+                    TraceScope trace("FormatReader::openBytes", "read");
+                    reader->openBytes(plane, buf);
+                  }
+                  reader.release();
+                  // Planes are processed in parallel, so bin each
+                  // plane on a single thread.
+                  Histogram histogram(buf, 1);
+                  addPlane(plane, planeChannels[plane], histogram);
+                }
+              catch (const std::exception& e)
+                {
+                  std::cerr << "DatasetStatistics: Failed to read plane " << plane << ": " << e.what() << std::endl;
+                  ++failedPlanes;
+                }
+            }
+
+          dimension_size_type done = ++donePlanes;
+          emit progress(done, planeCount);
+        }
+    }
+
+    void
+    DatasetStatistics::addPlane(ome::files::dimension_size_type plane,
+                                ome::files::dimension_size_type channel,
+                                const Histogram&                histogram)
+    {
+      PlaneStatistics stats;
+      std::vector<Histogram::Channel> reduced;
+      for (std::size_t s = 0; s < histogram.channels(); ++s)
+        {
+          stats.min.push_back(histogram.percentile(s, 0.0));
+          stats.max.push_back(histogram.percentile(s, 1.0));
+          stats.mean.push_back(histogram.mean(s));
+          if (!histogram.channel(s).exact)
+            reduced.push_back(reduce(histogram.channel(s), compact_bins));
+        }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      planes[plane] = stats;
+      if (!reduced.empty())
+        {
+          compact[plane].swap(reduced);
+          return;
+        }
+
+      // Exact types share the same bins, so merge directly.
+      std::vector<Histogram::Channel>& merged(channels[channel]);
+      if (merged.empty())
+        {
+          for (std::size_t s = 0; s < histogram.channels(); ++s)
+            merged.push_back(histogram.channel(s));
+          return;
+        }
+      for (std::size_t s = 0; s < std::min(merged.size(), histogram.channels()); ++s)
+        {
+          const Histogram::Channel& src(histogram.channel(s));
+          for (std::size_t b = 0; b < std::min(merged[s].bins.size(), src.bins.size()); ++b)
+            merged[s].bins[b] += src.bins[b];
+          merged[s].total += src.total;
+        }
+    }
+
+    std::vector<Histogram::Channel>
+    DatasetStatistics::mergeCompact(ome::files::dimension_size_type channel) const
+    {
+      std::vector<Histogram::Channel> ret;
+
+      std::size_t samples = 0;
+      for (dimension_size_type p = 0; p < compact.size(); ++p)
+        if (planeChannels[p] == channel)
+          samples = std::max(samples, compact[p].size());
+
+      for (std::size_t s = 0; s < samples; ++s)
+        {
+          // Range over all planes.
+          double vmin = std::numeric_limits<double>::max();
+          double vmax = -std::numeric_limits<double>::max();
+          for (dimension_size_type p = 0; p < compact.size(); ++p)
+            {
+              if (planeChannels[p] != channel || compact[p].size() <= s || !compact[p][s].total)
+                continue;
+              const Histogram::Channel& pc(compact[p][s]);
+              vmin = std::min(vmin, pc.min);
+              vmax = std::max(vmax, pc.min + (static_cast<double>(pc.bins.size()) * pc.width));
+            }
+
+          Histogram::Channel merged;
+          merged.bins.assign(Histogram::default_bins, 0U);
+          merged.total = 0;
+          merged.exact = false;
+          if (vmin > vmax)
+            vmin = vmax = 0.0;
+          merged.min = vmin;
+          merged.width = vmax > vmin ? (vmax - vmin) / static_cast<double>(Histogram::default_bins) : 1.0;
+
+          // Rebin at the plane bin centres.
+          const double last = static_cast<double>(Histogram::default_bins - 1);
+          for (dimension_size_type p = 0; p < compact.size(); ++p)
+            {
+              if (planeChannels[p] != channel || compact[p].size() <= s)
+                continue;
+              const Histogram::Channel& pc(compact[p][s]);
+              for (std::size_t b = 0; b < pc.bins.size(); ++b)
+                {
+                  if (!pc.bins[b])
+                    continue;
+                  const double centre = pc.min + ((static_cast<double>(b) + 0.5) * pc.width);
+                  const double pos = std::min(last, std::max(0.0, (centre - merged.min) / merged.width));
+                  merged.bins[static_cast<std::size_t>(pos)] += pc.bins[b];
+                  merged.total += pc.bins[b];
+                }
+            }
+          ret.push_back(merged);
+        }
+
+      return ret;
+    }
+
+    QString
+    DatasetStatistics::cacheFile(const QString& file) const
+    {
+      QFileInfo info(file);
+      return cache_directory.file(info.canonicalFilePath() + ":" + QString::number(series), ".stats");
+    }
+
+    bool
+    DatasetStatistics::load(const QString& file)
+    {
+      QString cache(cacheFile(file));
+      if (cache.isEmpty())
+        return false;
+
+      QFile in(cache);
+      if (!in.open(QIODevice::ReadOnly))
+        return false;
+
+      QDataStream header(&in);
+      header.setVersion(QDataStream::Qt_5_0);
+      quint32 magic, version;
+      FileIdentity identity;
+      quint64 cseries;
+      QByteArray compressed;
+      header >> magic >> version;
+      if (magic != cache_magic || version != cache_version)
+        return false;
+      header >> identity >> cseries >> compressed;
+      if (header.status() != QDataStream::Ok ||
+          identity != FileIdentity(file) ||
+          cseries != series)
+        return false;
+
+      QByteArray payload(qUncompress(compressed));
+      QDataStream stream(payload);
+      stream.setVersion(QDataStream::Qt_5_0);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      quint64 nplanes, nchannels;
+      stream >> nplanes >> nchannels;
+      if (stream.status() != QDataStream::Ok ||
+          nplanes != planeCount || nchannels != channelCount)
+        return false;
+
+      std::vector<PlaneStatistics> newplanes(planeCount);
+      for (auto& plane : newplanes)
+        {
+          quint32 samples;
+          stream >> samples;
+          if (stream.status() != QDataStream::Ok || samples > 256)
+            return false;
+          plane.min.resize(samples);
+          plane.max.resize(samples);
+          plane.mean.resize(samples);
+          for (quint32 s = 0; s < samples; ++s)
+            stream >> plane.min[s] >> plane.max[s] >> plane.mean[s];
+        }
+
+      std::vector<std::vector<Histogram::Channel>> newchannels(channelCount);
+      for (auto& channel : newchannels)
+        {
+          quint32 samples;
+          stream >> samples;
+          if (stream.status() != QDataStream::Ok || samples > 256)
+            return false;
+          channel.resize(samples);
+          for (auto& sample : channel)
+            read_channel(stream, sample);
+        }
+
+      if (stream.status() != QDataStream::Ok)
+        return false;
+
+      planes.swap(newplanes);
+      channels.swap(newchannels);
+      compact.clear();
+      return true;
+    }
+
+    void
+    DatasetStatistics::save(const QString& file) const
+    {
+      QString cache(cacheFile(file));
+      if (cache.isEmpty())
+        return;
+
+      QByteArray payload;
+      {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stream << static_cast<quint64>(planeCount) << static_cast<quint64>(channelCount);
+        for (const auto& plane : planes)
+          {
+            stream << static_cast<quint32>(plane.min.size());
+            for (std::size_t s = 0; s < plane.min.size(); ++s)
+              stream << plane.min[s] << plane.max[s] << plane.mean[s];
+          }
+        for (const auto& channel : channels)
+          {
+            stream << static_cast<quint32>(channel.size());
+            for (const auto& sample : channel)
+              write_channel(stream, sample);
+          }
+      }
+
+      QDir().mkpath(QFileInfo(cache).absolutePath());
+      QSaveFile out(cache);
+      if (!out.open(QIODevice::WriteOnly))
+        {
+          std::cerr << "DatasetStatistics: Failed to write cache " << cache.toStdString() << std::endl;
+          return;
+        }
+
+      QDataStream header(&out);
+      header.setVersion(QDataStream::Qt_5_0);
+      header << cache_magic << cache_version
+             << FileIdentity(file)
+             << static_cast<quint64>(series)
+             << qCompress(payload);
+      if (!out.commit())
+        std::cerr << "DatasetStatistics: Failed to write cache " << cache.toStdString() << std::endl;
+    }
+
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
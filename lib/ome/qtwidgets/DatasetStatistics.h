@@ -0,0 +1,355 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_DATASETSTATISTICS_H
+#define OME_QTWIDGETS_DATASETSTATISTICS_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+
+#include <ome/qtwidgets/Histogram.h>
+#include <ome/qtwidgets/ReaderPool.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Intensity statistics for all planes of a series.
+     *
+     * Statistics are computed in the background: every plane of the
+     * series is decoded and binned by a pool of worker threads, which
+     * lease a reader from a ReaderPool for each plane, so that other
+     * users of the pool are not starved.  Per-plane minimum, maximum
+     * and mean values, and per-channel histograms merged over all
+     * planes, are recorded for each sample.  The channel histograms
+     * permit consistent contrast to be set for an entire dataset,
+     * for example a timelapse.
+     *
+     * Completed statistics are saved to a cache file keyed by the
+     * canonical path, size and modification time of the dataset, and
+     * by series.  If any plane could not be read, the statistics are
+     * not marked complete and are not cached.  If a valid cache entry exists when started, the
+     * statistics are loaded from the cache without reading any
+     * pixel data.
+     *
+     * The progress() and finished() signals are emitted from the
+     * background thread; connections to objects in other threads
+     * are queued.
+     */
+    class DatasetStatistics : public QObject
+    {
+      Q_OBJECT
+
+    public:
+      /// Reader factory.
+      typedef ReaderPool::ReaderFactory ReaderFactory;
+
+      /// Statistics of a single plane.
+      struct PlaneStatistics
+      {
+        /// Minimum value of each sample.
+        std::vector<double> min;
+        /// Maximum value of each sample.
+        std::vector<double> max;
+        /// Mean value of each sample.
+        std::vector<double> mean;
+      };
+
+      /**
+       * Constructor.
+       *
+       * @param factory the reader factory.
+       * @param series the image series.
+       * @param parent the parent of this object.
+       */
+      DatasetStatistics(ReaderFactory                   factory,
+                        ome::files::dimension_size_type series,
+                        QObject                        *parent = 0);
+
+      /**
+       * Constructor.
+       *
+       * The number of worker threads is limited by the maximum
+       * reader count of the pool.
+       *
+       * @param pool the reader pool.
+       * @param series the image series.
+       * @param parent the parent of this object.
+       */
+      DatasetStatistics(std::shared_ptr<ReaderPool>     pool,
+                        ome::files::dimension_size_type series,
+                        QObject                        *parent = 0);
+
+      /// Destructor.  Any running computation is cancelled.
+      ~DatasetStatistics();
+
+      /**
+       * Start computing statistics.
+       *
+       * Has no effect if already started.
+       *
+       * @param threads the number of worker threads, or zero to use
+       * the hardware concurrency.
+       */
+      void
+      start(unsigned int threads = 0);
+
+      /**
+       * Cancel computation.
+       *
+       * Blocks until all worker threads have stopped.  Incomplete
+       * statistics are not cached.
+       */
+      void
+      cancel();
+
+      /**
+       * Check if the statistics are complete.
+       *
+       * @returns @c true if all planes have been processed
+       * successfully.
+       */
+      bool
+      isComplete() const;
+
+      /**
+       * Check if the statistics were loaded from the cache.
+       *
+       * @returns @c true if loaded from the cache.
+       */
+      bool
+      isCached() const;
+
+      /**
+       * Get the image series.
+       *
+       * @returns the series.
+       */
+      ome::files::dimension_size_type
+      getSeries() const;
+
+      /**
+       * Get the number of planes.
+       *
+       * @returns the plane count, or zero if not yet known.
+       */
+      ome::files::dimension_size_type
+      getPlaneCount() const;
+
+      /**
+       * Get the statistics for a plane.
+       *
+       * @param plane the plane number.
+       * @returns the plane statistics; the vectors are empty if the
+       * plane has not yet been processed.
+       */
+      PlaneStatistics
+      getPlaneStatistics(ome::files::dimension_size_type plane) const;
+
+      /**
+       * Get the histogram of a channel over all planes.
+       *
+       * The histogram has one channel for each sample.  Only planes
+       * processed so far are included.
+       *
+       * @param channel the (effective) channel index.
+       * @returns the histogram.
+       */
+      Histogram
+      getChannelHistogram(ome::files::dimension_size_type channel) const;
+
+      /**
+       * Get the contrast range of a channel over all planes.
+       *
+       * @param channel the (effective) channel index.
+       * @param saturation the fraction of samples to saturate at
+       * each end.
+       * @returns the lower and upper sample values of the first
+       * sample.
+       */
+      std::pair<double, double>
+      getChannelRange(ome::files::dimension_size_type channel,
+                      double                          saturation) const;
+
+      /**
+       * Get the cache directory.
+       *
+       * @returns the directory used to store cached statistics.
+       */
+      static QString
+      cacheDirectory();
+
+      /**
+       * Set the cache directory.
+       *
+       * @param directory the directory used to store cached
+       * statistics, or an empty string to disable caching.
+       */
+      static void
+      setCacheDirectory(const QString& directory);
+
+    signals:
+      /**
+       * Signal progress.
+       *
+       * @param done the number of planes processed.
+       * @param total the total number of planes.
+       */
+      void
+      progress(quint64 done,
+               quint64 total);
+
+      /// Signal completion.
+      void
+      finished();
+
+    private:
+      /// Statistics computation (controller thread).
+      void
+      run(unsigned int threads);
+
+      /// Worker thread.
+      void
+      work();
+
+      /**
+       * Record the histogram of a plane.
+       *
+       * @param plane the plane number.
+       * @param channel the (effective) channel index.
+       * @param histogram the plane histogram.
+       */
+      void
+      addPlane(ome::files::dimension_size_type plane,
+               ome::files::dimension_size_type channel,
+               const Histogram&                histogram);
+
+      /**
+       * Merge compact plane histograms of a channel.
+       *
+       * Used for types which are not binned exactly, where each
+       * plane has its own bin range.  The lock must be held.
+       *
+       * @param channel the (effective) channel index.
+       * @returns the merged histogram channels.
+       */
+      std::vector<Histogram::Channel>
+      mergeCompact(ome::files::dimension_size_type channel) const;
+
+      /**
+       * Get the cache file for the dataset.
+       *
+       * @param file the dataset file.
+       * @returns the cache file, or an empty string if caching is
+       * disabled.
+       */
+      QString
+      cacheFile(const QString& file) const;
+
+      /**
+       * Load statistics from the cache.
+       *
+       * @param file the dataset file.
+       * @returns @c true if valid statistics were loaded.
+       */
+      bool
+      load(const QString& file);
+
+      /**
+       * Save statistics to the cache.
+       *
+       * @param file the dataset file.
+       */
+      void
+      save(const QString& file) const;
+
+      /// Reader pool.
+      std::shared_ptr<ReaderPool> pool;
+      /// Image series.
+      ome::files::dimension_size_type series;
+      /// Plane count (locked).
+      ome::files::dimension_size_type planeCount;
+      /// Effective channel count.
+      ome::files::dimension_size_type channelCount;
+      /// Channel index of each plane.
+      std::vector<ome::files::dimension_size_type> planeChannels;
+      /// Next plane to process.
+      std::atomic<ome::files::dimension_size_type> nextPlane;
+      /// Number of planes processed.
+      std::atomic<ome::files::dimension_size_type> donePlanes;
+      /// Number of planes which could not be read.
+      std::atomic<ome::files::dimension_size_type> failedPlanes;
+      /// Computation cancelled.
+      std::atomic<bool> cancelled;
+      /// Computation complete.
+      std::atomic<bool> complete;
+      /// Statistics loaded from the cache.
+      std::atomic<bool> cached;
+      /// Controller thread.
+      std::thread controller;
+      /// Lock for statistics.
+      mutable std::mutex mutex;
+      /// Per-plane statistics.
+      std::vector<PlaneStatistics> planes;
+      /// Per-channel histograms (one channel per sample).
+      std::vector<std::vector<Histogram::Channel>> channels;
+      /// Compact per-plane histograms of non-exact types, pending merge.
+      std::vector<std::vector<Histogram::Channel>> compact;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_DATASETSTATISTICS_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
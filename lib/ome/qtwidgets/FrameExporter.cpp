@@ -0,0 +1,519 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <ome/qtwidgets/FrameExporter.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTimerEvent>
+#include <QtGui/QImage>
+
+using ome::files::dimension_size_type;
+
+namespace
+{
+
+  // Planes decoded ahead of rendering.
+  const std::size_t read_ahead = 8;
+
+  // Time to wait for background decoding before decoding a plane
+  // on the GUI thread (ms).
+  const qint64 decode_timeout = 2000;
+
+  // Step interval while waiting for localisations, decoding,
+  // readback or encoding (ms); steps which make progress are
+  // followed immediately.
+  const int idle_interval = 5;
+
+  /*
+   * Get the path of a frame in an image sequence.
+   */
+  QString
+  frame_path(const QString& path,
+             quint64        index)
+  {
+    QFileInfo info(path);
+    QString suffix(info.suffix());
+    if (suffix.isEmpty())
+      suffix = "png";
+    return info.dir().filePath(QString("%1_%2.%3")
+                               .arg(info.completeBaseName())
+                               .arg(index, 5, 10, QChar('0'))
+                               .arg(suffix));
+  }
+
+  /*
+   * Greatest common divisor.
+   */
+  quint64
+  gcd(quint64 a,
+      quint64 b)
+  {
+    while (b != 0)
+      {
+        quint64 t = a % b;
+        a = b;
+        b = t;
+      }
+    return a;
+  }
+
+  /*
+   * Clamp and round a sample value to 8 bits.
+   */
+  inline uint8_t
+  to_byte(double value)
+  {
+    return static_cast<uint8_t>(std::min(255.0, std::max(0.0, std::round(value))));
+  }
+
+  /*
+   * Convert RGBA samples to planar full range YCbCr 4:2:0 (JPEG,
+   * BT.601).  Chroma is sited at the centre of each 2×2 block;
+   * blocks are clipped at odd image edges.
+   */
+  void
+  rgba_to_yuv420(const std::vector<uint8_t>& rgba,
+                 std::size_t                 width,
+                 std::size_t                 height,
+                 std::vector<uint8_t>&       yuv)
+  {
+    const std::size_t cwidth = (width + 1) / 2;
+    const std::size_t cheight = (height + 1) / 2;
+    yuv.resize((width * height) + (2 * cwidth * cheight));
+    uint8_t *ly = yuv.data();
+    uint8_t *cb = ly + (width * height);
+    uint8_t *cr = cb + (cwidth * cheight);
+
+    for (std::size_t y = 0; y < height; ++y)
+      {
+        const uint8_t *src = rgba.data() + (y * width * 4);
+        for (std::size_t x = 0; x < width; ++x, src += 4)
+          ly[(y * width) + x] = to_byte((0.299 * src[0]) + (0.587 * src[1]) + (0.114 * src[2]));
+      }
+
+    for (std::size_t cy = 0; cy < cheight; ++cy)
+      for (std::size_t cx = 0; cx < cwidth; ++cx)
+        {
+          double r = 0.0, g = 0.0, b = 0.0;
+          unsigned int count = 0;
+          for (std::size_t y = cy * 2; y < std::min(height, (cy * 2) + 2); ++y)
+            for (std::size_t x = cx * 2; x < std::min(width, (cx * 2) + 2); ++x)
+              {
+                const uint8_t *src = rgba.data() + (((y * width) + x) * 4);
+                r += src[0];
+                g += src[1];
+                b += src[2];
+                ++count;
+              }
+          r /= count;
+          g /= count;
+          b /= count;
+          cb[(cy * cwidth) + cx] = to_byte(128.0 - (0.168736 * r) - (0.331264 * g) + (0.5 * b));
+          cr[(cy * cwidth) + cx] = to_byte(128.0 + (0.5 * r) - (0.418688 * g) - (0.081312 * b));
+        }
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    FrameExporter::FrameExporter(std::shared_ptr<ome::files::FormatReader>  reader,
+                                 ome::files::dimension_size_type            series,
+                                 const QSize&                               size,
+                                 QObject                                   *parent):
+      QObject(parent),
+      reader(reader),
+      series(series),
+      size(size),
+      renderer(reader, series, size),
+      pool(),
+      loader(),
+      threads(0),
+      frameRate(25.0),
+      path(),
+      format(FORMAT_PNG),
+      camera(),
+      planes(),
+      min(0.0f),
+      max(1.0f),
+      rendered(0),
+      readback(0),
+      decodeWait(),
+      timer(),
+      clock(),
+      elapsed(0),
+      workers(),
+      mutex(),
+      condition(),
+      queue(),
+      stopping(false),
+      written(0),
+      failed(false),
+      fileMutex(),
+      file(),
+      converted(),
+      nextWrite(0)
+    {
+    }
+
+    FrameExporter::~FrameExporter()
+    {
+      cancel();
+    }
+
+    OffscreenRenderer2D&
+    FrameExporter::getRenderer()
+    {
+      return renderer;
+    }
+
+    void
+    FrameExporter::setReaderPool(std::shared_ptr<ReaderPool> pool)
+    {
+      this->pool = pool;
+      renderer.setReaderPool(pool);
+    }
+
+    void
+    FrameExporter::setEncoderThreads(unsigned int threads)
+    {
+      this->threads = threads;
+    }
+
+    void
+    FrameExporter::setFrameRate(double fps)
+    {
+      if (fps > 0.0)
+        frameRate = fps;
+    }
+
+    bool
+    FrameExporter::start(const QString&                                      path,
+                         Format                                              format,
+                         const Camera2D&                                     camera,
+                         const std::vector<ome::files::dimension_size_type>& planes,
+                         const glm::vec3&                                    min,
+                         const glm::vec3&                                    max,
+                         int                                                 lutRow)
+    {
+      if (isRunning())
+        return false;
+      if (!renderer.isValid())
+        {
+          std::cerr << "FrameExporter: Offscreen renderer is not usable" << std::endl;
+          return false;
+        }
+
+      this->path = path;
+      this->format = format;
+      this->camera = camera;
+      this->planes = planes;
+      this->min = min;
+      this->max = max;
+      renderer.setLUTRow(lutRow);
+      rendered = 0;
+      readback = 0;
+      decodeWait.invalidate();
+      written = 0;
+      failed = false;
+      nextWrite = 0;
+
+      if (format == FORMAT_Y4M)
+        {
+          file.setFileName(path);
+          if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+              std::cerr << "FrameExporter: Failed to open " << path.toStdString()
+                        << ": " << file.errorString().toStdString() << std::endl;
+              return false;
+            }
+
+          // Frame rate as a rational, to millihertz precision.
+          quint64 num = static_cast<quint64>(std::round(frameRate * 1000.0));
+          quint64 den = 1000;
+          quint64 divisor = gcd(num, den);
+          num /= divisor;
+          den /= divisor;
+          QByteArray header(QString("YUV4MPEG2 W%1 H%2 F%3:%4 Ip A1:1 C420jpeg\n")
+                            .arg(size.width()).arg(size.height())
+                            .arg(num).arg(den).toLatin1());
+          if (file.write(header) != header.size())
+            {
+              std::cerr << "FrameExporter: Failed to write " << path.toStdString() << std::endl;
+              file.close();
+              return false;
+            }
+        }
+
+      if (pool)
+        {
+          loader.reset(new PlaneLoader(pool, series, 0));
+          loader->request(std::vector<dimension_size_type>(planes.begin(),
+                                                           planes.begin() + static_cast<std::ptrdiff_t>(std::min(read_ahead, planes.size()))));
+        }
+
+      unsigned int nthreads = threads ? threads : std::max(1U, std::thread::hardware_concurrency());
+      stopping = false;
+      for (unsigned int i = 0; i < nthreads; ++i)
+        workers.push_back(std::thread(&FrameExporter::encode, this));
+
+      clock.start();
+      timer.start(0, this);
+      return true;
+    }
+
+    void
+    FrameExporter::cancel()
+    {
+      if (isRunning())
+        stop(false);
+    }
+
+    bool
+    FrameExporter::isRunning() const
+    {
+      return timer.isActive();
+    }
+
+    qint64
+    FrameExporter::getElapsed() const
+    {
+      return elapsed;
+    }
+
+    void
+    FrameExporter::timerEvent(QTimerEvent *event)
+    {
+      if (event->timerId() == timer.timerId())
+        step();
+      else
+        QObject::timerEvent(event);
+    }
+
+    void
+    FrameExporter::step()
+    {
+      const quint64 total = planes.size();
+
+      // Localisations must be loaded before the first frame is
+      // rendered; wait without blocking the event loop.
+      if (!renderer.updateLocalisations())
+        {
+          timer.start(idle_interval, this);
+          return;
+        }
+
+      const quint64 lastReadback = readback;
+      const quint64 lastRendered = rendered;
+
+      // Collect completed readbacks without waiting, limiting the
+      // encoder backlog so that memory use is bounded.
+      const std::size_t backlog = std::max(static_cast<std::size_t>(workers.size() * 2),
+                                           renderer.maxQueuedFrames());
+      while (renderer.queuedFrames())
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= backlog)
+              break;
+          }
+
+          Frame frame;
+          frame.index = readback;
+          if (!renderer.takeFrame(frame.pixels, false))
+            break;
+          ++readback;
+          if (frame.pixels.empty())
+            {
+              failed = true;
+              break;
+            }
+
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(frame));
+          }
+          condition.notify_one();
+        }
+
+      // Render further frames while readback buffers are free.
+      while (!failed && rendered < total &&
+             renderer.queuedFrames() < renderer.maxQueuedFrames())
+        {
+          dimension_size_type plane = planes[rendered];
+          std::shared_ptr<ome::files::VariantPixelBuffer> pixels;
+          if (loader)
+            {
+              pixels = loader->find(plane);
+              if (!pixels)
+                {
+                  // Wait for background decoding, but decode here if
+                  // it does not complete, e.g. if the reader failed.
+                  if (!decodeWait.isValid())
+                    decodeWait.start();
+                  if (decodeWait.elapsed() < decode_timeout)
+                    break;
+                }
+              decodeWait.invalidate();
+            }
+
+          renderer.queueFrame(camera, plane, min, max, pixels);
+          ++rendered;
+
+          if (loader)
+            {
+              std::vector<dimension_size_type>::const_iterator first(planes.begin() + static_cast<std::ptrdiff_t>(rendered));
+              std::vector<dimension_size_type>::const_iterator last(planes.begin() + static_cast<std::ptrdiff_t>(std::min(rendered + read_ahead, total)));
+              loader->request(std::vector<dimension_size_type>(first, last));
+            }
+        }
+
+      if (failed)
+        stop(false);
+      else if (written == total)
+        stop(true);
+      else
+        timer.start(readback != lastReadback || rendered != lastRendered ? 0 : idle_interval, this);
+    }
+
+    void
+    FrameExporter::stop(bool success)
+    {
+      timer.stop();
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      condition.notify_all();
+      for (auto& worker : workers)
+        worker.join();
+      workers.clear();
+
+      // Discard any frames in flight.
+      renderer.discardFrames();
+
+      loader.reset();
+      queue.clear();
+      converted.clear();
+      if (file.isOpen())
+        file.close();
+
+      elapsed = clock.elapsed();
+      emit finished(success);
+    }
+
+    void
+    FrameExporter::encode()
+    {
+      while (true)
+        {
+          Frame frame;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if (stopping)
+              break;
+            frame = std::move(queue.front());
+            queue.pop_front();
+          }
+
+          bool ok = (format == FORMAT_Y4M) ? writeY4M(frame) : writePNG(frame);
+          if (!ok)
+            failed = true;
+
+          quint64 done = ++written;
+          emit progress(done, planes.size());
+        }
+    }
+
+    bool
+    FrameExporter::writePNG(const Frame& frame) const
+    {
+      QImage image(frame.pixels.data(), size.width(), size.height(),
+                   size.width() * 4, QImage::Format_RGBA8888);
+      QString name(frame_path(path, frame.index));
+      if (!image.save(name, "PNG"))
+        {
+          std::cerr << "FrameExporter: Failed to write " << name.toStdString() << std::endl;
+          return false;
+        }
+      return true;
+    }
+
+    bool
+    FrameExporter::writeY4M(const Frame& frame)
+    {
+      std::vector<uint8_t> yuv;
+      rgba_to_yuv420(frame.pixels,
+                     static_cast<std::size_t>(size.width()),
+                     static_cast<std::size_t>(size.height()),
+                     yuv);
+
+      std::lock_guard<std::mutex> lock(fileMutex);
+      converted[frame.index].swap(yuv);
+
+      // Write all consecutive frames which are ready.
+      bool ok = true;
+      for (auto i = converted.begin();
+           i != converted.end() && i->first == nextWrite;
+           i = converted.erase(i), ++nextWrite)
+        {
+          static const char header[] = "FRAME\n";
+          const qint64 bytes = static_cast<qint64>(i->second.size());
+          if (file.write(header, sizeof(header) - 1) != static_cast<qint64>(sizeof(header) - 1) ||
+              file.write(reinterpret_cast<const char *>(i->second.data()), bytes) != bytes)
+            {
+              std::cerr << "FrameExporter: Failed to write " << path.toStdString()
+                        << ": " << file.errorString().toStdString() << std::endl;
+              ok = false;
+            }
+        }
+      return ok;
+    }
+
+  }
+}
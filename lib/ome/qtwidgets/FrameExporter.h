@@ -0,0 +1,365 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_FRAMEEXPORTER_H
+#define OME_QTWIDGETS_FRAMEEXPORTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/Camera2D.h>
+#include <ome/qtwidgets/OffscreenRenderer2D.h>
+#include <ome/qtwidgets/PlaneLoader.h>
+#include <ome/qtwidgets/ReaderPool.h>
+
+#include <QtCore/QBasicTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Export a sequence of planes as a movie or image sequence.
+     *
+     * Each plane is rendered with an OffscreenRenderer2D at the
+     * chosen resolution, and read back asynchronously through pixel
+     * buffer objects guarded by fences.  Completed frames are
+     * encoded by a pool of worker threads, either to a PNG file per
+     * frame, or to a single uncompressed YUV4MPEG2 (Y4M) stream,
+     * which may be played or transcoded with common video tools.
+     *
+     * Rendering is driven by a timer on the GUI thread, a few frames
+     * at a time, so the event loop is never blocked for long.  If a
+     * reader pool is set, planes are decoded ahead of rendering
+     * in the background.
+     *
+     * The progress() signal is emitted from the worker threads;
+     * connections to objects in other threads are queued.  The
+     * finished() signal is emitted from the GUI thread.
+     *
+     * @note The exporter must be constructed and used on the GUI
+     * thread, since it owns an OffscreenRenderer2D.
+     */
+    class FrameExporter : public QObject
+    {
+      Q_OBJECT
+
+    public:
+      /// Output format.
+      enum Format
+        {
+          FORMAT_PNG, ///< PNG image sequence.
+          FORMAT_Y4M  ///< Uncompressed YUV4MPEG2 4:2:0 stream.
+        };
+
+      /**
+       * Constructor.
+       *
+       * @param reader the image reader.
+       * @param series the image series.
+       * @param size the size of the exported frames (pixels).
+       * @param parent the parent of this object.
+       */
+      FrameExporter(std::shared_ptr<ome::files::FormatReader>  reader,
+                    ome::files::dimension_size_type            series,
+                    const QSize&                               size,
+                    QObject                                   *parent = 0);
+
+      /// Destructor.  Any running export is cancelled.
+      ~FrameExporter();
+
+      /**
+       * Get the offscreen renderer.
+       *
+       * May be used to set the visibility of the axes, grid and
+       * overlay, and the point localisations, before starting.
+       *
+       * @returns the renderer.
+       */
+      OffscreenRenderer2D&
+      getRenderer();
+
+      /**
+       * Set reader pool for background plane decoding.
+       *
+       * Planes which are not decoded in the background are also
+       * read with readers from the pool.
+       *
+       * @param pool the reader pool, or null to
+       * decode planes on the GUI thread.
+       */
+      void
+      setReaderPool(std::shared_ptr<ReaderPool> pool);
+
+      /**
+       * Set the number of encoder threads.
+       *
+       * @param threads the number of threads, or zero to use the
+       * hardware concurrency.
+       */
+      void
+      setEncoderThreads(unsigned int threads);
+
+      /**
+       * Set the frame rate recorded in movie files.
+       *
+       * @param fps the frame rate (frames per second).
+       */
+      void
+      setFrameRate(double fps);
+
+      /**
+       * Start exporting.
+       *
+       * For FORMAT_PNG, frames are written to files named from the
+       * path by inserting a zero-padded frame number before the
+       * extension, for example @c movie.png becomes @c
+       * movie_00000.png, @c movie_00001.png, etc.  For FORMAT_Y4M,
+       * all frames are written to the path.
+       *
+       * @param path the output path.
+       * @param format the output format.
+       * @param camera the camera to render with.
+       * @param planes the planes to render, in order.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @param lutRow the row of the shared LUT texture.
+       * @returns @c true if the export was started, or @c false if
+       * already running or the output could not be opened.
+       */
+      bool
+      start(const QString&                                      path,
+            Format                                              format,
+            const Camera2D&                                     camera,
+            const std::vector<ome::files::dimension_size_type>& planes,
+            const glm::vec3&                                    min,
+            const glm::vec3&                                    max,
+            int                                                 lutRow = 0);
+
+      /**
+       * Cancel exporting.
+       *
+       * Blocks until the encoder threads have stopped.  Frames
+       * already written are not removed.
+       */
+      void
+      cancel();
+
+      /**
+       * Check if an export is running.
+       *
+       * @returns @c true if running.
+       */
+      bool
+      isRunning() const;
+
+      /**
+       * Get the elapsed time of the last export.
+       *
+       * @returns the elapsed time (ms).
+       */
+      qint64
+      getElapsed() const;
+
+    signals:
+      /**
+       * Signal progress.
+       *
+       * @param done the number of frames written.
+       * @param total the total number of frames.
+       */
+      void
+      progress(quint64 done,
+               quint64 total);
+
+      /**
+       * Signal completion.
+       *
+       * @param success @c true if all frames were written, @c false
+       * on failure or cancellation.
+       */
+      void
+      finished(bool success);
+
+    protected:
+      /**
+       * Handle timer events.
+       *
+       * Used to render frames and collect readbacks.
+       *
+       * @param event the event to handle.
+       */
+      void
+      timerEvent(QTimerEvent *event);
+
+    private:
+      /// A frame read back and pending encoding.
+      struct Frame
+      {
+        /// Frame number.
+        quint64 index;
+        /// 8-bit RGBA samples, top to bottom.
+        std::vector<uint8_t> pixels;
+      };
+
+      /// Render queued planes and collect completed readbacks.
+      void
+      step();
+
+      /**
+       * Stop the encoder threads and close the output.
+       *
+       * @param success @c true if the export completed.
+       */
+      void
+      stop(bool success);
+
+      /// Encode frames (worker thread).
+      void
+      encode();
+
+      /**
+       * Write a PNG frame.
+       *
+       * @param frame the frame to write.
+       * @returns @c true on success.
+       */
+      bool
+      writePNG(const Frame& frame) const;
+
+      /**
+       * Write a Y4M frame.
+       *
+       * Frames are converted in parallel and written in order.
+       *
+       * @param frame the frame to write.
+       * @returns @c true on success.
+       */
+      bool
+      writeY4M(const Frame& frame);
+
+      /// The image reader.
+      std::shared_ptr<ome::files::FormatReader> reader;
+      /// The image series.
+      ome::files::dimension_size_type series;
+      /// Frame size.
+      QSize size;
+      /// Offscreen renderer.
+      OffscreenRenderer2D renderer;
+      /// Reader pool for background decoding.
+      std::shared_ptr<ReaderPool> pool;
+      /// Background plane decoder.
+      std::unique_ptr<PlaneLoader> loader;
+      /// Number of encoder threads.
+      unsigned int threads;
+      /// Frame rate recorded in movie files.
+      double frameRate;
+      /// Output path.
+      QString path;
+      /// Output format.
+      Format format;
+      /// Camera.
+      Camera2D camera;
+      /// Planes to render.
+      std::vector<ome::files::dimension_size_type> planes;
+      /// Minimum limits for linear contrast.
+      glm::vec3 min;
+      /// Maximum limits for linear contrast.
+      glm::vec3 max;
+      /// Number of frames rendered.
+      quint64 rendered;
+      /// Number of frames read back.
+      quint64 readback;
+      /// Time spent waiting for the next plane to be decoded.
+      QElapsedTimer decodeWait;
+      /// Render timer.
+      QBasicTimer timer;
+      /// Export duration.
+      QElapsedTimer clock;
+      /// Elapsed time of the last export (ms).
+      qint64 elapsed;
+      /// Encoder threads.
+      std::vector<std::thread> workers;
+      /// Lock for the encoder queue.
+      std::mutex mutex;
+      /// Signalled when frames are queued or when stopping.
+      std::condition_variable condition;
+      /// Frames pending encoding.
+      std::deque<Frame> queue;
+      /// Stop the encoder threads.
+      bool stopping;
+      /// Number of frames written.
+      std::atomic<quint64> written;
+      /// Export failed.
+      std::atomic<bool> failed;
+      /// Lock for the movie file.
+      std::mutex fileMutex;
+      /// Movie file.
+      QFile file;
+      /// Converted movie frames pending writing, by frame number.
+      std::map<quint64, std::vector<uint8_t>> converted;
+      /// Next movie frame to write.
+      quint64 nextWrite;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_FRAMEEXPORTER_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
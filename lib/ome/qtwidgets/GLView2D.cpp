@@ -37,16 +37,31 @@
  */
 
 #include <QtGui/QMouseEvent>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFramebufferObject>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+
+#include <ome/files/PixelBuffer.h>
+#include <ome/files/PixelProperties.h>
+#include <ome/files/VariantPixelBuffer.h>
 
 #include <ome/qtwidgets/GLView2D.h>
+#include <ome/qtwidgets/Histogram.h>
+#include <ome/qtwidgets/LUT.h>
+#include <ome/qtwidgets/TexelProperties.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
 #include <ome/qtwidgets/gl/Util.h>
 
 #include <ome/qtwidgets/glm.h>
 #include <ome/qtwidgets/gl/v33/V33Image2D.h>
 #include <ome/qtwidgets/gl/v33/V33Grid2D.h>
 #include <ome/qtwidgets/gl/v33/V33Axis2D.h>
+#include <ome/qtwidgets/gl/v33/V33Overlay2D.h>
+#include <ome/qtwidgets/gl/v33/V33PointCloud2D.h>
 
 #include <iostream>
 
@@ -55,9 +70,60 @@
 #pragma warning(disable : 4351)
 #endif
 
+using ome::qtwidgets::sample_value;
+
 namespace
 {
 
+  // Playback read-ahead duration (seconds).
+  const double read_ahead_time = 0.5;
+  // Minimum playback read-ahead (planes).
+  const quint64 min_read_ahead = 2;
+  // Maximum playback read-ahead (planes).
+  const quint64 max_read_ahead = 16;
+  // Maximum number of due frames searched for a decoded plane.
+  const quint64 max_frame_search = 256;
+
+  /*
+   * Append the samples of a single pixel of a VariantPixelBuffer.
+   *
+   * The buffer may only contain a single xy plane.
+   */
+  struct ProbeVisitor
+  {
+    std::size_t x;
+    std::size_t y;
+    QVector<double>& values;
+
+    ProbeVisitor(std::size_t      x,
+                 std::size_t      y,
+                 QVector<double>& values):
+      x(x),
+      y(y),
+      values(values)
+    {}
+
+    template<typename T>
+    void
+    operator() (const T& v)
+    {
+      typedef typename T::element_type::value_type value_type;
+
+      const ome::files::PixelBufferBase::size_type *shape = v->shape();
+      const boost::multi_array_types::index *strides = v->array().strides();
+
+      if (x >= shape[ome::files::DIM_SPATIAL_X] ||
+          y >= shape[ome::files::DIM_SPATIAL_Y])
+        return;
+
+      const value_type *pixel = v->array().origin() +
+        (static_cast<boost::multi_array_types::index>(x) * strides[ome::files::DIM_SPATIAL_X]) +
+        (static_cast<boost::multi_array_types::index>(y) * strides[ome::files::DIM_SPATIAL_Y]);
+      for (std::size_t s = 0; s < shape[ome::files::DIM_SUBCHANNEL]; ++s)
+        values.push_back(sample_value(pixel[static_cast<boost::multi_array_types::index>(s) * strides[ome::files::DIM_SUBCHANNEL]]));
+    }
+  };
+
   void
   qNormalizeAngle(int &angle)
   {
@@ -81,22 +147,65 @@ namespace ome
       camera(),
       mouseMode(MODE_ZOOM),
       etimer(),
+      quality(QUALITY_FULL),
+      samples(8),
+      interactiveScale(0.5f),
+      refineDelay(150),
+      refineTimer(),
+      fullfbo(),
+      interactivefbo(),
       cmin(0.0f),
       cmax(1.0f),
+      contrastPending(false),
+      contrastSaturation(0.001),
+      channelLUTs(),
+      statistics(),
+      loader(),
+      pendingPixels(),
+      pendingPlane(0),
+      planeRequested(false),
+      requestedPlane(0),
+      playbackDimension(PLAYBACK_T),
+      playbackRate(10.0),
+      achievedRate(0.0),
+      playbackTimer(),
+      playbackClock(),
+      playbackOrigin(0),
+      playbackShown(0),
+      droppedFrames(0),
+      rateFrames(0),
+      rateStart(0),
       plane(0),
       oldplane(-1),
       lastPos(0, 0),
       image(),
       axes(),
+      overlay(),
+      overlayVisible(true),
+      pointcloud(),
+      pointsFile(),
+      pointsColumns(2),
+      pointsXColumn(0),
+      pointsYColumn(1),
+      pointsPending(false),
       grid(),
       reader(reader),
-      series(series)
+      series(series),
+      info(SeriesInfo::get(reader, series))
     {
+      // The scene is rendered into an intermediate framebuffer and
+      // then copied to the window, which hence needs neither
+      // multisampling nor depth.
+      QSurfaceFormat format(requestedFormat());
+      format.setSamples(0);
+      format.setDepthBufferSize(0);
+      setFormat(format);
     }
 
     GLView2D::~GLView2D()
     {
       makeCurrent();
+      releaseFramebuffers();
     }
 
     QSize GLView2D::minimumSizeHint() const
@@ -163,6 +272,34 @@ namespace ome
       return plane;
     }
 
+    ome::files::dimension_size_type
+    GLView2D::getChannel() const
+    {
+      return info->getZCTCoords(plane)[1];
+    }
+
+    std::string
+    GLView2D::getChannelLUT(ome::files::dimension_size_type channel) const
+    {
+      std::map<ome::files::dimension_size_type, std::string>::const_iterator i = channelLUTs.find(channel);
+      if (i != channelLUTs.end())
+        return i->second;
+      return standardLUTNames().front();
+    }
+
+    void
+    GLView2D::setChannelLUT(ome::files::dimension_size_type channel,
+                            const std::string&              name)
+    {
+      if (standardLUTIndex(name) < 0)
+        {
+          std::cerr << "GLView2D: Unknown lookup table " << name << std::endl;
+          return;
+        }
+      channelLUTs[channel] = name;
+      renderLater();
+    }
+
     void
     GLView2D::setZoom(int zoom)
     {
@@ -216,6 +353,181 @@ namespace ome
       return mouseMode;
     }
 
+    void
+    GLView2D::setSamples(int samples)
+    {
+      if (this->samples != samples)
+        {
+          this->samples = samples;
+          makeCurrent();
+          releaseFramebuffers();
+          renderLater();
+        }
+    }
+
+    int
+    GLView2D::getSamples() const
+    {
+      return samples;
+    }
+
+    void
+    GLView2D::setInteractiveScale(float scale)
+    {
+      scale = glm::clamp(scale, 0.05f, 1.0f);
+      if (interactiveScale != scale)
+        {
+          interactiveScale = scale;
+          makeCurrent();
+          releaseFramebuffers();
+          renderLater();
+        }
+    }
+
+    float
+    GLView2D::getInteractiveScale() const
+    {
+      return interactiveScale;
+    }
+
+    void
+    GLView2D::setRefineDelay(int msec)
+    {
+      refineDelay = msec;
+    }
+
+    int
+    GLView2D::getRefineDelay() const
+    {
+      return refineDelay;
+    }
+
+    GLView2D::RenderQuality
+    GLView2D::getRenderQuality() const
+    {
+      return quality;
+    }
+
+    void
+    GLView2D::setOverlayVisible(bool visible)
+    {
+      if (overlayVisible != visible)
+        {
+          overlayVisible = visible;
+          renderLater();
+        }
+    }
+
+    bool
+    GLView2D::probe(const QPointF&   pos,
+                    QPointF&         imagepos,
+                    QVector<double>& values)
+    {
+      values.clear();
+
+      QSize s = size();
+      if (s.isEmpty() || !image)
+        return false;
+
+      // Window to normalised device to world coordinates.
+      glm::vec4 ndc((2.0f * static_cast<float>(pos.x()) / static_cast<float>(s.width())) - 1.0f,
+                    1.0f - (2.0f * static_cast<float>(pos.y()) / static_cast<float>(s.height())),
+                    0.0f, 1.0f);
+      glm::vec4 world(glm::inverse(camera.mvp()) * ndc);
+      world /= world.w;
+
+      const float sizeX = static_cast<float>(info->sizeX);
+      const float sizeY = static_cast<float>(info->sizeY);
+
+      // World to image coordinates.
+      imagepos = QPointF(world.x + (sizeX / 2.0f), (sizeY / 2.0f) - world.y);
+      if (imagepos.x() < 0.0 || imagepos.x() >= sizeX ||
+          imagepos.y() < 0.0 || imagepos.y() >= sizeY)
+        return false;
+      const std::size_t x = static_cast<std::size_t>(imagepos.x());
+      const std::size_t y = static_cast<std::size_t>(imagepos.y());
+
+      const SeriesInfo::Coords& zct(info->getZCTCoords(getPlane()));
+      const ome::files::dimension_size_type channels = info->effectiveSizeC;
+      const ome::files::dimension_size_type samples = info->samples;
+
+      for (ome::files::dimension_size_type c = 0; c < channels; ++c)
+        {
+          ome::files::dimension_size_type cplane = info->getIndex(zct[0], c, zct[2]);
+          std::shared_ptr<const ome::files::VariantPixelBuffer> buf;
+          if (cplane == getPlane())
+            buf = image->getPlaneBuffer();
+          else if (context())
+            {
+              std::shared_ptr<gl::Texture> cached(gl::SharedResources::get(context()).findPlane(reader, series, cplane));
+              if (cached)
+                buf = cached->pixels();
+            }
+
+          const int before = values.size();
+          if (buf)
+            {
+              ProbeVisitor v(x, y, values);
+              ome::compat::visit(v, buf->vbuffer());
+            }
+          if (values.size() == before)
+            values.insert(values.size(), static_cast<int>(samples),
+                          std::numeric_limits<double>::quiet_NaN());
+        }
+
+      return true;
+    }
+
+    void
+    GLView2D::setLocalisations(const QString& filename,
+                               unsigned int   columns,
+                               unsigned int   xcolumn,
+                               unsigned int   ycolumn)
+    {
+      pointsFile = filename;
+      pointsColumns = columns;
+      pointsXColumn = xcolumn;
+      pointsYColumn = ycolumn;
+      pointsPending = true;
+      renderLater();
+    }
+
+    bool
+    GLView2D::getOverlayVisible() const
+    {
+      return overlayVisible;
+    }
+
+    const Camera2D&
+    GLView2D::getCamera() const
+    {
+      return camera;
+    }
+
+    std::pair<glm::vec3, glm::vec3>
+    GLView2D::getContrastLimits() const
+    {
+      return std::make_pair(cmin, cmax);
+    }
+
+    int
+    GLView2D::getLUTRow() const
+    {
+      return std::max(0, standardLUTIndex(getChannelLUT(getChannel())));
+    }
+
+    void
+    GLView2D::getLocalisations(QString&      filename,
+                               unsigned int& columns,
+                               unsigned int& xcolumn,
+                               unsigned int& ycolumn) const
+    {
+      filename = pointsFile;
+      columns = pointsColumns;
+      xcolumn = pointsXColumn;
+      ycolumn = pointsYColumn;
+    }
+
 
     // Note fixed to one channel at the moment.
 
@@ -246,8 +558,214 @@ namespace ome
         setChannelMin(max);
     }
 
+    void
+    GLView2D::setStatistics(std::shared_ptr<DatasetStatistics> statistics)
+    {
+      this->statistics = statistics;
+    }
+
+    std::shared_ptr<DatasetStatistics>
+    GLView2D::getStatistics() const
+    {
+      return statistics;
+    }
+
+    void
+    GLView2D::setPlaneLoader(std::shared_ptr<PlaneLoader> loader)
+    {
+      if (loader && loader->getSeries() != series)
+        {
+          std::cerr << "GLView2D: Plane loader series " << loader->getSeries()
+                    << " does not match view series " << series << std::endl;
+          return;
+        }
+      if (this->loader)
+        {
+          disconnect(this->loader.get(), 0, this, 0);
+          this->loader->request(std::vector<ome::files::dimension_size_type>());
+        }
+      planeRequested = false;
+      this->loader = loader;
+      if (loader)
+        connect(loader.get(), SIGNAL(planeLoaded(quint64)), this, SLOT(planeLoaded(quint64)));
+      if (image)
+        image->setReaderPool(loader ? loader->getReaderPool() : std::shared_ptr<ReaderPool>());
+    }
+
+    std::shared_ptr<PlaneLoader>
+    GLView2D::getPlaneLoader() const
+    {
+      return loader;
+    }
+
+    bool
+    GLView2D::isPlaying() const
+    {
+      return playbackTimer.isActive();
+    }
+
+    GLView2D::PlaybackDimension
+    GLView2D::getPlaybackDimension() const
+    {
+      return playbackDimension;
+    }
+
+    ome::files::dimension_size_type
+    GLView2D::getPlaybackLength() const
+    {
+      ome::files::dimension_size_type length = 0;
+      playbackPlane(plane, 0, length);
+      return length;
+    }
+
+    std::vector<ome::files::dimension_size_type>
+    GLView2D::getPlaybackPlanes() const
+    {
+      ome::files::dimension_size_type length = 0;
+      std::vector<ome::files::dimension_size_type> planes;
+      planes.push_back(playbackPlane(plane, 0, length));
+      for (quint64 frame = 1; frame < length; ++frame)
+        planes.push_back(playbackPlane(plane, frame, length));
+
+      // Plane indices increase along any single dimension, so the
+      // first position is the smallest index.
+      std::rotate(planes.begin(),
+                  std::min_element(planes.begin(), planes.end()),
+                  planes.end());
+      return planes;
+    }
+
+    double
+    GLView2D::getPlaybackRate() const
+    {
+      return playbackRate;
+    }
+
+    double
+    GLView2D::getAchievedPlaybackRate() const
+    {
+      return achievedRate;
+    }
+
+    quint64
+    GLView2D::getDroppedFrames() const
+    {
+      return droppedFrames;
+    }
+
+    void
+    GLView2D::autoContrast(double saturation)
+    {
+      contrastSaturation = saturation;
+      contrastPending = false;
+      if (!applyAutoContrast())
+        {
+          // Defer until the plane is uploaded by render().
+          contrastPending = true;
+          renderLater();
+        }
+    }
+
+    bool
+    GLView2D::applyAutoContrast()
+    {
+      ome::xml::model::enums::PixelType pixeltype = info->pixelType;
+      ome::files::dimension_size_type rbpp = info->bitsPerPixel;
+      ome::files::dimension_size_type channel = info->getZCTCoords(getPlane())[1];
+
+      Histogram histogram;
+      if (statistics && statistics->isComplete() && statistics->getSeries() == series)
+        {
+          // Consistent contrast for all planes of the channel.
+          histogram = statistics->getChannelHistogram(channel);
+        }
+      else
+        {
+          std::shared_ptr<const ome::files::VariantPixelBuffer> buf;
+          if (image && image->getPlane() == getPlane())
+            buf = image->getPlaneBuffer();
+          if (!buf)
+            return false;
+          histogram.compute(*buf);
+        }
+
+      if (!histogram.channels() || !histogram.total(0))
+        return true;
+      std::pair<double, double> range(histogram.range(0, contrastSaturation));
+
+      // Convert raw sample values to the scaled normalized
+      // contrast limits used by the image renderer.
+      ome::files::dimension_size_type bpp = ome::files::bitsPerPixel(pixeltype);
+      const double correction = static_cast<double>(1 << (bpp - rbpp));
+      const double scale = correction * (255.0 * 16.0) / textureValueRange(pixeltype);
+
+      int min = static_cast<int>(std::floor(range.first * scale));
+      int max = static_cast<int>(std::ceil(range.second * scale));
+      if (max <= min)
+        max = min + 1;
+      // Set max first so that min is not clamped to the old max.
+      setChannelMax(max);
+      setChannelMin(min);
+      return true;
+    }
+
     void
     GLView2D::setPlane(ome::files::dimension_size_type plane)
+    {
+      // During playback, only planes which are ready are set.
+      if (loader && !isPlaying() && plane != this->plane && context())
+        {
+          makeCurrent();
+          gl::SharedResources& resources(gl::SharedResources::get(context()));
+          if (!resources.findPlane(reader, series, plane))
+            {
+              std::shared_ptr<ome::files::VariantPixelBuffer> pixels(loader->find(plane));
+              if (!pixels)
+                {
+                  // Replaces any outstanding request, so stale planes
+                  // are not decoded.
+                  planeRequested = true;
+                  requestedPlane = plane;
+                  loader->request(std::vector<ome::files::dimension_size_type>(1, plane));
+                  return;
+                }
+              pendingPixels = pixels;
+              pendingPlane = plane;
+            }
+        }
+
+      if (planeRequested)
+        {
+          planeRequested = false;
+          if (loader)
+            loader->request(std::vector<ome::files::dimension_size_type>());
+        }
+      displayPlane(plane);
+    }
+
+    void
+    GLView2D::planeLoaded(quint64 plane)
+    {
+      if (!planeRequested || plane != requestedPlane || !loader)
+        return;
+
+      std::shared_ptr<ome::files::VariantPixelBuffer> pixels(loader->find(plane));
+      if (!pixels)
+        return;
+
+      planeRequested = false;
+      pendingPixels = pixels;
+      pendingPlane = plane;
+      // If requested by paintGL(), the plane is unchanged and only
+      // the texture needs updating.
+      if (this->plane == plane)
+        renderLater();
+      else
+        displayPlane(plane);
+    }
+
+    void
+    GLView2D::displayPlane(ome::files::dimension_size_type plane)
     {
       if (this->plane != plane)
         {
@@ -257,13 +775,226 @@ namespace ome
         }
     }
 
+    void
+    GLView2D::play()
+    {
+      if (isPlaying())
+        return;
+      if (getPlaybackLength() < 2)
+        return;
+
+      planeRequested = false;
+      playbackOrigin = plane;
+      playbackShown = 0;
+      droppedFrames = 0;
+      rateFrames = 0;
+      rateStart = 0;
+      achievedRate = 0.0;
+      playbackClock.start();
+      playbackTimer.start(std::max(1, static_cast<int>(1000.0 / playbackRate)), this);
+      readAhead(0);
+      emit playbackStateChanged(true);
+    }
+
+    void
+    GLView2D::pause()
+    {
+      if (!isPlaying())
+        return;
+
+      playbackTimer.stop();
+      if (loader)
+        loader->request(std::vector<ome::files::dimension_size_type>());
+      emit playbackStateChanged(false);
+    }
+
+    void
+    GLView2D::setPlaybackDimension(PlaybackDimension dimension)
+    {
+      if (playbackDimension != dimension)
+        {
+          bool playing = isPlaying();
+          pause();
+          playbackDimension = dimension;
+          if (playing)
+            play();
+        }
+    }
+
+    void
+    GLView2D::setPlaybackRate(double fps)
+    {
+      if (!(fps > 0.0))
+        {
+          std::cerr << "GLView2D: Invalid playback rate " << fps << std::endl;
+          return;
+        }
+      if (playbackRate != fps)
+        {
+          // Restart from the current plane at the new rate.
+          bool playing = isPlaying();
+          pause();
+          playbackRate = fps;
+          if (playing)
+            play();
+        }
+    }
+
+    // No switch default to avoid -Wunreachable-code errors.
+    // However, this then makes -Wswitch-default complain.  Disable
+    // temporarily.
+#ifdef __GNUC__
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wswitch-default"
+#endif
+
+    ome::files::dimension_size_type
+    GLView2D::playbackPlane(ome::files::dimension_size_type  origin,
+                            quint64                          frame,
+                            ome::files::dimension_size_type& length) const
+    {
+      // Modulo dimension sizes.
+      ome::files::dimension_size_type mz = info->moduloZ;
+      ome::files::dimension_size_type mt = info->moduloT;
+      ome::files::dimension_size_type mc = info->moduloC;
+      SeriesInfo::Coords coords(info->getZCTCoords(origin));
+      ome::files::dimension_size_type& z(coords[0]);
+      ome::files::dimension_size_type& c(coords[1]);
+      ome::files::dimension_size_type& t(coords[2]);
+
+      switch(playbackDimension)
+        {
+        case PLAYBACK_Z:
+          length = info->sizeZ / mz;
+          z = (((z / mz) + frame) % length) * mz + (z % mz);
+          break;
+        case PLAYBACK_T:
+          length = info->sizeT / mt;
+          t = (((t / mt) + frame) % length) * mt + (t % mt);
+          break;
+        case PLAYBACK_MODULO_Z:
+          length = mz;
+          z = ((z / mz) * mz) + (((z % mz) + frame) % length);
+          break;
+        case PLAYBACK_MODULO_T:
+          length = mt;
+          t = ((t / mt) * mt) + (((t % mt) + frame) % length);
+          break;
+        case PLAYBACK_MODULO_C:
+          length = mc;
+          c = ((c / mc) * mc) + (((c % mc) + frame) % length);
+          break;
+        }
+
+      return info->getIndex(z, c, t);
+    }
+
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif
+
+    void
+    GLView2D::advancePlayback()
+    {
+      ome::files::dimension_size_type length = 0;
+      playbackPlane(playbackOrigin, 0, length);
+      if (length < 2 || !context())
+        {
+          pause();
+          return;
+        }
+
+      makeCurrent();
+      gl::SharedResources& resources(gl::SharedResources::get(context()));
+
+      const qint64 elapsed = playbackClock.elapsed();
+      const quint64 due = static_cast<quint64>(static_cast<double>(elapsed) * playbackRate / 1000.0);
+
+      if (due > playbackShown)
+        {
+          // Display the latest due frame which is ready.  Frames
+          // which were not decoded in time are dropped rather than
+          // waited for.
+          const quint64 oldest = std::max(playbackShown + 1,
+                                          due > max_frame_search ? due - max_frame_search : 0);
+          for (quint64 frame = due; frame >= oldest; --frame)
+            {
+              ome::files::dimension_size_type fplane = playbackPlane(playbackOrigin, frame, length);
+              std::shared_ptr<ome::files::VariantPixelBuffer> pixels;
+              // Without a loader, the plane is decoded when rendered.
+              bool ready = !loader || resources.findPlane(reader, series, fplane);
+              if (!ready)
+                {
+                  pixels = loader->find(fplane);
+                  ready = static_cast<bool>(pixels);
+                }
+              if (ready)
+                {
+                  droppedFrames += frame - playbackShown - 1;
+                  playbackShown = frame;
+                  ++rateFrames;
+                  pendingPixels = pixels;
+                  pendingPlane = fplane;
+                  setPlane(fplane);
+                  break;
+                }
+            }
+        }
+
+      readAhead(due);
+
+      const qint64 interval = elapsed - rateStart;
+      if (interval >= 1000)
+        {
+          achievedRate = static_cast<double>(rateFrames) * 1000.0 / static_cast<double>(interval);
+          rateFrames = 0;
+          rateStart = elapsed;
+          emit playbackRateMeasured(achievedRate, droppedFrames);
+        }
+    }
+
+    void
+    GLView2D::readAhead(quint64 frame)
+    {
+      if (!loader || !context())
+        return;
+
+      gl::SharedResources& resources(gl::SharedResources::get(context()));
+
+      // Only one in every step frames can be decoded before it is
+      // due, so the others are not requested.  Requested frames are
+      // aligned to multiples of step so that the request is stable
+      // from one frame to the next.
+      const double period = 1.0 / playbackRate;
+      const quint64 step = std::max(static_cast<quint64>(1),
+                                    static_cast<quint64>(std::ceil(loader->getDecodeTime() / period)));
+      const quint64 count = std::min(max_read_ahead,
+                                     std::max(min_read_ahead,
+                                              static_cast<quint64>(std::ceil(read_ahead_time / (static_cast<double>(step) * period)))));
+
+      std::vector<ome::files::dimension_size_type> planes;
+      ome::files::dimension_size_type length = 0;
+      const quint64 first = ((frame / step) + 1) * step;
+      for (quint64 i = 0; i < count; ++i)
+        {
+          ome::files::dimension_size_type fplane = playbackPlane(playbackOrigin, first + (i * step), length);
+          if (i * step >= length)
+            break;
+          if (!resources.findPlane(reader, series, fplane) &&
+              std::find(planes.begin(), planes.end(), fplane) == planes.end())
+            planes.push_back(fplane);
+        }
+      loader->request(planes);
+    }
+
     void
     GLView2D::initialize()
     {
       makeCurrent();
 
-      glEnable(GL_DEPTH_TEST);
-      gl::check_gl("Enable depth test");
+      // Layers are drawn back to front, so no depth buffer is needed.
+      glDisable(GL_DEPTH_TEST);
+      gl::check_gl("Disable depth test");
       glEnable(GL_CULL_FACE);
       gl::check_gl("Enable cull face");
       glEnable(GL_MULTISAMPLE);
@@ -274,7 +1005,12 @@ namespace ome
       gl::check_gl("Set blend function");
 
       image = new gl::v33::Image2D(reader, series, this);
+      if (loader)
+        image->setReaderPool(loader->getReaderPool());
       axes = new gl::v33::Axis2D(reader, series, this);
+      overlay = new gl::v33::Overlay2D(reader, series, this);
+      pointcloud = new gl::v33::PointCloud2D(reader, series, this);
+      connect(pointcloud, SIGNAL(chunkReady()), this, SLOT(renderLater()));
       grid = new gl::v33::Grid2D(reader, series, this);
 
       GLint max_combined_texture_image_units;
@@ -283,10 +1019,11 @@ namespace ome
 
       image->create();
       axes->create();
+      overlay->create();
+      pointcloud->create();
       grid->create();
 
       // Start timers
-      startTimer(0);
       etimer.start();
 
       // Size viewport
@@ -298,27 +1035,144 @@ namespace ome
     {
       makeCurrent();
 
+      // Window size.  Size may be zero if the window is not yet mapped.
+      QSize s = size();
+      QSize target(s * devicePixelRatio());
+      if (target.isEmpty())
+        return;
+
+      camera.update(static_cast<float>(s.width()),
+                    static_cast<float>(s.height()));
+
+      bool planeSet;
+      if (pendingPixels && pendingPlane == getPlane())
+        planeSet = image->setPlane(getPlane(), pendingPixels);
+      else
+        planeSet = image->setPlane(getPlane());
+      pendingPixels.reset();
+      if (!planeSet && loader && !planeRequested && !isPlaying())
+        {
+          // No reader was idle; keep showing the current texture
+          // and decode the plane in the background.  Playback only
+          // shows planes which are already decoded.
+          planeRequested = true;
+          requestedPlane = getPlane();
+          loader->request(std::vector<ome::files::dimension_size_type>(1, requestedPlane));
+        }
+      if (contrastPending)
+        {
+          contrastPending = false;
+          applyAutoContrast();
+        }
+      image->setMin(cmin);
+      image->setMax(cmax);
+      image->setLUTRow(getLUTRow());
+      if (overlayVisible)
+        overlay->setPlane(getPlane());
+      if (pointsPending)
+        {
+          if (pointsFile.isEmpty())
+            pointcloud->clear();
+          else
+            pointcloud->load(pointsFile, pointsColumns, pointsXColumn, pointsYColumn);
+          pointsPending = false;
+        }
+
+      QOpenGLFramebufferObject *fbo = framebuffer(target);
+      fbo->bind();
+      glViewport(0, 0, fbo->width(), fbo->height());
+
       glClearColor(1.0, 1.0, 1.0, 1.0);
       gl::check_gl("Clear colour");
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glClear(GL_COLOR_BUFFER_BIT);
       gl::check_gl("Clear buffers");
 
-      // Render image
+      // Render grid, image, points, overlay and axes, back to front.
       glm::mat4 mvp = camera.mvp();
+      grid->render(mvp, camera.zoomfactor());
       image->render(mvp);
+      pointcloud->render(mvp);
+      // Continue uploading localisations in the following frames.
+      if (pointcloud->hasPendingChunks())
+        renderLater();
+      if (overlayVisible)
+        overlay->render(mvp);
       axes->render(mvp);
-      grid->render(mvp, camera.zoomfactor());
+
+      // Resolve (full quality) or upscale (interactive quality) into
+      // the window framebuffer.
+      GLuint window = context()->defaultFramebufferObject();
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo->handle());
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, window);
+      glBlitFramebuffer(0, 0, fbo->width(), fbo->height(),
+                        0, 0, target.width(), target.height(),
+                        GL_COLOR_BUFFER_BIT,
+                        fbo->size() == target ? GL_NEAREST : GL_LINEAR);
+      gl::check_gl("Blit framebuffer");
+      glBindFramebuffer(GL_FRAMEBUFFER, window);
     }
 
     void
     GLView2D::resize()
     {
       makeCurrent();
+      releaseFramebuffers();
+      renderLater();
+    }
+
+    QOpenGLFramebufferObject *
+    GLView2D::framebuffer(const QSize& target)
+    {
+      QOpenGLFramebufferObjectFormat format;
+      format.setAttachment(QOpenGLFramebufferObject::NoAttachment);
 
-      QSize newsize = size();
-      glViewport(0, 0, newsize.width(), newsize.height());
+      if (quality == QUALITY_INTERACTIVE)
+        {
+          if (!interactivefbo)
+            {
+              QSize fbosize(std::max(1, static_cast<int>(target.width() * interactiveScale)),
+                            std::max(1, static_cast<int>(target.height() * interactiveScale)));
+              interactivefbo = new QOpenGLFramebufferObject(fbosize, format);
+            }
+          return interactivefbo;
+        }
+      else
+        {
+          if (!fullfbo)
+            {
+              format.setSamples(samples);
+              fullfbo = new QOpenGLFramebufferObject(target, format);
+            }
+          return fullfbo;
+        }
     }
 
+    void
+    GLView2D::releaseFramebuffers()
+    {
+      delete fullfbo;
+      fullfbo = 0;
+      delete interactivefbo;
+      interactivefbo = 0;
+    }
+
+    void
+    GLView2D::interact()
+    {
+      quality = QUALITY_INTERACTIVE;
+      refineTimer.start(refineDelay, this);
+    }
+
+    void
+    GLView2D::refine()
+    {
+      refineTimer.stop();
+      if (quality != QUALITY_FULL)
+        {
+          quality = QUALITY_FULL;
+          renderLater();
+        }
+    }
 
     void
     GLView2D::mousePressEvent(QMouseEvent *event)
@@ -341,6 +1195,7 @@ namespace ome
       int dy = event->y() - lastPos.y();
 
       if (event->buttons() & Qt::LeftButton) {
+        interact();
         switch (mouseMode)
           {
           case MODE_ZOOM:
@@ -356,6 +1211,11 @@ namespace ome
           }
       }
       lastPos = event->pos();
+
+      QPointF imagepos;
+      QVector<double> values;
+      probe(event->localPos(), imagepos, values);
+      emit pixelProbed(imagepos, values);
     }
 
 #ifdef __GNUC__
@@ -363,37 +1223,20 @@ namespace ome
 #endif
 
     void
-    GLView2D::timerEvent (QTimerEvent *event)
+    GLView2D::mouseReleaseEvent(QMouseEvent * /* event */)
     {
-      makeCurrent();
-
-      float zoomfactor = camera.zoomfactor();
-
-      float xtr(static_cast<float>(camera.xTran) / zoomfactor);
-      float ytr(static_cast<float>(camera.yTran) / zoomfactor);
-
-      glm::vec3 tr(glm::rotateZ(glm::vec3(xtr, ytr, 0.0), camera.rotation()));
-
-      camera.view = glm::lookAt(glm::vec3(tr[0], tr[1], 5.0),
-                                glm::vec3(tr[0], tr[1], 0.0),
-                                glm::rotateZ(glm::vec3(0.0, 1.0, 0.0), camera.rotation()));
-
-      // Window size.  Size may be zero if the window is not yet mapped.
-      QSize s = size();
-      float xrange = static_cast<float>(s.width()) / zoomfactor;
-      float yrange = static_cast<float>(s.height()) / zoomfactor;
-
-      camera.projection = glm::ortho(-xrange, xrange,
-                                     -yrange, yrange,
-                                     0.0f, 10.0f);
-
-      image->setPlane(getPlane());
-      image->setMin(cmin);
-      image->setMax(cmax);
-
-      GLWindow::timerEvent(event);
+      refine();
+    }
 
-      renderLater();
+    void
+    GLView2D::timerEvent (QTimerEvent *event)
+    {
+      if (event->timerId() == refineTimer.timerId())
+        refine();
+      else if (event->timerId() == playbackTimer.timerId())
+        advancePlayback();
+      else
+        GLWindow::timerEvent(event);
     }
 
   }
@@ -39,17 +39,34 @@
 #ifndef OME_QTWIDGETS_GLVIEW2D_H
 #define OME_QTWIDGETS_GLVIEW2D_H
 
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <ome/files/FormatReader.h>
 
 #include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/Camera2D.h>
+#include <ome/qtwidgets/SeriesInfo.h>
+#include <ome/qtwidgets/DatasetStatistics.h>
 #include <ome/qtwidgets/GLWindow.h>
+#include <ome/qtwidgets/PlaneLoader.h>
 #include <ome/qtwidgets/gl/Image2D.h>
 #include <ome/qtwidgets/gl/Grid2D.h>
 #include <ome/qtwidgets/gl/Axis2D.h>
+#include <ome/qtwidgets/gl/Overlay2D.h>
+#include <ome/qtwidgets/gl/PointCloud2D.h>
 
+#include <QBasicTimer>
 #include <QElapsedTimer>
+#include <QPointF>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QOpenGLFramebufferObject;
+QT_END_NAMESPACE
 
 /**
  * Open Microscopy Environment C++.
@@ -61,7 +78,7 @@ namespace ome
   {
 
     /**
-     * 2D GL view of an image with axes and gridlines.
+     * 2D GL view of an image with axes, gridlines and ROI overlay.
      */
     class GLView2D : public GLWindow
     {
@@ -76,6 +93,23 @@ namespace ome
           MODE_ROTATE ///< Rotate around point in z.
         };
 
+      /// Rendering quality.
+      enum RenderQuality
+        {
+          QUALITY_INTERACTIVE, ///< Reduced resolution without multisampling.
+          QUALITY_FULL         ///< Full resolution with multisampling.
+        };
+
+      /// Playback dimension.
+      enum PlaybackDimension
+        {
+          PLAYBACK_Z,         ///< Effective Z.
+          PLAYBACK_T,         ///< Effective T.
+          PLAYBACK_MODULO_Z,  ///< Modulo Z.
+          PLAYBACK_MODULO_T,  ///< Modulo T.
+          PLAYBACK_MODULO_C   ///< Modulo C.
+        };
+
       /**
        * Create a 2D image view.
        *
@@ -155,14 +189,76 @@ namespace ome
       void
       setChannelMax(int max);
 
+      /**
+       * Set linear contrast automatically.
+       *
+       * The contrast range is set from the histogram of the current
+       * plane, excluding the specified fraction of saturated samples
+       * at each end.  If complete dataset statistics are set, the
+       * histogram of the current channel over all planes is used
+       * instead.  If the plane has not yet been decoded, the
+       * contrast will be set once it has been loaded for rendering.
+       *
+       * @param saturation the fraction of samples to saturate at
+       * each end of the range.
+       */
+      void
+      autoContrast(double saturation = 0.001);
+
       /**
        * Set plane to render.
        *
+       * If a plane loader is set and the plane is neither cached nor
+       * already decoded, the plane is requested from the loader and
+       * the current plane remains displayed until it is ready.  Each
+       * request replaces the last, so when navigating rapidly only
+       * the most recent plane is decoded, and intermediate planes
+       * are displayed only if they are already available.
+       *
        * @param plane the plane number to render.
        */
       void
       setPlane(ome::files::dimension_size_type plane);
 
+      /**
+       * Start playback.
+       *
+       * The plane is advanced along the playback dimension from the
+       * current plane at the target playback rate, looping at the
+       * end.  The other dimensions are held constant.  Frames are
+       * scheduled by elapsed time: if a plane has not been decoded
+       * by the time it is due, it is dropped rather than waited for.
+       * If a plane loader is set, planes are decoded in advance in
+       * the background, with the read-ahead window sized from the
+       * measured decode time; otherwise each displayed plane is
+       * decoded when rendered.
+       *
+       * Has no effect if already playing, or if the playback
+       * dimension has fewer than two positions.
+       */
+      void
+      play();
+
+      /// Stop playback.
+      void
+      pause();
+
+      /**
+       * Set playback dimension.
+       *
+       * @param dimension the dimension to advance along.
+       */
+      void
+      setPlaybackDimension(PlaybackDimension dimension);
+
+      /**
+       * Set target playback rate.
+       *
+       * @param fps the target rate (frames per second).
+       */
+      void
+      setPlaybackRate(double fps);
+
       /**
        * Set mouse behaviour mode.
        *
@@ -171,6 +267,65 @@ namespace ome
       void
       setMouseMode(MouseMode mode);
 
+      /**
+       * Set multisample count for full quality rendering.
+       *
+       * @param samples the number of samples per pixel (0 to disable
+       * multisampling).
+       */
+      void
+      setSamples(int samples);
+
+      /**
+       * Set resolution scale for interactive rendering.
+       *
+       * While the view is being dragged, frames are rendered at this
+       * fraction of the window resolution without multisampling, and
+       * scaled up to fill the window.
+       *
+       * @param scale the scale factor, in the range (0,1].
+       */
+      void
+      setInteractiveScale(float scale);
+
+      /**
+       * Set refinement delay.
+       *
+       * A full quality frame is rendered once the view has not been
+       * dragged for this long.
+       *
+       * @param msec the delay in milliseconds.
+       */
+      void
+      setRefineDelay(int msec);
+
+      /**
+       * Show or hide the ROI overlay.
+       *
+       * @param visible @c true to show the overlay, @c false to hide.
+       */
+      void
+      setOverlayVisible(bool visible);
+
+      /**
+       * Set point localisations to render over the image.
+       *
+       * Loading starts before the next frame is rendered, and the
+       * points are shown progressively as they are binned.  See
+       * gl::PointCloud2D::load() for the table format.
+       *
+       * @param filename the binary localisation table, or an empty
+       * string to remove all points.
+       * @param columns the number of float columns per row.
+       * @param xcolumn the column containing the x coordinate.
+       * @param ycolumn the column containing the y coordinate.
+       */
+      void
+      setLocalisations(const QString& filename,
+                       unsigned int   columns = 2,
+                       unsigned int   xcolumn = 0,
+                       unsigned int   ycolumn = 1);
+
     public:
       /**
        * Get reader.
@@ -188,6 +343,106 @@ namespace ome
       ome::files::dimension_size_type
       getSeries();
 
+      /**
+       * Set dataset statistics.
+       *
+       * If complete, these are used by autoContrast() in place of
+       * the histogram of the current plane.
+       *
+       * @param statistics the statistics, or null to unset.
+       */
+      void
+      setStatistics(std::shared_ptr<DatasetStatistics> statistics);
+
+      /**
+       * Get dataset statistics.
+       *
+       * @returns the statistics, or null if unset.
+       */
+      std::shared_ptr<DatasetStatistics>
+      getStatistics() const;
+
+      /**
+       * Set plane loader for playback read-ahead.
+       *
+       * @param loader the loader, or null to decode planes when
+       * rendered.  The loader must be for the series of this view.
+       */
+      void
+      setPlaneLoader(std::shared_ptr<PlaneLoader> loader);
+
+      /**
+       * Get plane loader for playback read-ahead.
+       *
+       * @returns the loader, or null if unset.
+       */
+      std::shared_ptr<PlaneLoader>
+      getPlaneLoader() const;
+
+      /**
+       * Check if playback is running.
+       *
+       * @returns @c true if playing.
+       */
+      bool
+      isPlaying() const;
+
+      /**
+       * Get playback dimension.
+       *
+       * @returns the dimension to advance along.
+       */
+      PlaybackDimension
+      getPlaybackDimension() const;
+
+      /**
+       * Get the number of positions along the playback dimension.
+       *
+       * @returns the playback length.
+       */
+      ome::files::dimension_size_type
+      getPlaybackLength() const;
+
+      /**
+       * Get the planes along the playback dimension.
+       *
+       * The other dimensions are those of the current plane.
+       *
+       * @returns the plane numbers, in playback order from the
+       * first position.
+       */
+      std::vector<ome::files::dimension_size_type>
+      getPlaybackPlanes() const;
+
+      /**
+       * Get target playback rate.
+       *
+       * @returns the target rate (frames per second).
+       */
+      double
+      getPlaybackRate() const;
+
+      /**
+       * Get achieved playback rate.
+       *
+       * This is the rate at which frames were displayed, measured
+       * over the last second of playback.
+       *
+       * @returns the achieved rate (frames per second), or zero if
+       * not yet measured.
+       */
+      double
+      getAchievedPlaybackRate() const;
+
+      /**
+       * Get the number of frames dropped.
+       *
+       * @returns the number of frames not displayed since playback
+       * started.
+       */
+      quint64
+      getDroppedFrames() const;
+
       /**
        * Get zoom factor.
        *
@@ -244,6 +499,34 @@ namespace ome
       ome::files::dimension_size_type
       getPlane() const;
 
+      /**
+       * Get the channel of the plane to render.
+       *
+       * @returns the (effective) channel index.
+       */
+      ome::files::dimension_size_type
+      getChannel() const;
+
+      /**
+       * Get the lookup table for a channel.
+       *
+       * @param channel the (effective) channel index.
+       * @returns the name of the standard lookup table.
+       */
+      std::string
+      getChannelLUT(ome::files::dimension_size_type channel) const;
+
+      /**
+       * Set the lookup table for a channel.
+       *
+       * @param channel the (effective) channel index.
+       * @param name the name of a standard lookup table (see
+       * standardLUTNames()).
+       */
+      void
+      setChannelLUT(ome::files::dimension_size_type channel,
+                    const std::string&              name);
+
       /**
        * Get mouse behaviour mode.
        *
@@ -252,6 +535,117 @@ namespace ome
       MouseMode
       getMouseMode() const;
 
+      /**
+       * Get multisample count for full quality rendering.
+       *
+       * @returns the number of samples per pixel.
+       */
+      int
+      getSamples() const;
+
+      /**
+       * Get resolution scale for interactive rendering.
+       *
+       * @returns the scale factor.
+       */
+      float
+      getInteractiveScale() const;
+
+      /**
+       * Get refinement delay.
+       *
+       * @returns the delay in milliseconds.
+       */
+      int
+      getRefineDelay() const;
+
+      /**
+       * Get the quality of the current or next frame.
+       *
+       * @returns the rendering quality.
+       */
+      RenderQuality
+      getRenderQuality() const;
+
+      /**
+       * Get ROI overlay visibility.
+       *
+       * @returns @c true if the overlay is shown.
+       */
+      bool
+      getOverlayVisible() const;
+
+      /**
+       * Get camera.
+       *
+       * The camera may be used to reproduce the current view with an
+       * OffscreenRenderer2D.
+       *
+       * @returns the camera.
+       */
+      const Camera2D&
+      getCamera() const;
+
+      /**
+       * Get limits for linear contrast.
+       *
+       * The limits are normalized to the texture value range, as
+       * used by OffscreenRenderer2D, so that the current view may
+       * be reproduced.
+       *
+       * @returns the minimum and maximum limits for three channels.
+       */
+      std::pair<glm::vec3, glm::vec3>
+      getContrastLimits() const;
+
+      /**
+       * Get the lookup table of the current channel.
+       *
+       * @returns the row of the shared LUT texture.
+       */
+      int
+      getLUTRow() const;
+
+      /**
+       * Get point localisations.
+       *
+       * @param filename the binary localisation table, or an empty
+       * string if no points are shown.
+       * @param columns the number of float columns per row.
+       * @param xcolumn the column containing the x coordinate.
+       * @param ycolumn the column containing the y coordinate.
+       */
+      void
+      getLocalisations(QString&      filename,
+                       unsigned int& columns,
+                       unsigned int& xcolumn,
+                       unsigned int& ycolumn) const;
+
+      /**
+       * Probe raw pixel values.
+       *
+       * The window position is mapped through the inverse camera
+       * transform into image coordinates, and the raw sample values
+       * at that position are retrieved from the CPU-side decoded
+       * planes retained with the plane textures.  No GL readback or
+       * synchronisation is performed, and no planes are decoded.
+       *
+       * Values are returned for each channel at the current Z and T,
+       * with one value per sample (subchannel) of each channel;
+       * channels whose planes are not currently cached are returned
+       * as NaN.  Complex values are returned as magnitudes.
+       *
+       * @param pos the window position (logical pixels).
+       * @param imagepos the image position (pixels) is stored here.
+       * @param values the pixel values are stored here.
+       * @returns @c true if the position lies within the image, or
+       * @c false otherwise (in which case no values are returned).
+       */
+      bool
+      probe(const QPointF&   pos,
+            QPointF&         imagepos,
+            QVector<double>& values);
+
     signals:
       /**
        * Signal zoom level changed.
@@ -309,6 +703,50 @@ namespace ome
       void
       planeChanged(ome::files::dimension_size_type plane);
 
+      /**
+       * Signal pixel values under the cursor.
+       *
+       * Emitted on mouse movement; see probe().
+       *
+       * @param imagepos the image position (pixels).
+       * @param values the pixel values, or empty if outside the
+       * image.
+       */
+      void
+      pixelProbed(QPointF         imagepos,
+                  QVector<double> values);
+
+      /**
+       * Signal playback started or stopped.
+       *
+       * @param playing @c true if playback started, @c false if
+       * stopped.
+       */
+      void
+      playbackStateChanged(bool playing);
+
+      /**
+       * Signal achieved playback rate.
+       *
+       * Emitted once per second during playback.
+       *
+       * @param fps the achieved rate (frames per second).
+       * @param dropped the number of frames dropped since playback
+       * started.
+       */
+      void
+      playbackRateMeasured(double  fps,
+                           quint64 dropped);
+
+    private slots:
+      /**
+       * Display a requested plane once decoded by the plane loader.
+       *
+       * @param plane the decoded plane.
+       */
+      void
+      planeLoaded(quint64 plane);
+
     protected:
       /// Set up GL context and subsidiary objects.
       void
@@ -344,10 +782,21 @@ namespace ome
       void
       mouseMoveEvent(QMouseEvent *event);
 
+      /**
+       * Handle mouse button release events.
+       *
+       * Ends interaction and triggers a full quality render pass.
+       *
+       * @param event the event to handle.
+       */
+      void
+      mouseReleaseEvent(QMouseEvent *event);
+
       /**
        * Handle timer events.
        *
-       * Used to update scene properties and trigger a render pass.
+       * Used to trigger a full quality render pass once interaction
+       * has stopped, and to advance playback.
        *
        * @param event the event to handle.
        */
@@ -356,95 +805,138 @@ namespace ome
 
     private:
       /**
-       * Camera (modelview projection matrix manipulation)
-       */
-      struct Camera
-      {
-        /// Projection type
-        enum ProjectionType
-          {
-            ORTHOGRAPHIC, ///< Orthographic projection.
-            PERSPECTIVE   ///< Perspective projection.
-          };
-
-        Camera():
-          projectionType(ORTHOGRAPHIC),
-          zoom(0),
-          xTran(0),
-          yTran(0),
-          zRot(0),
-          model(1.0f),
-          view(1.0f),
-          projection(1.0f)
-        {}
-
-        /// Projection type.
-        ProjectionType projectionType;
-        /// Zoom factor.
-        int zoom;
-        /// x translation
-        int xTran;
-        /// y translation.
-        int yTran;
-        /// Rotation factor.
-        int zRot;
-        /// Current model.
-        glm::mat4 model;
-        /// Current view.
-        glm::mat4 view;
-        /// Current projection.
-        glm::mat4 projection;
-
-        /**
-         * Get zoom factor.
-         *
-         * Convert linear signed zoom value to a factor (to the 10th
-         * power of the zoom value).
-         *
-         * @returns the zoom factor.
-         */
-        float
-        zoomfactor() const
-        {
-          return std::pow(10.0f, static_cast<float>(zoom)/1024.0f); /// @todo remove fixed size.
-        }
-
-        /**
-         * Get rotation factor.
-         *
-         * @returns the rotation factor (in radians).
-         */
-        float
-        rotation() const
-        {
-          return glm::radians(-static_cast<float>(zRot)/16.0f);
-        }
-
-        /**
-         * Get modelview projection matrix.
-         *
-         * The separate model, view and projection matrices are
-         * combined to form a single matrix.
-         *
-         * @returns the modelview projection matrix.
-         */
-        glm::mat4
-        mvp() const
-        {
-          return projection * view * model;
-        }
-      };
+       * Make a plane current and trigger a render pass.
+       *
+       * @param plane the plane number to render.
+       */
+      void
+      displayPlane(ome::files::dimension_size_type plane);
+
+      /**
+       * Switch to interactive quality.
+       *
+       * The refinement timer is restarted.
+       */
+      void
+      interact();
+
+      /// Switch to full quality and trigger a render pass.
+      void
+      refine();
+
+      /**
+       * Get the framebuffer for the current rendering quality.
+       *
+       * The framebuffer is created on first use.
+       *
+       * @param target the size of the window framebuffer (device pixels).
+       * @returns the framebuffer.
+       */
+      QOpenGLFramebufferObject *
+      framebuffer(const QSize& target);
+
+      /// Delete framebuffers (they will be recreated on next use).
+      void
+      releaseFramebuffers();
+
+      /**
+       * Set linear contrast from the histogram of the current plane.
+       *
+       * @returns @c false if the current plane is not yet loaded,
+       * @c true otherwise.
+       */
+      bool
+      applyAutoContrast();
+
+      /**
+       * Get the plane for a playback frame.
+       *
+       * @param origin the plane at which playback started.
+       * @param frame the frame number, counted from the start of
+       * playback.
+       * @param length the number of positions along the playback
+       * dimension is stored here.
+       * @returns the plane number.
+       */
+      ome::files::dimension_size_type
+      playbackPlane(ome::files::dimension_size_type  origin,
+                    quint64                          frame,
+                    ome::files::dimension_size_type& length) const;
+
+      /// Display the latest due frame which is ready.
+      void
+      advancePlayback();
+
+      /**
+       * Request read-ahead of frames following a frame.
+       *
+       * @param frame the current frame number.
+       */
+      void
+      readAhead(quint64 frame);
 
       /// Current projection
-      Camera camera;
+      Camera2D camera;
       /// Current mouse behaviour.
       MouseMode mouseMode;
       /// Rendering timer.
       QElapsedTimer etimer;
+      /// Current rendering quality.
+      RenderQuality quality;
+      /// Multisample count for full quality.
+      int samples;
+      /// Resolution scale for interactive quality.
+      float interactiveScale;
+      /// Refinement delay (ms).
+      int refineDelay;
+      /// Refinement timer.
+      QBasicTimer refineTimer;
+      /// Full quality (multisampled) framebuffer.
+      QOpenGLFramebufferObject *fullfbo;
+      /// Interactive quality (reduced resolution) framebuffer.
+      QOpenGLFramebufferObject *interactivefbo;
       /// Minimum level for linear contrast.
       glm::vec3 cmin;
       /// Maximum level for linear contrast.
       glm::vec3 cmax;
+      /// Automatic contrast is pending plane upload.
+      bool contrastPending;
+      /// Saturation fraction for automatic contrast.
+      double contrastSaturation;
+      /// Lookup table names by channel (HiLo if unset).
+      std::map<ome::files::dimension_size_type, std::string> channelLUTs;
+      /// Dataset statistics for automatic contrast.
+      std::shared_ptr<DatasetStatistics> statistics;
+      /// Plane loader for playback read-ahead.
+      std::shared_ptr<PlaneLoader> loader;
+      /// Decoded pixel data of the plane to upload on next render.
+      std::shared_ptr<ome::files::VariantPixelBuffer> pendingPixels;
+      /// Plane of the pending pixel data.
+      ome::files::dimension_size_type pendingPlane;
+      /// A plane has been requested from the loader for display.
+      bool planeRequested;
+      /// Plane requested from the loader for display.
+      ome::files::dimension_size_type requestedPlane;
+      /// Playback dimension.
+      PlaybackDimension playbackDimension;
+      /// Target playback rate (frames per second).
+      double playbackRate;
+      /// Achieved playback rate (frames per second).
+      double achievedRate;
+      /// Playback timer.
+      QBasicTimer playbackTimer;
+      /// Time since the start of playback.
+      QElapsedTimer playbackClock;
+      /// Plane at the start of playback.
+      ome::files::dimension_size_type playbackOrigin;
+      /// Last frame displayed.
+      quint64 playbackShown;
+      /// Frames dropped since the start of playback.
+      quint64 droppedFrames;
+      /// Frames displayed since the start of the rate measurement.
+      quint64 rateFrames;
+      /// Start of the rate measurement (ms since the start of playback).
+      qint64 rateStart;
       /// Current plane.
       ome::files::dimension_size_type plane;
       /// Previous plane.
@@ -455,12 +947,30 @@ namespace ome
       gl::Image2D *image;
       /// Axes to render.
       gl::Axis2D *axes;
+      /// ROI overlay to render.
+      gl::Overlay2D *overlay;
+      /// Overlay visibility.
+      bool overlayVisible;
+      /// Point localisations to render.
+      gl::PointCloud2D *pointcloud;
+      /// Localisation table to load before the next frame.
+      QString pointsFile;
+      /// Localisation table column count.
+      unsigned int pointsColumns;
+      /// Localisation table x column.
+      unsigned int pointsXColumn;
+      /// Localisation table y column.
+      unsigned int pointsYColumn;
+      /// Localisation table needs loading?
+      bool pointsPending;
       /// Grid to render.
       gl::Grid2D *grid;
       /// The image reader.
       std::shared_ptr<ome::files::FormatReader> reader;
       /// The image series.
       ome::files::dimension_size_type series;
+      /// Metadata of the image series.
+      std::shared_ptr<const SeriesInfo> info;
     };
 
   }
@@ -40,6 +40,7 @@
 #include <iostream>
 
 #include <ome/qtwidgets/GLWindow.h>
+#include <ome/qtwidgets/Trace.h>
 
 #include <QtCore/QCoreApplication>
 
@@ -62,6 +63,13 @@ namespace ome
       logger(0)
     {
       setSurfaceType(QWindow::OpenGLSurface);
+
+      // Default to a multisampled framebuffer with depth buffer;
+      // subclasses may request a different format with setFormat().
+      QSurfaceFormat format(requestedFormat());
+      format.setSamples(8);
+      format.setDepthBufferSize(24);
+      setFormat(format);
     }
 
     GLWindow::~GLWindow()
@@ -156,6 +164,8 @@ namespace ome
       if (!isExposed())
         return;
 
+      TraceScope trace("GLWindow::renderNow", "render");
+
       bool needsInitialize = false;
       bool enableDebug = false;
 
@@ -171,11 +181,15 @@ namespace ome
           {
             format.setOption(QSurfaceFormat::DebugContext);
           }
-        format.setSamples(8);
-        format.setDepthBufferSize(24);
 
         glcontext = new QOpenGLContext(this);
         glcontext->setFormat(format);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+        // Share textures and shader programs with all other contexts
+        // if enabled with Qt::AA_ShareOpenGLContexts.
+        if (QOpenGLContext::globalShareContext())
+          glcontext->setShareContext(QOpenGLContext::globalShareContext());
+#endif
         bool valid = glcontext->create();
         std::cerr << "Valid OpenGL context: " << valid << std::endl;
         makeCurrent();
@@ -204,9 +218,15 @@ namespace ome
           initialize();
         }
 
-      render();
+      {
+        TraceScope render_trace("GLWindow::render", "render");
+        render();
+      }
 
-      glcontext->swapBuffers(this);
+      {
+        TraceScope swap_trace("QOpenGLContext::swapBuffers", "render");
+        glcontext->swapBuffers(this);
+      }
 
       if (animating)
         renderLater();
@@ -61,6 +61,11 @@ namespace ome
      * This is a standard QWindow, however it contains no child
      * widgets; it's simply a surface on which to paint GL rendered
      * content.
+     *
+     * If the application sets Qt::AA_ShareOpenGLContexts, the
+     * context of every window is placed in the global share group,
+     * so that textures and shader programs are shared between
+     * windows (see gl::SharedResources).
      */
     class GLWindow : public QWindow,
                      protected QOpenGLFunctions_3_3_Core
@@ -71,6 +76,10 @@ namespace ome
       /**
        * Create a GL window.
        *
+       * The requested surface format defaults to 8x multisampling
+       * with a 24-bit depth buffer.  Subclasses may call setFormat()
+       * in their constructor to request a cheaper surface.
+       *
        * @param parent the parent of this object.
        */
       explicit GLWindow(QWindow *parent = 0);
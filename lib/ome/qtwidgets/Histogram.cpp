@@ -0,0 +1,481 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#include <ome/files/PixelBuffer.h>
+
+#include <ome/qtwidgets/Histogram.h>
+
+using ome::files::PixelBufferBase;
+using ome::qtwidgets::Histogram;
+using ome::qtwidgets::sample_value;
+
+namespace
+{
+
+  typedef boost::multi_array_types::index index_type;
+
+  // Minimum number of samples per thread; smaller planes are not
+  // worth the thread startup cost.
+  const std::size_t min_thread_samples = 1U << 18;
+
+  /*
+   * Run a function over row ranges in parallel.
+   *
+   * The function is called with the first and last (exclusive) rows
+   * and the worker index.  The calling thread processes the last
+   * range.
+   */
+  void
+  parallel_rows(std::size_t                                                   rows,
+                unsigned int                                                  nthreads,
+                const std::function<void(std::size_t, std::size_t, unsigned int)>& func)
+  {
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t + 1 < nthreads; ++t)
+      workers.push_back(std::thread(func, (rows * t) / nthreads, (rows * (t + 1)) / nthreads, t));
+    func((rows * (nthreads - 1)) / nthreads, rows, nthreads - 1);
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  /*
+   * Bin indices into private tables.
+   *
+   * Successive samples are counted in separate tables where there
+   * are few bins, so that runs of equal values do not serialise on
+   * the same counter.  Counts are 32-bit to keep the tables cache
+   * resident, and are flushed to the 64-bit result before they can
+   * overflow.
+   */
+  class BinTables
+  {
+  public:
+    BinTables(std::size_t nbins):
+      nbins(nbins),
+      ntables(nbins <= 4096U ? 4U : 1U),
+      tables(ntables * nbins, 0U),
+      pending(0U)
+    {}
+
+    template<typename F>
+    void
+    add(std::size_t      n,
+        Histogram::bin_array& result,
+        F                binfunc)
+    {
+      if (pending + n > std::numeric_limits<uint32_t>::max())
+        flush(result);
+
+      uint32_t *t0 = &tables[0];
+      uint32_t *t1 = t0 + (ntables > 1 ? nbins : 0);
+      uint32_t *t2 = t0 + (ntables > 1 ? 2 * nbins : 0);
+      uint32_t *t3 = t0 + (ntables > 1 ? 3 * nbins : 0);
+
+      std::size_t x = 0;
+      for (; x + 4 <= n; x += 4)
+        {
+          ++t0[binfunc(x)];
+          ++t1[binfunc(x + 1)];
+          ++t2[binfunc(x + 2)];
+          ++t3[binfunc(x + 3)];
+        }
+      for (; x < n; ++x)
+        ++t0[binfunc(x)];
+
+      pending += n;
+    }
+
+    void
+    flush(Histogram::bin_array& result)
+    {
+      for (std::size_t t = 0; t < ntables; ++t)
+        for (std::size_t b = 0; b < result.size(); ++b)
+          result[b] += tables[(t * nbins) + b];
+      std::fill(tables.begin(), tables.end(), 0U);
+      pending = 0;
+    }
+
+  private:
+    std::size_t nbins;
+    std::size_t ntables;
+    std::vector<uint32_t> tables;
+    uint64_t pending;
+  };
+
+  template<typename T>
+  struct is_exact :
+    std::integral_constant<bool, std::is_integral<T>::value && (sizeof(T) <= 2)>
+  {};
+
+  /*
+   * Compute histograms of a VariantPixelBuffer.
+   *
+   * The buffer may only contain a single xy plane.
+   */
+  struct HistogramVisitor
+  {
+    unsigned int threads;
+    std::vector<Histogram::Channel>& data;
+
+    HistogramVisitor(unsigned int                     threads,
+                     std::vector<Histogram::Channel>& data):
+      threads(threads),
+      data(data)
+    {}
+
+    template<typename T>
+    void
+    operator() (const T& v)
+    {
+      typedef typename T::element_type::value_type value_type;
+
+      const PixelBufferBase::size_type *shape = v->shape();
+      const index_type *strides = v->array().strides();
+      const value_type *origin = v->array().origin();
+
+      const std::size_t sx = shape[ome::files::DIM_SPATIAL_X];
+      const std::size_t sy = shape[ome::files::DIM_SPATIAL_Y];
+      const std::size_t ns = shape[ome::files::DIM_SUBCHANNEL];
+
+      data.resize(ns);
+      if (!sx || !sy)
+        return;
+
+      const std::size_t maxthreads = std::min(sy, std::max<std::size_t>(1U, (sx * sy) / min_thread_samples));
+      const unsigned int nthreads = static_cast<unsigned int>(std::min<std::size_t>(std::max(1U, threads), maxthreads));
+
+      for (std::size_t s = 0; s < ns; ++s)
+        {
+          const value_type *sorigin = origin + (static_cast<index_type>(s) * strides[ome::files::DIM_SUBCHANNEL]);
+          bin(sorigin, sx, sy,
+              strides[ome::files::DIM_SPATIAL_X], strides[ome::files::DIM_SPATIAL_Y],
+              nthreads, data[s], is_exact<value_type>());
+        }
+    }
+
+    // Merge per-thread results into the channel.
+    static void
+    merge(std::vector<Histogram::bin_array>& partial,
+          Histogram::Channel&                 channel,
+          std::size_t                         nbins)
+    {
+      channel.bins.assign(nbins, 0U);
+      channel.total = 0;
+      for (const auto& p : partial)
+        for (std::size_t b = 0; b < nbins; ++b)
+          channel.bins[b] += p[b];
+      for (std::size_t b = 0; b < nbins; ++b)
+        channel.total += channel.bins[b];
+    }
+
+    // Exact binning of 8- and 16-bit integer types.
+    template<typename V>
+    void
+    bin(const V             *origin,
+        std::size_t          sx,
+        std::size_t          sy,
+        index_type           xs,
+        index_type           ys,
+        unsigned int         nthreads,
+        Histogram::Channel&  channel,
+        std::true_type)
+    {
+      const std::size_t nbins = static_cast<std::size_t>(static_cast<int>(std::numeric_limits<V>::max()) -
+                                                         static_cast<int>(std::numeric_limits<V>::min())) + 1U;
+      const int offset = -static_cast<int>(std::numeric_limits<V>::min());
+
+      std::vector<Histogram::bin_array> partial(nthreads);
+      parallel_rows(sy, nthreads,
+                    [&](std::size_t y0, std::size_t y1, unsigned int t)
+                    {
+                      Histogram::bin_array& result(partial[t]);
+                      result.assign(nbins, 0U);
+                      BinTables tables(nbins);
+                      for (std::size_t y = y0; y < y1; ++y)
+                        {
+                          const V *row = origin + (static_cast<index_type>(y) * ys);
+                          if (xs == 1)
+                            tables.add(sx, result,
+                                       [row, offset](std::size_t x)
+                                       { return static_cast<std::size_t>(static_cast<int>(row[x]) + offset); });
+                          else
+                            tables.add(sx, result,
+                                       [row, xs, offset](std::size_t x)
+                                       { return static_cast<std::size_t>(static_cast<int>(row[static_cast<index_type>(x) * xs]) + offset); });
+                        }
+                      tables.flush(result);
+                    });
+
+      merge(partial, channel, nbins);
+      channel.min = static_cast<double>(std::numeric_limits<V>::min());
+      channel.width = 1.0;
+      channel.exact = true;
+    }
+
+    // Range binning of all other types.
+    template<typename V>
+    void
+    bin(const V             *origin,
+        std::size_t          sx,
+        std::size_t          sy,
+        index_type           xs,
+        index_type           ys,
+        unsigned int         nthreads,
+        Histogram::Channel&  channel,
+        std::false_type)
+    {
+      const std::size_t nbins = Histogram::default_bins;
+
+      // Pass 1: sample range.  The row buffer keeps the inner loops
+      // free of strides and conversions so that they vectorise.
+      std::vector<double> tmin(nthreads, std::numeric_limits<double>::max());
+      std::vector<double> tmax(nthreads, -std::numeric_limits<double>::max());
+      parallel_rows(sy, nthreads,
+                    [&](std::size_t y0, std::size_t y1, unsigned int t)
+                    {
+                      std::vector<double> values(sx);
+                      double lmin = std::numeric_limits<double>::max();
+                      double lmax = -std::numeric_limits<double>::max();
+                      for (std::size_t y = y0; y < y1; ++y)
+                        {
+                          const V *row = origin + (static_cast<index_type>(y) * ys);
+                          for (std::size_t x = 0; x < sx; ++x)
+                            values[x] = sample_value(row[static_cast<index_type>(x) * xs]);
+                          for (std::size_t x = 0; x < sx; ++x)
+                            {
+                              // NaN and infinities are excluded.
+                              const double value = values[x];
+                              const bool finite = std::abs(value) <= std::numeric_limits<double>::max();
+                              lmin = std::min(lmin, finite ? value : lmin);
+                              lmax = std::max(lmax, finite ? value : lmax);
+                            }
+                        }
+                      tmin[t] = lmin;
+                      tmax[t] = lmax;
+                    });
+
+      double vmin = *std::min_element(tmin.begin(), tmin.end());
+      double vmax = *std::max_element(tmax.begin(), tmax.end());
+      if (vmin > vmax) // No finite samples.
+        vmin = vmax = 0.0;
+
+      const double width = vmax > vmin ? (vmax - vmin) / static_cast<double>(nbins) : 1.0;
+      const double scale = 1.0 / width;
+      const double last = static_cast<double>(nbins - 1);
+
+      // Pass 2: binning.  Non-finite samples are counted in an extra
+      // bin which is discarded.
+      std::vector<Histogram::bin_array> partial(nthreads);
+      parallel_rows(sy, nthreads,
+                    [&](std::size_t y0, std::size_t y1, unsigned int t)
+                    {
+                      Histogram::bin_array& result(partial[t]);
+                      result.assign(nbins + 1, 0U);
+                      BinTables tables(nbins + 1);
+                      std::vector<uint32_t> indices(sx);
+                      for (std::size_t y = y0; y < y1; ++y)
+                        {
+                          const V *row = origin + (static_cast<index_type>(y) * ys);
+                          for (std::size_t x = 0; x < sx; ++x)
+                            {
+                              const double value = sample_value(row[static_cast<index_type>(x) * xs]);
+                              const bool finite = std::abs(value) <= std::numeric_limits<double>::max();
+                              const double pos = std::min(last, std::max(0.0, (finite ? value - vmin : 0.0) * scale));
+                              indices[x] = finite ? static_cast<uint32_t>(pos) : static_cast<uint32_t>(nbins);
+                            }
+                          const uint32_t *idx = &indices[0];
+                          tables.add(sx, result,
+                                     [idx](std::size_t x)
+                                     { return static_cast<std::size_t>(idx[x]); });
+                        }
+                      tables.flush(result);
+                    });
+
+      merge(partial, channel, nbins);
+      channel.min = vmin;
+      channel.width = width;
+      channel.exact = false;
+    }
+  };
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    Histogram::Histogram():
+      data()
+    {
+    }
+
+    Histogram::Histogram(const std::vector<Channel>& channels):
+      data(channels)
+    {
+    }
+
+    Histogram::Histogram(const ome::files::VariantPixelBuffer& buffer,
+                         unsigned int                          threads):
+      data()
+    {
+      compute(buffer, threads);
+    }
+
+    Histogram::~Histogram()
+    {
+    }
+
+    void
+    Histogram::compute(const ome::files::VariantPixelBuffer& buffer,
+                       unsigned int                          threads)
+    {
+      if (!threads)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+
+      std::vector<Channel> newdata;
+      HistogramVisitor v(threads, newdata);
+      ome::compat::visit(v, buffer.vbuffer());
+      data.swap(newdata);
+    }
+
+    std::size_t
+    Histogram::channels() const
+    {
+      return data.size();
+    }
+
+    const Histogram::bin_array&
+    Histogram::counts(std::size_t channel) const
+    {
+      return data.at(channel).bins;
+    }
+
+    const Histogram::Channel&
+    Histogram::channel(std::size_t channel) const
+    {
+      return data.at(channel);
+    }
+
+    uint64_t
+    Histogram::total(std::size_t channel) const
+    {
+      return data.at(channel).total;
+    }
+
+    double
+    Histogram::binValue(std::size_t channel,
+                        std::size_t bin) const
+    {
+      const Channel& c(data.at(channel));
+      return c.min + (static_cast<double>(bin) * c.width);
+    }
+
+    double
+    Histogram::binWidth(std::size_t channel) const
+    {
+      return data.at(channel).width;
+    }
+
+    double
+    Histogram::mean(std::size_t channel) const
+    {
+      const Channel& c(data.at(channel));
+      if (!c.total)
+        return 0.0;
+
+      const double centre = c.exact ? 0.0 : 0.5;
+      double sum = 0.0;
+      for (std::size_t b = 0; b < c.bins.size(); ++b)
+        if (c.bins[b])
+          sum += static_cast<double>(c.bins[b]) * (static_cast<double>(b) + centre);
+      return c.min + ((sum / static_cast<double>(c.total)) * c.width);
+    }
+
+    double
+    Histogram::percentile(std::size_t channel,
+                          double      fraction) const
+    {
+      const Channel& c(data.at(channel));
+      if (!c.total)
+        return 0.0;
+
+      const double target = std::min(1.0, std::max(0.0, fraction)) * static_cast<double>(c.total);
+      uint64_t cumulative = 0;
+      std::size_t last = 0;
+      for (std::size_t b = 0; b < c.bins.size(); ++b)
+        {
+          if (!c.bins[b])
+            continue;
+          last = b;
+          if (static_cast<double>(cumulative + c.bins[b]) >= target)
+            {
+              if (c.exact)
+                return binValue(channel, b);
+              const double within = (target - static_cast<double>(cumulative)) / static_cast<double>(c.bins[b]);
+              return c.min + ((static_cast<double>(b) + within) * c.width);
+            }
+          cumulative += c.bins[b];
+        }
+      return binValue(channel, last) + (c.exact ? 0.0 : c.width);
+    }
+
+    std::pair<double, double>
+    Histogram::range(std::size_t channel,
+                     double      saturation) const
+    {
+      return std::make_pair(percentile(channel, saturation),
+                            percentile(channel, 1.0 - saturation));
+    }
+
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
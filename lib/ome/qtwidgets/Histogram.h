@@ -0,0 +1,275 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_HISTOGRAM_H
+#define OME_QTWIDGETS_HISTOGRAM_H
+
+#include <complex>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <ome/files/VariantPixelBuffer.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Per-channel histogram of a pixel buffer.
+     *
+     * One histogram is computed for each sample (subchannel) of a
+     * single xy plane.  8- and 16-bit integer types (and BIT) are
+     * binned exactly, with one bin per representable value; all
+     * other types are binned into a fixed number of equal width bins
+     * spanning the range of the finite sample values.  Complex types
+     * are binned using the real part, which is the component
+     * rendered by Image2D.
+     *
+     * Computation is split by row across multiple threads, each
+     * binning into private tables which are merged on completion.
+     */
+    class Histogram
+    {
+    public:
+      /// Bin counts.
+      typedef std::vector<uint64_t> bin_array;
+
+      /// Number of bins used for types which are not binned exactly.
+      static const std::size_t default_bins = 65536U;
+
+      /// Histogram of a single channel.
+      struct Channel
+      {
+        /// Bin counts.
+        bin_array bins;
+        /// Value of the lower edge of the first bin.
+        double min;
+        /// Bin width.
+        double width;
+        /// Total sample count.
+        uint64_t total;
+        /// Bins correspond to exact sample values.
+        bool exact;
+      };
+
+      /// Construct an empty histogram.
+      Histogram();
+
+      /**
+       * Construct a histogram from existing channel histograms.
+       *
+       * This permits histograms computed elsewhere (e.g. merged or
+       * cached) to be queried.
+       *
+       * @param channels the channel histograms.
+       */
+      explicit
+      Histogram(const std::vector<Channel>& channels);
+
+      /**
+       * Construct a histogram from a pixel buffer.
+       *
+       * @param buffer the pixel buffer containing a single xy plane.
+       * @param threads the number of threads to use, or zero to use
+       * the hardware concurrency.
+       */
+      explicit
+      Histogram(const ome::files::VariantPixelBuffer& buffer,
+                unsigned int                          threads = 0);
+
+      /// Destructor.
+      ~Histogram();
+
+      /**
+       * Compute the histogram of a pixel buffer.
+       *
+       * Any existing histogram data will be replaced.
+       *
+       * @param buffer the pixel buffer containing a single xy plane.
+       * @param threads the number of threads to use, or zero to use
+       * the hardware concurrency.
+       */
+      void
+      compute(const ome::files::VariantPixelBuffer& buffer,
+              unsigned int                          threads = 0);
+
+      /**
+       * Get the number of channels.
+       *
+       * @returns the number of samples per pixel.
+       */
+      std::size_t
+      channels() const;
+
+      /**
+       * Get the bin counts for a channel.
+       *
+       * @param channel the channel (sample) index.
+       * @returns the bin counts.
+       */
+      const bin_array&
+      counts(std::size_t channel) const;
+
+      /**
+       * Get the histogram data for a channel.
+       *
+       * @param channel the channel (sample) index.
+       * @returns the channel histogram.
+       */
+      const Channel&
+      channel(std::size_t channel) const;
+
+      /**
+       * Get the total sample count for a channel.
+       *
+       * Non-finite floating point samples are not counted.
+       *
+       * @param channel the channel (sample) index.
+       * @returns the number of samples binned.
+       */
+      uint64_t
+      total(std::size_t channel) const;
+
+      /**
+       * Get the value of the lower edge of a bin.
+       *
+       * @param channel the channel (sample) index.
+       * @param bin the bin index.
+       * @returns the sample value.
+       */
+      double
+      binValue(std::size_t channel,
+               std::size_t bin) const;
+
+      /**
+       * Get the width of the bins for a channel.
+       *
+       * @param channel the channel (sample) index.
+       * @returns the bin width (1 for exactly binned types).
+       */
+      double
+      binWidth(std::size_t channel) const;
+
+      /**
+       * Get the mean sample value.
+       *
+       * The mean is computed from the bin centres, so is exact only
+       * for exactly binned types.
+       *
+       * @param channel the channel (sample) index.
+       * @returns the mean, or 0 if the channel is empty.
+       */
+      double
+      mean(std::size_t channel) const;
+
+      /**
+       * Get a percentile.
+       *
+       * The value is interpolated within the bin containing the
+       * specified fraction of the cumulative sample count; exactly
+       * binned types return the exact sample value.
+       *
+       * @param channel the channel (sample) index.
+       * @param fraction the fraction of samples (0 to 1).
+       * @returns the sample value, or 0 if the channel is empty.
+       */
+      double
+      percentile(std::size_t channel,
+                 double      fraction) const;
+
+      /**
+       * Get a contrast range.
+       *
+       * The range excludes the specified fraction of saturated
+       * samples at each end of the histogram.
+       *
+       * @param channel the channel (sample) index.
+       * @param saturation the fraction of samples to saturate at
+       * each end.
+       * @returns the lower and upper sample values.
+       */
+      std::pair<double, double>
+      range(std::size_t channel,
+            double      saturation) const;
+
+    private:
+      /// Channel histograms.
+      std::vector<Channel> data;
+    };
+
+    /**
+     * Get the value of a sample as binned and rendered.
+     *
+     * @param value the sample.
+     * @returns the sample value.
+     */
+    template<typename T>
+    inline double
+    sample_value(const T& value)
+    {
+      return static_cast<double>(value);
+    }
+
+    /**
+     * Get the value of a complex sample as binned and rendered.
+     *
+     * This is the real part, which is the component rendered by
+     * Image2D.
+     *
+     * @param value the sample.
+     * @returns the real part of the sample.
+     */
+    template<typename T>
+    inline double
+    sample_value(const std::complex<T>& value)
+    {
+      return static_cast<double>(value.real());
+    }
+
+  }
+}
+
+#endif // OME_QTWIDGETS_HISTOGRAM_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
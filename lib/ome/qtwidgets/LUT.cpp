@@ -0,0 +1,240 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+
+#include <ome/qtwidgets/LUT.h>
+
+namespace
+{
+
+  using ome::qtwidgets::LUT;
+
+  LUT::point_type
+  point(float         position,
+        unsigned int  rgb)
+  {
+    LUT::entry_type entry =
+      {
+        static_cast<float>((rgb >> 16) & 0xFFU) / 255.0f,
+        static_cast<float>((rgb >> 8) & 0xFFU) / 255.0f,
+        static_cast<float>(rgb & 0xFFU) / 255.0f,
+        1.0f
+      };
+    return LUT::point_type(position, entry);
+  }
+
+  // Control points for each standard lookup table.
+  struct StandardLUT
+  {
+    const char *name;
+    std::vector<LUT::point_type> points;
+  };
+
+  const std::vector<StandardLUT>&
+  standard_luts()
+  {
+    static const std::vector<StandardLUT> luts
+      {
+        {"HiLo",     {point(0.0f, 0x000000), point(1.0f, 0xFFFFFF)}},
+        {"Grey",     {point(0.0f, 0x000000), point(1.0f, 0xFFFFFF)}},
+        {"Inverted", {point(0.0f, 0xFFFFFF), point(1.0f, 0x000000)}},
+        {"Red",      {point(0.0f, 0x000000), point(1.0f, 0xFF0000)}},
+        {"Green",    {point(0.0f, 0x000000), point(1.0f, 0x00FF00)}},
+        {"Blue",     {point(0.0f, 0x000000), point(1.0f, 0x0000FF)}},
+        {"Cyan",     {point(0.0f, 0x000000), point(1.0f, 0x00FFFF)}},
+        {"Magenta",  {point(0.0f, 0x000000), point(1.0f, 0xFF00FF)}},
+        {"Yellow",   {point(0.0f, 0x000000), point(1.0f, 0xFFFF00)}},
+        {"Fire",     {point(0.0f, 0x000000), point(0.25f, 0x7800B4),
+                      point(0.5f, 0xE6321E), point(0.75f, 0xFFB400),
+                      point(1.0f, 0xFFFFFF)}},
+        {"Viridis",  {point(0.0f, 0x440154), point(0.125f, 0x472D7B),
+                      point(0.25f, 0x3B528B), point(0.375f, 0x2C728E),
+                      point(0.5f, 0x21918C), point(0.625f, 0x28AE80),
+                      point(0.75f, 0x5EC962), point(0.875f, 0xADDC30),
+                      point(1.0f, 0xFDE725)}}
+      };
+    return luts;
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    LUT::LUT():
+      lutname(),
+      entries()
+    {
+    }
+
+    LUT::LUT(const std::string&             name,
+             std::size_t                    size,
+             const std::vector<point_type>& points):
+      lutname(name),
+      entries(size)
+    {
+      if (points.empty())
+        return;
+
+      std::vector<point_type>::const_iterator next = points.begin();
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          const float pos = size > 1 ? static_cast<float>(i) / static_cast<float>(size - 1) : 0.0f;
+          while (next != points.end() && next->first < pos)
+            ++next;
+
+          if (next == points.begin())
+            entries[i] = next->second;
+          else if (next == points.end())
+            entries[i] = points.back().second;
+          else
+            {
+              const point_type& lower(*(next - 1));
+              const float range = next->first - lower.first;
+              const float f = range > 0.0f ? (pos - lower.first) / range : 0.0f;
+              for (std::size_t c = 0; c < 4; ++c)
+                entries[i][c] = lower.second[c] + (f * (next->second[c] - lower.second[c]));
+            }
+        }
+    }
+
+    const std::string&
+    LUT::name() const
+    {
+      return lutname;
+    }
+
+    std::size_t
+    LUT::size() const
+    {
+      return entries.size();
+    }
+
+    LUT::entry_type&
+    LUT::operator[] (std::size_t index)
+    {
+      return entries[index];
+    }
+
+    const LUT::entry_type&
+    LUT::operator[] (std::size_t index) const
+    {
+      return entries[index];
+    }
+
+    const float *
+    LUT::data() const
+    {
+      return entries.empty() ? 0 : entries[0].data();
+    }
+
+    const std::vector<std::string>&
+    standardLUTNames()
+    {
+      static const std::vector<std::string> names
+        ([]()
+         {
+           std::vector<std::string> n;
+           for (const auto& lut : standard_luts())
+             n.push_back(lut.name);
+           return n;
+         }());
+      return names;
+    }
+
+    int
+    standardLUTIndex(const std::string& name)
+    {
+      const std::vector<std::string>& names(standardLUTNames());
+      std::vector<std::string>::const_iterator i = std::find(names.begin(), names.end(), name);
+      return i == names.end() ? -1 : static_cast<int>(i - names.begin());
+    }
+
+    LUT
+    standardLUT(const std::string& name,
+                std::size_t        size)
+    {
+      for (const auto& lut : standard_luts())
+        {
+          if (name == lut.name)
+            {
+              LUT ret(name, size, lut.points);
+              if (name == "HiLo" && size > 1)
+                {
+                  // Lo (blue) and Hi (red) mark clipping at either end.
+                  ret[0] = LUT::entry_type{0.0f, 0.0f, 1.0f, 1.0f};
+                  ret[size - 1] = LUT::entry_type{1.0f, 0.0f, 0.0f, 1.0f};
+                }
+              return ret;
+            }
+        }
+      return LUT();
+    }
+
+    LUT8
+    greyLUT()
+    {
+      LUT8 lut;
+      for (uint16_t i = 0; i < 256; ++i)
+        for (uint16_t j = 0; j < 3; ++j)
+          {
+            lut[i][j] = static_cast<uint8_t>(i);
+          }
+      return lut;
+    }
+
+    LUT8
+    hiloLUT()
+    {
+      LUT8 lut(greyLUT());
+      // Lo (blue).
+      lut[0][0] = 0;
+      lut[0][1] = 0;
+      lut[0][2] = 255;
+      // Hi (red).
+      lut[255][0] = 255;
+      lut[255][1] = 0;
+      lut[255][2] = 0;
+      return lut;
+    }
+
+  }
+}
@@ -0,0 +1,202 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_LUT_H
+#define OME_QTWIDGETS_LUT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /// 8-bit RGB lookup table with 256 entries.
+    typedef std::array<std::array<uint8_t, 3>, 256> LUT8;
+
+    /**
+     * RGBA lookup table of arbitrary length.
+     *
+     * Entries are floating point (0 to 1), so that tables with many
+     * entries may be used to colour 16-bit and floating point data
+     * without first quantising to 8 bits.
+     */
+    class LUT
+    {
+    public:
+      /// A single RGBA entry.
+      typedef std::array<float, 4> entry_type;
+
+      /// A control point (position from 0 to 1, and colour).
+      typedef std::pair<float, entry_type> point_type;
+
+      /// Construct an empty lookup table.
+      LUT();
+
+      /**
+       * Construct a lookup table by interpolation.
+       *
+       * Entries are linearly interpolated between the control
+       * points, which must be ordered by position.
+       *
+       * @param name the name of the lookup table.
+       * @param size the number of entries.
+       * @param points the control points.
+       */
+      LUT(const std::string&             name,
+          std::size_t                    size,
+          const std::vector<point_type>& points);
+
+      /**
+       * Get the name.
+       *
+       * @returns the name of the lookup table.
+       */
+      const std::string&
+      name() const;
+
+      /**
+       * Get the number of entries.
+       *
+       * @returns the entry count.
+       */
+      std::size_t
+      size() const;
+
+      /**
+       * Get an entry.
+       *
+       * @param index the entry index.
+       * @returns the entry.
+       */
+      entry_type&
+      operator[] (std::size_t index);
+
+      /**
+       * Get an entry.
+       *
+       * @param index the entry index.
+       * @returns the entry.
+       */
+      const entry_type&
+      operator[] (std::size_t index) const;
+
+      /**
+       * Get the entry data.
+       *
+       * The data is tightly packed RGBA floats, suitable for texture
+       * upload.
+       *
+       * @returns a pointer to the first entry.
+       */
+      const float *
+      data() const;
+
+    private:
+      /// Lookup table name.
+      std::string lutname;
+      /// Lookup table entries.
+      std::vector<entry_type> entries;
+    };
+
+    /**
+     * Get the names of the standard lookup tables.
+     *
+     * The order is fixed, and corresponds to the rows of the shared
+     * LUT texture.
+     *
+     * @returns the lookup table names.
+     */
+    const std::vector<std::string>&
+    standardLUTNames();
+
+    /**
+     * Get the index of a standard lookup table.
+     *
+     * @param name the lookup table name.
+     * @returns the index, or -1 if there is no table with this name.
+     */
+    int
+    standardLUTIndex(const std::string& name);
+
+    /**
+     * Create a standard lookup table.
+     *
+     * @param name the lookup table name.
+     * @param size the number of entries.
+     * @returns the lookup table, which is empty if there is no table
+     * with this name.
+     */
+    LUT
+    standardLUT(const std::string& name,
+                std::size_t        size);
+
+    /**
+     * Create a "HiLo" lookup table.
+     *
+     * This is a greyscale ramp with the lowest value shown in blue
+     * and the highest value shown in red, to make clipping at either
+     * end of the contrast range visible.
+     *
+     * @returns the lookup table.
+     */
+    LUT8
+    hiloLUT();
+
+    /**
+     * Create a greyscale lookup table.
+     *
+     * @returns the lookup table.
+     */
+    LUT8
+    greyLUT();
+
+  }
+}
+
+#endif // OME_QTWIDGETS_LUT_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,581 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <ome/files/PixelBuffer.h>
+#include <ome/files/PixelProperties.h>
+#include <ome/files/tiff/IFD.h>
+#include <ome/files/tiff/TIFF.h>
+
+#include <ome/xml/meta/MetadataRetrieve.h>
+
+#include <ome/qtwidgets/MappedPlane.h>
+#include <ome/qtwidgets/SeriesInfo.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QString>
+
+// Required with Boost 1.53 after variant include.
+#include <boost/preprocessor.hpp>
+
+#include <tiffio.h>
+
+using ome::files::dimension_size_type;
+using ome::files::PixelBuffer;
+using ome::files::PixelBufferBase;
+using ome::files::VariantPixelBuffer;
+using ome::qtwidgets::SeriesInfo;
+using ome::xml::model::enums::DimensionOrder;
+
+namespace
+{
+
+  // Plane file index for planes without TiffData.
+  const std::size_t no_file = std::numeric_limits<std::size_t>::max();
+
+  // Sample offset for IFDs which can not be mapped.
+  const uint64_t no_offset = std::numeric_limits<uint64_t>::max();
+
+  /*
+   * A read-only mapping of a TIFF file.
+   *
+   * The IFDs are read with the OME Files TIFF API when first used,
+   * and the sample offset found for each IFD is retained.  Use of
+   * the TIFF is serialised; the mapping itself is immutable and may
+   * be used from any thread.
+   */
+  class MappedFile
+  {
+  public:
+    explicit
+    MappedFile(const QString& path):
+      file(path),
+      data(nullptr),
+      size(0),
+      modified(),
+      tiff(),
+      mutex(),
+      offsets()
+    {
+      if (!file.open(QIODevice::ReadOnly))
+        return;
+      qint64 length = file.size();
+      if (length < 8)
+        return;
+
+      try
+        {
+          tiff = ome::files::tiff::TIFF::open(QFile::encodeName(path).constData(), "r");
+        }
+      catch (const std::exception&)
+        {
+          // Not a TIFF file.
+          return;
+        }
+
+      data = file.map(0, length);
+      if (!data)
+        {
+          tiff.reset();
+          return;
+        }
+      size = static_cast<uint64_t>(length);
+      modified = QFileInfo(path).lastModified();
+    }
+
+    ~MappedFile()
+    {
+      if (data)
+        file.unmap(data);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile&
+    operator= (const MappedFile&) = delete;
+
+    /*
+     * Check if the file is a mapped TIFF.
+     */
+    bool
+    valid() const
+    {
+      return data != nullptr;
+    }
+
+    /*
+     * Check the file is unchanged since it was mapped.  Reading
+     * beyond the end of a truncated file raises SIGBUS.
+     */
+    bool
+    unchanged() const
+    {
+      QFileInfo info(file.fileName());
+      return info.exists() &&
+        static_cast<uint64_t>(info.size()) == size &&
+        info.lastModified() == modified;
+    }
+
+    /*
+     * Locate the samples of an IFD in the mapping.
+     */
+    bool
+    locate(uint64_t          ifd,
+           const SeriesInfo& info,
+           unsigned int      bytes,
+           uint64_t&         offset)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto found = offsets.find(ifd);
+      if (found == offsets.end())
+        found = offsets.insert(std::make_pair(ifd, find(ifd, info, bytes))).first;
+      offset = found->second;
+      return offset != no_offset;
+    }
+
+    /*
+     * Get the mapped data.
+     */
+    uchar *
+    pixels(uint64_t offset) const
+    {
+      return data + offset;
+    }
+
+  private:
+    /*
+     * Find the samples of an IFD.
+     *
+     * The samples must be uncompressed, untiled and chunky, in a
+     * single contiguous run of strips matching the series dimensions
+     * and pixel type, and in native byte order.
+     */
+    uint64_t
+    find(uint64_t          ifd,
+         const SeriesInfo& info,
+         unsigned int      bytes)
+    {
+      try
+        {
+          std::shared_ptr<ome::files::tiff::IFD> dir
+            (tiff->getDirectoryByIndex(static_cast<ome::files::tiff::directory_index_type>(ifd)));
+
+          if (dir->getImageWidth() != info.sizeX ||
+              dir->getImageHeight() != info.sizeY ||
+              dir->getSamplesPerPixel() != info.samples ||
+              dir->getPixelType() != info.pixelType ||
+              (info.samples > 1 && dir->getPlanarConfiguration() != ome::files::tiff::CONTIG))
+            return no_offset;
+
+          dir->makeCurrent();
+          ::TIFF *raw = *tiff;
+
+          // BlackIsZero and RGB only; other interpretations are
+          // transformed by the reader.
+          uint16_t compression = 0, photometric = 0, fill = 0;
+          if (TIFFIsTiled(raw) ||
+              !TIFFGetFieldDefaulted(raw, TIFFTAG_COMPRESSION, &compression) ||
+              !TIFFGetField(raw, TIFFTAG_PHOTOMETRIC, &photometric) ||
+              !TIFFGetFieldDefaulted(raw, TIFFTAG_FILLORDER, &fill) ||
+              compression != COMPRESSION_NONE ||
+              (photometric != PHOTOMETRIC_MINISBLACK && photometric != PHOTOMETRIC_RGB) ||
+              fill != FILLORDER_MSB2LSB ||
+              (bytes > 1 && TIFFIsByteSwapped(raw)))
+            return no_offset;
+
+          // The strips must follow each other without gaps.
+          uint64_t *stripOffsets = nullptr, *stripCounts = nullptr;
+          const uint32_t strips = TIFFNumberOfStrips(raw);
+          if (!strips ||
+              !TIFFGetField(raw, TIFFTAG_STRIPOFFSETS, &stripOffsets) ||
+              !TIFFGetField(raw, TIFFTAG_STRIPBYTECOUNTS, &stripCounts) ||
+              !stripOffsets || !stripCounts)
+            return no_offset;
+
+          const uint64_t start = stripOffsets[0];
+          uint64_t end = start;
+          for (uint32_t s = 0; s < strips; ++s)
+            {
+              if (stripOffsets[s] != end)
+                return no_offset;
+              end += stripCounts[s];
+            }
+
+          const uint64_t expected = static_cast<uint64_t>(info.sizeX) * info.sizeY * info.samples * bytes;
+          if (end - start != expected ||
+              start > size || expected > size - start ||
+              start % bytes != 0)
+            return no_offset;
+
+          return start;
+        }
+      catch (const std::exception&)
+        {
+          return no_offset;
+        }
+    }
+
+    /// The file.
+    QFile file;
+    /// The mapped file content.
+    uchar *data;
+    /// Size of the mapping (bytes).
+    uint64_t size;
+    /// Modification time when mapped.
+    QDateTime modified;
+    /// The TIFF, for reading IFDs.
+    std::shared_ptr<ome::files::tiff::TIFF> tiff;
+    /// Lock for the TIFF and offsets.
+    std::mutex mutex;
+    /// Sample offset by IFD index.
+    std::map<uint64_t, uint64_t> offsets;
+  };
+
+  /*
+   * Plane locations of a series.
+   */
+  struct SeriesPlanes
+  {
+    /// The reader.
+    std::weak_ptr<ome::files::FormatReader> reader;
+    /// Series metadata.
+    std::shared_ptr<const SeriesInfo> info;
+    /// File index and IFD by plane index.
+    std::vector<std::pair<std::size_t, uint64_t>> locations;
+    /// Paths of the files containing the planes.
+    std::vector<QString> paths;
+    /// Mapped files, opened on first use.
+    std::vector<std::shared_ptr<MappedFile>> files;
+  };
+
+  typedef std::pair<const ome::files::FormatReader *, dimension_size_type> cache_key;
+
+  std::mutex cache_mutex;
+  std::map<cache_key, std::shared_ptr<SeriesPlanes>> cache;
+  // Mappings are shared by the readers of a file.
+  std::map<QString, std::weak_ptr<MappedFile>> mapped_files;
+
+  /*
+   * Find the plane locations of a series from its TiffData metadata.
+   */
+  std::shared_ptr<SeriesPlanes>
+  series_planes(const std::shared_ptr<ome::files::FormatReader>& reader,
+                dimension_size_type                              series)
+  {
+    std::shared_ptr<SeriesPlanes> planes(std::make_shared<SeriesPlanes>());
+    planes->reader = reader;
+    planes->info = SeriesInfo::get(reader, series);
+    planes->locations.assign(planes->info->imageCount, std::make_pair(no_file, uint64_t(0)));
+
+    const boost::optional<boost::filesystem::path>& current(reader->getCurrentFile());
+    std::shared_ptr<ome::xml::meta::MetadataRetrieve> meta
+      (std::dynamic_pointer_cast<ome::xml::meta::MetadataRetrieve>(reader->getMetadataStore()));
+    if (!current || !meta)
+      return planes;
+
+    QString currentPath(QFileInfo(QString::fromStdString(current->string())).absoluteFilePath());
+    QDir dir(QFileInfo(currentPath).absoluteDir());
+
+    dimension_size_type count = 0;
+    try
+      {
+        count = meta->getTiffDataCount(series);
+      }
+    catch (const std::exception&)
+      {
+        return planes;
+      }
+
+    for (dimension_size_type td = 0; td < count; ++td)
+      {
+        // Unset attributes throw; use the schema defaults.
+        dimension_size_type ifd = 0, firstZ = 0, firstC = 0, firstT = 0;
+        dimension_size_type planeCount = planes->info->imageCount;
+        bool ifdSet = false, planeCountSet = false;
+        std::string filename;
+
+        try
+          {
+            ifd = meta->getTiffDataIFD(series, td);
+            ifdSet = true;
+          }
+        catch (const std::exception&)
+          {
+          }
+        try
+          {
+            planeCount = meta->getTiffDataPlaneCount(series, td);
+            planeCountSet = true;
+          }
+        catch (const std::exception&)
+          {
+          }
+        try
+          {
+            firstZ = meta->getTiffDataFirstZ(series, td);
+          }
+        catch (const std::exception&)
+          {
+          }
+        try
+          {
+            firstC = meta->getTiffDataFirstC(series, td);
+          }
+        catch (const std::exception&)
+          {
+          }
+        try
+          {
+            firstT = meta->getTiffDataFirstT(series, td);
+          }
+        catch (const std::exception&)
+          {
+          }
+        try
+          {
+            filename = meta->getUUIDFileName(series, td);
+          }
+        catch (const std::exception&)
+          {
+          }
+
+        if (ifdSet && !planeCountSet)
+          planeCount = 1;
+
+        QString path(filename.empty() ? currentPath : dir.absoluteFilePath(QString::fromStdString(filename)));
+        std::size_t file = 0;
+        while (file < planes->paths.size() && planes->paths[file] != path)
+          ++file;
+        if (file == planes->paths.size())
+          planes->paths.push_back(path);
+
+        // Planes are stored in dimension order from the first plane.
+        dimension_size_type start = planes->info->getIndex(firstZ, firstC, firstT);
+        for (dimension_size_type p = 0;
+             p < planeCount && start + p < planes->info->imageCount;
+             ++p)
+          planes->locations[start + p] = std::make_pair(file, ifd + p);
+      }
+
+    planes->files.resize(planes->paths.size());
+    return planes;
+  }
+
+  /*
+   * Find the plane locations of a series, building them if not
+   * cached.  The locations are built without holding the cache
+   * lock, since reading the metadata may be slow.
+   */
+  std::shared_ptr<SeriesPlanes>
+  cached_planes(const std::shared_ptr<ome::files::FormatReader>& reader,
+                dimension_size_type                              series)
+  {
+    cache_key key(reader.get(), series);
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+
+      // Drop entries for destroyed readers; their addresses may be
+      // reused.
+      for (auto i = cache.begin(); i != cache.end();)
+        {
+          if (i->second->reader.expired())
+            i = cache.erase(i);
+          else
+            ++i;
+        }
+
+      auto found = cache.find(key);
+      if (found != cache.end())
+        return found->second;
+    }
+
+    std::shared_ptr<SeriesPlanes> planes(series_planes(reader, series));
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    // Another thread may have built the same entry meanwhile.
+    return cache.insert(std::make_pair(key, planes)).first->second;
+  }
+
+  /*
+   * Get the shared mapping of a plane file, opening it if not
+   * already mapped.  The file is opened without holding the cache
+   * lock.
+   */
+  std::shared_ptr<MappedFile>
+  cached_mapping(SeriesPlanes& planes,
+                 std::size_t   index)
+  {
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+      if (planes.files[index])
+        return planes.files[index];
+    }
+
+    std::shared_ptr<MappedFile> opened(std::make_shared<MappedFile>(planes.paths[index]));
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (!planes.files[index])
+      {
+        for (auto i = mapped_files.begin(); i != mapped_files.end();)
+          {
+            if (i->second.expired())
+              i = mapped_files.erase(i);
+            else
+              ++i;
+          }
+
+        // Use the mapping of another reader of the same file, if any.
+        std::shared_ptr<MappedFile> existing;
+        auto found = mapped_files.find(planes.paths[index]);
+        if (found != mapped_files.end())
+          existing = found->second.lock();
+        if (!existing)
+          {
+            existing = opened;
+            mapped_files[planes.paths[index]] = opened;
+          }
+        planes.files[index] = existing;
+      }
+    return planes.files[index];
+  }
+
+  /*
+   * Wrap the mapped samples of an IFD in a pixel buffer.
+   */
+  template<typename T>
+  std::shared_ptr<VariantPixelBuffer>
+  map_buffer(const std::shared_ptr<MappedFile>& file,
+             uint64_t                           ifd,
+             const SeriesInfo&                  info)
+  {
+    std::shared_ptr<VariantPixelBuffer> ret;
+
+    uint64_t offset = 0;
+    if (!file->locate(ifd, info, sizeof(T), offset))
+      return ret;
+
+    // Interleaved XYZTC storage order is chunky samples in rows, as
+    // stored in the strips.  The buffer keeps the mapping alive.
+    std::shared_ptr<PixelBuffer<T>> buffer
+      (new PixelBuffer<T>(reinterpret_cast<T *>(file->pixels(offset)),
+                          boost::extents[info.sizeX][info.sizeY][1][1][1][1][1][1][info.samples],
+                          info.pixelType,
+                          ome::files::ENDIAN_NATIVE,
+                          PixelBufferBase::make_storage_order(DimensionOrder::XYZTC, true)),
+       [file](PixelBuffer<T> *p) { delete p; });
+
+    ret = std::make_shared<VariantPixelBuffer>(buffer);
+    return ret;
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    // No switch default to avoid -Wunreachable-code errors.
+    // However, this then makes -Wswitch-default complain.  Disable
+    // temporarily.
+#ifdef __GNUC__
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wswitch-default"
+#endif
+
+#define MAP_CASE(maR, maProperty, maType)                               \
+    case ::ome::xml::model::enums::PixelType::maType:                   \
+      ret = map_buffer<ome::files::PixelProperties<::ome::xml::model::enums::PixelType::maType>::std_type>(file, ifd, *info); \
+      break;
+
+    std::shared_ptr<ome::files::VariantPixelBuffer>
+    mapPlane(const std::shared_ptr<ome::files::FormatReader>& reader,
+             ome::files::dimension_size_type                  series,
+             ome::files::dimension_size_type                  plane)
+    {
+      std::shared_ptr<VariantPixelBuffer> ret;
+      if (!reader)
+        return ret;
+
+      std::shared_ptr<SeriesPlanes> planes(cached_planes(reader, series));
+
+      // The locations are immutable once built.
+      if (plane >= planes->locations.size() ||
+          planes->locations[plane].first == no_file)
+        return ret;
+
+      std::shared_ptr<const SeriesInfo> info(planes->info);
+      std::shared_ptr<MappedFile> file(cached_mapping(*planes, planes->locations[plane].first));
+      uint64_t ifd = planes->locations[plane].second;
+
+      // The buffer is not used if the file was truncated or replaced.
+      if (!file->valid() || !file->unchanged())
+        return ret;
+
+      switch(info->pixelType)
+        {
+          BOOST_PP_SEQ_FOR_EACH(MAP_CASE, size, OME_XML_MODEL_ENUMS_PIXELTYPE_VALUES);
+        }
+
+      return ret;
+    }
+
+#undef MAP_CASE
+
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif
+
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
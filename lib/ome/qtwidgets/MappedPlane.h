@@ -0,0 +1,101 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_MAPPEDPLANE_H
+#define OME_QTWIDGETS_MAPPEDPLANE_H
+
+#include <memory>
+
+#include <ome/files/FormatReader.h>
+#include <ome/files/VariantPixelBuffer.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Map an uncompressed OME-TIFF plane directly from its file.
+     *
+     * The plane is located using the TiffData elements of the
+     * OME-XML metadata.  If its IFD describes a single uncompressed
+     * and contiguous block of samples, in native byte order and with
+     * the pixel type of the series, the file is memory-mapped and a
+     * pixel buffer is returned which references the mapped data
+     * directly.  Decoding and the intermediate copy made by
+     * FormatReader::openBytes() are avoided, and the pixel data may
+     * be uploaded to a texture straight from the page cache.
+     *
+     * The returned buffer is read-only; writing to it is undefined.
+     * The mapping is released when the last reference to the buffer
+     * and the reader are released.
+     *
+     * Planes which can not be mapped, for example compressed or
+     * tiled planes or files which are not OME-TIFF, return null, and
+     * must be read with openBytes() instead.  The IFD of each plane
+     * is read with the OME Files TIFF API when first mapped.
+     *
+     * No buffer is returned if the size or modification time of the
+     * file has changed since it was mapped.  However, a file must
+     * not be truncated while a returned buffer is in use; accessing
+     * pages beyond the end of the file raises SIGBUS.
+     *
+     * This function is thread-safe provided that the reader is not
+     * in use by another thread.
+     *
+     * @param reader the image reader.
+     * @param series the image series.
+     * @param plane the plane index.
+     * @returns the mapped pixel data, or null if the plane can not be
+     * mapped.
+     */
+    std::shared_ptr<ome::files::VariantPixelBuffer>
+    mapPlane(const std::shared_ptr<ome::files::FormatReader>& reader,
+             ome::files::dimension_size_type                  series,
+             ome::files::dimension_size_type                  plane);
+
+  }
+}
+
+#endif // OME_QTWIDGETS_MAPPEDPLANE_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -36,6 +36,7 @@
  * #L%
  */
 
+#include <QtCore/QTimerEvent>
 #include <QtGui/QMouseEvent>
 
 #include <array>
@@ -84,6 +85,7 @@ namespace ome
     NavigationDock2D::NavigationDock2D(QWidget *parent):
       QDockWidget(tr("Navigation"), parent),
       currentPlane(),
+      changeTimer(),
       labels(),
       sliders(),
       spinboxes()
@@ -138,25 +140,23 @@ namespace ome
     {
       this->reader = reader;
       this->series = series;
+      info = reader ? SeriesInfo::get(reader, series) : std::shared_ptr<const SeriesInfo>();
 
-      if (reader)
+      if (info)
         {
-          ome::files::dimension_size_type oldseries = reader->getSeries();
-          reader->setSeries(series);
-          dimension_size_type imageCount = reader->getImageCount();
+          dimension_size_type imageCount = info->imageCount;
           // Full dimension sizes.
-          dimension_size_type z = reader->getSizeZ();
-          dimension_size_type t = reader->getSizeT();
-          dimension_size_type c = reader->getSizeC();
+          dimension_size_type z = info->sizeZ;
+          dimension_size_type t = info->sizeT;
+          dimension_size_type c = info->sizeC;
           // Modulo dimension sizes.
-          dimension_size_type mz = reader->getModuloZ().size();
-          dimension_size_type mt = reader->getModuloT().size();
-          dimension_size_type mc = reader->getModuloC().size();
+          dimension_size_type mz = info->moduloZ;
+          dimension_size_type mt = info->moduloT;
+          dimension_size_type mc = info->moduloC;
           // Effective dimension sizes.
           dimension_size_type ez = z / mz;
           dimension_size_type et = t / mt;
           dimension_size_type ec = c / mc;
-          reader->setSeries(oldseries);
 
           dimension_size_type extents[7] = {imageCount, ez, mz, et, mt, ec, mc};
           std::cout << "EXTENTS: " << imageCount << ", " <<  ez << ", " <<  mz << ", " <<  et << ", " <<  mt << ", " <<  ec << ", " <<  mc << "\n";
@@ -215,17 +215,14 @@ namespace ome
         {
           currentPlane = plane;
 
-          if (reader)
+          if (info)
             {
-              ome::files::dimension_size_type oldseries = reader->getSeries();
-              reader->setSeries(series);
               // Modulo dimension sizes.
-              dimension_size_type mz = reader->getModuloZ().size();
-              dimension_size_type mt = reader->getModuloT().size();
-              dimension_size_type mc = reader->getModuloC().size();
+              dimension_size_type mz = info->moduloZ;
+              dimension_size_type mt = info->moduloT;
+              dimension_size_type mc = info->moduloC;
 
-              std::array<dimension_size_type, 3> coords(reader->getZCTCoords(plane));
-              reader->setSeries(oldseries);
+              const SeriesInfo::Coords& coords(info->getZCTCoords(plane));
 
               // Effective and modulo dimension positions
               dimension_size_type ezv = coords[0] / mz;
@@ -235,16 +232,34 @@ namespace ome
               dimension_size_type ecv = coords[1] / mc;
               dimension_size_type mcv = coords[1] % mc;
 
+              // Block signals so that partially updated dimension
+              // positions are not signalled as plane changes.
               dimension_size_type values[7] = {plane, ezv, mzv, etv, mtv, ecv, mcv};
               for (uint16_t i = 0; i < 7; ++i)
                 {
-                  sliders[i] -> setValue(static_cast<int>(values[i]));
-                  spinboxes[i] -> setValue(static_cast<int>(values[i]));
+                  sliders[i]->blockSignals(true);
+                  sliders[i]->setValue(static_cast<int>(values[i]));
+                  sliders[i]->blockSignals(false);
+                  spinboxes[i]->blockSignals(true);
+                  spinboxes[i]->setValue(static_cast<int>(values[i]));
+                  spinboxes[i]->blockSignals(false);
                 }
             }
 
+          changeTimer.start(0, this);
+        }
+    }
+
+    void
+    NavigationDock2D::timerEvent(QTimerEvent *event)
+    {
+      if (event->timerId() == changeTimer.timerId())
+        {
+          changeTimer.stop();
           emit planeChanged(currentPlane);
         }
+      else
+        QDockWidget::timerEvent(event);
     }
 
     ome::files::dimension_size_type
@@ -268,14 +283,12 @@ namespace ome
     void
     NavigationDock2D::sliderChangedDimension(int /* dim */)
     {
-      if (reader)
+      if (info)
         {
-          ome::files::dimension_size_type oldseries = reader->getSeries();
-          reader->setSeries(series);
           // Modulo dimension sizes.
-          dimension_size_type mz = reader->getModuloZ().size();
-          dimension_size_type mt = reader->getModuloT().size();
-          dimension_size_type mc = reader->getModuloC().size();
+          dimension_size_type mz = info->moduloZ;
+          dimension_size_type mt = info->moduloT;
+          dimension_size_type mc = info->moduloC;
 
           // Current dimension sizes.
           dimension_size_type ezv = static_cast<dimension_size_type>(sliders[1]->value());
@@ -289,25 +302,19 @@ namespace ome
           dimension_size_type t = (etv * mt) + mtv;
           dimension_size_type c = (ecv * mc) + mcv;
 
-          dimension_size_type index = reader->getIndex(z, c, t);
-
-          reader->setSeries(oldseries);
-
-          setPlane(index);
+          setPlane(info->getIndex(z, c, t));
         }
     }
 
     void
     NavigationDock2D::spinBoxChangedDimension(int /* dim */)
     {
-      if (reader)
+      if (info)
         {
-          ome::files::dimension_size_type oldseries = reader->getSeries();
-          reader->setSeries(series);
           // Modulo dimension sizes.
-          dimension_size_type mz = reader->getModuloZ().size();
-          dimension_size_type mt = reader->getModuloT().size();
-          dimension_size_type mc = reader->getModuloC().size();
+          dimension_size_type mz = info->moduloZ;
+          dimension_size_type mt = info->moduloT;
+          dimension_size_type mc = info->moduloC;
 
           // Current dimension sizes.
           dimension_size_type ezv = static_cast<dimension_size_type>(spinboxes[1]->value());
@@ -321,11 +328,7 @@ namespace ome
           dimension_size_type t = (etv * mt) + mtv;
           dimension_size_type c = (ecv * mc) + mcv;
 
-          dimension_size_type index = reader->getIndex(z, c, t);
-
-          reader->setSeries(oldseries);
-
-          setPlane(index);
+          setPlane(info->getIndex(z, c, t));
         }
     }
 
@@ -45,10 +45,13 @@
 
 #include <ome/qtwidgets/glm.h>
 #include <ome/qtwidgets/GLWindow.h>
+#include <ome/qtwidgets/SeriesInfo.h>
 #include <ome/qtwidgets/gl/Image2D.h>
 #include <ome/qtwidgets/gl/Grid2D.h>
 #include <ome/qtwidgets/gl/Axis2D.h>
 
+#include <QtCore/QBasicTimer>
+
 #include <QtWidgets/QDockWidget>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QSlider>
@@ -116,11 +119,26 @@ namespace ome
       /**
        * Signal change of plane.
        *
+       * Changes are coalesced: when the plane is changed several
+       * times before control returns to the event loop, for example
+       * while dragging a slider, only the last plane is signalled.
+       *
        * @param plane the new image plane.
        */
       void
       planeChanged(ome::files::dimension_size_type plane);
 
+    protected:
+      /**
+       * Handle timer events.
+       *
+       * Used to signal coalesced plane changes.
+       *
+       * @param event the event to handle.
+       */
+      void
+      timerEvent(QTimerEvent *event);
+
     private slots:
       /**
        * Update the current plane number (from slider).
@@ -159,8 +177,12 @@ namespace ome
       std::shared_ptr<ome::files::FormatReader> reader;
       /// The image series.
       ome::files::dimension_size_type series;
+      /// Metadata of the image series.
+      std::shared_ptr<const SeriesInfo> info;
       /// The image plane.
       ome::files::dimension_size_type currentPlane;
+      /// Timer to signal coalesced plane changes.
+      QBasicTimer changeTimer;
 
       /// Slider labels [NZTCmZmTmC].
       QLabel *labels[7];
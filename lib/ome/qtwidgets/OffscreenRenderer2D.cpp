@@ -0,0 +1,572 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <cstring>
+#include <iostream>
+
+#include <ome/qtwidgets/OffscreenRenderer2D.h>
+#include <ome/qtwidgets/gl/Util.h>
+
+#include <ome/qtwidgets/gl/v33/V33Image2D.h>
+#include <ome/qtwidgets/gl/v33/V33Grid2D.h>
+#include <ome/qtwidgets/gl/v33/V33Axis2D.h>
+#include <ome/qtwidgets/gl/v33/V33Overlay2D.h>
+#include <ome/qtwidgets/gl/v33/V33PointCloud2D.h>
+
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFramebufferObject>
+
+namespace
+{
+
+  // Number of frames which may be read back asynchronously at once.
+  const std::size_t readback_buffers = 3;
+
+  // Maximum time to wait for an asynchronous readback (ns).
+  const GLuint64 readback_timeout = 5000000000ULL;
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    OffscreenRenderer2D::OffscreenRenderer2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                                             ome::files::dimension_size_type            series,
+                                             const QSize&                               size,
+                                             QObject                                   *parent):
+      QObject(parent),
+      reader(reader),
+      series(series),
+      size(size),
+      axesVisible(true),
+      gridVisible(true),
+      overlayVisible(true),
+      lutRow(0),
+      surface(0),
+      glcontext(0),
+      fbo(0),
+      image(),
+      axes(),
+      overlay(),
+      pointcloud(),
+      grid(),
+      pbos(),
+      nextpbo(0),
+      pending()
+    {
+      QSurfaceFormat format;
+      // OpenGL 3.3 core profile, matching GLWindow.
+      format.setVersion(3, 3);
+      format.setProfile(QSurfaceFormat::CoreProfile);
+
+      surface = new QOffscreenSurface;
+      surface->setFormat(format);
+      surface->create();
+
+      glcontext = new QOpenGLContext(this);
+      glcontext->setFormat(format);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+      if (QOpenGLContext::globalShareContext())
+        glcontext->setShareContext(QOpenGLContext::globalShareContext());
+#endif
+      if (!glcontext->create())
+        {
+          std::cerr << "OffscreenRenderer2D: Failed to create OpenGL context" << std::endl;
+          return;
+        }
+
+      if (!glcontext->makeCurrent(surface))
+        {
+          std::cerr << "OffscreenRenderer2D: Failed to make OpenGL context current" << std::endl;
+          return;
+        }
+
+      initializeOpenGLFunctions();
+      createFramebuffer();
+      createPixelBuffers();
+
+      // Layers are drawn back to front, so no depth buffer is needed.
+      glDisable(GL_DEPTH_TEST);
+      gl::check_gl("Disable depth test");
+      glEnable(GL_CULL_FACE);
+      gl::check_gl("Enable cull face");
+      glEnable(GL_BLEND);
+      gl::check_gl("Enable blending");
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      gl::check_gl("Set blend function");
+
+      image = new gl::v33::Image2D(reader, series, this);
+      axes = new gl::v33::Axis2D(reader, series, this);
+      overlay = new gl::v33::Overlay2D(reader, series, this);
+      pointcloud = new gl::v33::PointCloud2D(reader, series, this);
+      grid = new gl::v33::Grid2D(reader, series, this);
+
+      image->create();
+      axes->create();
+      overlay->create();
+      pointcloud->create();
+      grid->create();
+    }
+
+    OffscreenRenderer2D::~OffscreenRenderer2D()
+    {
+      // GL resources must be released with the context current.
+      if (glcontext && glcontext->isValid())
+        {
+          glcontext->makeCurrent(surface);
+          discardFrames();
+          if (!pbos.empty())
+            glDeleteBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+          delete image;
+          delete axes;
+          delete overlay;
+          delete pointcloud;
+          delete grid;
+          delete fbo;
+          glcontext->doneCurrent();
+        }
+      delete surface;
+    }
+
+    bool
+    OffscreenRenderer2D::isValid() const
+    {
+      return glcontext && glcontext->isValid() && fbo && fbo->isValid();
+    }
+
+    QSize
+    OffscreenRenderer2D::getSize() const
+    {
+      return size;
+    }
+
+    void
+    OffscreenRenderer2D::setSize(const QSize& size)
+    {
+      if (this->size != size)
+        {
+          this->size = size;
+          if (glcontext && glcontext->isValid())
+            {
+              glcontext->makeCurrent(surface);
+              createFramebuffer();
+              createPixelBuffers();
+            }
+        }
+    }
+
+    bool
+    OffscreenRenderer2D::getAxesVisible() const
+    {
+      return axesVisible;
+    }
+
+    void
+    OffscreenRenderer2D::setAxesVisible(bool visible)
+    {
+      axesVisible = visible;
+    }
+
+    bool
+    OffscreenRenderer2D::getGridVisible() const
+    {
+      return gridVisible;
+    }
+
+    void
+    OffscreenRenderer2D::setGridVisible(bool visible)
+    {
+      gridVisible = visible;
+    }
+
+    bool
+    OffscreenRenderer2D::getOverlayVisible() const
+    {
+      return overlayVisible;
+    }
+
+    void
+    OffscreenRenderer2D::setOverlayVisible(bool visible)
+    {
+      overlayVisible = visible;
+    }
+
+    void
+    OffscreenRenderer2D::setReaderPool(std::shared_ptr<ReaderPool> pool)
+    {
+      if (image)
+        image->setReaderPool(pool);
+    }
+
+    int
+    OffscreenRenderer2D::getLUTRow() const
+    {
+      return lutRow;
+    }
+
+    void
+    OffscreenRenderer2D::setLUTRow(int row)
+    {
+      lutRow = row;
+    }
+
+    bool
+    OffscreenRenderer2D::setLocalisations(const QString& filename,
+                                          unsigned int   columns,
+                                          unsigned int   xcolumn,
+                                          unsigned int   ycolumn)
+    {
+      if (!pointcloud)
+        return false;
+
+      glcontext->makeCurrent(surface);
+      if (filename.isEmpty())
+        {
+          pointcloud->clear();
+          return true;
+        }
+      return pointcloud->load(filename, columns, xcolumn, ycolumn);
+    }
+
+    bool
+    OffscreenRenderer2D::updateLocalisations()
+    {
+      if (!pointcloud)
+        return true;
+
+      glcontext->makeCurrent(surface);
+      pointcloud->upload();
+      return !pointcloud->isLoading();
+    }
+
+    void
+    OffscreenRenderer2D::createFramebuffer()
+    {
+      delete fbo;
+      fbo = 0;
+
+      QOpenGLFramebufferObjectFormat fboformat;
+      fboformat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+      fbo = new QOpenGLFramebufferObject(size, fboformat);
+      if (!fbo->isValid())
+        std::cerr << "OffscreenRenderer2D: Failed to create framebuffer" << std::endl;
+    }
+
+    void
+    OffscreenRenderer2D::createPixelBuffers()
+    {
+      discardFrames();
+
+      if (pbos.empty())
+        {
+          pbos.resize(readback_buffers);
+          glGenBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+          gl::check_gl("Create readback buffers");
+        }
+
+      GLsizeiptr bytes = static_cast<GLsizeiptr>(size.width()) * size.height() * 4;
+      for (const auto& pbo : pbos)
+        {
+          glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+          glBufferData(GL_PIXEL_PACK_BUFFER, bytes, 0, GL_STREAM_READ);
+          gl::check_gl("Allocate readback buffer");
+        }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      nextpbo = 0;
+    }
+
+    void
+    OffscreenRenderer2D::discardFrames()
+    {
+      if (pending.empty())
+        return;
+
+      glcontext->makeCurrent(surface);
+      for (const auto& frame : pending)
+        glDeleteSync(frame.fence);
+      pending.clear();
+    }
+
+    void
+    OffscreenRenderer2D::makeCurrent()
+    {
+      glcontext->makeCurrent(surface);
+      fbo->bind();
+    }
+
+    void
+    OffscreenRenderer2D::draw(const Camera2D&                                 camera,
+                              const QSizeF&                                   extent,
+                              const QRectF&                                   region,
+                              ome::files::dimension_size_type                 plane,
+                              const glm::vec3&                                min,
+                              const glm::vec3&                                max,
+                              std::shared_ptr<ome::files::VariantPixelBuffer> pixels)
+    {
+      makeCurrent();
+
+      Camera2D cam(camera);
+      cam.update(static_cast<float>(extent.width()),
+                 static_cast<float>(extent.height()));
+      if (region != QRectF(0.0, 0.0, 1.0, 1.0))
+        cam.crop(static_cast<float>(region.left()),
+                 static_cast<float>(1.0 - region.bottom()),
+                 static_cast<float>(region.right()),
+                 static_cast<float>(1.0 - region.top()));
+
+      glViewport(0, 0, size.width(), size.height());
+
+      glClearColor(1.0, 1.0, 1.0, 1.0);
+      gl::check_gl("Clear colour");
+      glClear(GL_COLOR_BUFFER_BIT);
+      gl::check_gl("Clear buffers");
+
+      if (!image->setPlane(plane, pixels))
+        {
+          // Frames must show the requested plane, so wait for a
+          // pooled reader rather than keeping the previous plane.
+          ReaderPool::Lease lease(image->getReaderPool()->acquire(series));
+          if (lease)
+            {
+              pixels = std::make_shared<ome::files::VariantPixelBuffer>();
+              lease->openBytes(plane, *pixels);
+              image->setPlane(plane, pixels);
+            }
+          else
+            std::cerr << "OffscreenRenderer2D: No reader available for plane " << plane << std::endl;
+        }
+      image->setMin(min);
+      image->setMax(max);
+      image->setLUTRow(lutRow);
+      if (overlayVisible)
+        overlay->setPlane(plane);
+      // Every frame shows all of the points.
+      pointcloud->finishLoading();
+
+      glm::mat4 mvp = cam.mvp();
+      if (gridVisible)
+        grid->render(mvp, cam.zoomfactor());
+      image->render(mvp);
+      pointcloud->render(mvp);
+      if (overlayVisible)
+        overlay->render(mvp);
+      if (axesVisible)
+        axes->render(mvp);
+
+      glFlush();
+    }
+
+    QImage
+    OffscreenRenderer2D::render(const Camera2D&                 camera,
+                                ome::files::dimension_size_type plane,
+                                const glm::vec3&                min,
+                                const glm::vec3&                max)
+    {
+      if (!isValid())
+        return QImage();
+
+      draw(camera, QSizeF(size), QRectF(0.0, 0.0, 1.0, 1.0), plane, min, max);
+      QImage ret(fbo->toImage());
+      fbo->release();
+
+      return ret;
+    }
+
+    void
+    OffscreenRenderer2D::render(const Camera2D&                 camera,
+                                ome::files::dimension_size_type plane,
+                                const glm::vec3&                min,
+                                const glm::vec3&                max,
+                                std::vector<uint8_t>&           pixels)
+    {
+      renderRegion(camera, QSizeF(size), QRectF(0.0, 0.0, 1.0, 1.0),
+                   plane, min, max, pixels);
+    }
+
+    void
+    OffscreenRenderer2D::renderRegion(const Camera2D&                 camera,
+                                      const QSizeF&                   extent,
+                                      const QRectF&                   region,
+                                      ome::files::dimension_size_type plane,
+                                      const glm::vec3&                min,
+                                      const glm::vec3&                max,
+                                      std::vector<uint8_t>&           pixels)
+    {
+      if (!isValid())
+        {
+          pixels.clear();
+          return;
+        }
+
+      draw(camera, extent, region, plane, min, max);
+
+      std::size_t rowsize = static_cast<std::size_t>(size.width()) * 4;
+      std::size_t rows = static_cast<std::size_t>(size.height());
+      pixels.resize(rowsize * rows);
+
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      glReadPixels(0, 0, size.width(), size.height(),
+                   GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+      gl::check_gl("Read framebuffer pixels");
+      fbo->release();
+
+      // GL rows are bottom to top; flip to top to bottom.
+      std::vector<uint8_t> row(rowsize);
+      for (std::size_t r = 0; r < rows / 2; ++r)
+        {
+          uint8_t *top = pixels.data() + (r * rowsize);
+          uint8_t *bottom = pixels.data() + ((rows - 1 - r) * rowsize);
+          std::memcpy(row.data(), top, rowsize);
+          std::memcpy(top, bottom, rowsize);
+          std::memcpy(bottom, row.data(), rowsize);
+        }
+    }
+
+    bool
+    OffscreenRenderer2D::queueFrame(const Camera2D&                                 camera,
+                                    ome::files::dimension_size_type                 plane,
+                                    const glm::vec3&                                min,
+                                    const glm::vec3&                                max,
+                                    std::shared_ptr<ome::files::VariantPixelBuffer> pixels)
+    {
+      if (!isValid() || pending.size() >= pbos.size())
+        return false;
+
+      draw(camera, QSizeF(size), QRectF(0.0, 0.0, 1.0, 1.0), plane, min, max, pixels);
+
+      // Read into the pixel buffer object; this returns without
+      // waiting for rendering to complete.
+      PendingFrame frame;
+      frame.pbo = pbos[nextpbo];
+      nextpbo = (nextpbo + 1) % pbos.size();
+
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.pbo);
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      glReadPixels(0, 0, size.width(), size.height(),
+                   GL_RGBA, GL_UNSIGNED_BYTE, 0);
+      gl::check_gl("Start framebuffer readback");
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      fbo->release();
+
+      frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      gl::check_gl("Create readback fence");
+      // Ensure the fence is submitted, so that it is signalled.
+      glFlush();
+      pending.push_back(frame);
+
+      return true;
+    }
+
+    bool
+    OffscreenRenderer2D::takeFrame(std::vector<uint8_t>& pixels,
+                                   bool                  wait)
+    {
+      if (pending.empty())
+        return false;
+
+      glcontext->makeCurrent(surface);
+
+      PendingFrame& frame(pending.front());
+      GLenum status = glClientWaitSync(frame.fence, 0, wait ? readback_timeout : 0);
+      if (status == GL_TIMEOUT_EXPIRED)
+        {
+          if (wait)
+            std::cerr << "OffscreenRenderer2D: Timed out waiting for frame readback" << std::endl;
+          return false;
+        }
+      glDeleteSync(frame.fence);
+      GLuint pbo = frame.pbo;
+      pending.pop_front();
+
+      if (status == GL_WAIT_FAILED)
+        {
+          std::cerr << "OffscreenRenderer2D: Failed to wait for frame readback" << std::endl;
+          pixels.clear();
+          return true;
+        }
+
+      GLsizeiptr bytes = static_cast<GLsizeiptr>(size.width()) * size.height() * 4;
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+      const uint8_t *src = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+      if (src)
+        {
+          copyFrame(src, pixels);
+          glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+      else
+        {
+          std::cerr << "OffscreenRenderer2D: Failed to map readback buffer" << std::endl;
+          pixels.clear();
+        }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+      return true;
+    }
+
+    std::size_t
+    OffscreenRenderer2D::queuedFrames() const
+    {
+      return pending.size();
+    }
+
+    std::size_t
+    OffscreenRenderer2D::maxQueuedFrames() const
+    {
+      return pbos.size();
+    }
+
+    void
+    OffscreenRenderer2D::copyFrame(const uint8_t        *src,
+                                   std::vector<uint8_t>& pixels) const
+    {
+      std::size_t rowsize = static_cast<std::size_t>(size.width()) * 4;
+      std::size_t rows = static_cast<std::size_t>(size.height());
+      pixels.resize(rowsize * rows);
+
+      // GL rows are bottom to top; flip to top to bottom.
+      for (std::size_t r = 0; r < rows; ++r)
+        std::memcpy(pixels.data() + (r * rowsize),
+                    src + ((rows - 1 - r) * rowsize),
+                    rowsize);
+    }
+
+  }
+}
@@ -0,0 +1,498 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_OFFSCREENRENDERER2D_H
+#define OME_QTWIDGETS_OFFSCREENRENDERER2D_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+#include <ome/files/VariantPixelBuffer.h>
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/Camera2D.h>
+#include <ome/qtwidgets/ReaderPool.h>
+#include <ome/qtwidgets/gl/Image2D.h>
+#include <ome/qtwidgets/gl/Grid2D.h>
+#include <ome/qtwidgets/gl/Axis2D.h>
+#include <ome/qtwidgets/gl/Overlay2D.h>
+#include <ome/qtwidgets/gl/PointCloud2D.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QRectF>
+#include <QtCore/QSize>
+#include <QtCore/QSizeF>
+#include <QtGui/QImage>
+#include <QtGui/QOpenGLFunctions_3_3_Core>
+
+QT_BEGIN_NAMESPACE
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+QT_END_NAMESPACE
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Offscreen 2D renderer.
+     *
+     * This renders the same scene as GLView2D (image, point
+     * localisations, ROI overlay, axes and grid) into a framebuffer object bound to an offscreen
+     * surface, so that no window or display is required.  The rendered frame
+     * may be retrieved as a QImage or as a raw RGBA buffer.
+     *
+     * Frames may also be read back asynchronously for rendering
+     * sequences: queueFrame() renders a frame and starts a readback
+     * into a pixel buffer object guarded by a fence, and takeFrame()
+     * retrieves completed frames in order.  Several frames may be in
+     * flight, so that rendering of the next frame overlaps with the
+     * transfer of the previous frames.
+     *
+     * @note The renderer must be constructed on the GUI thread since
+     * the offscreen surface is a platform resource.  It owns its own
+     * GL context, so independent renderers may be used concurrently.
+     */
+    class OffscreenRenderer2D : public QObject,
+                                protected QOpenGLFunctions_3_3_Core
+    {
+      Q_OBJECT
+
+    public:
+      /**
+       * Create an offscreen renderer.
+       *
+       * @param reader the image reader.
+       * @param series the image series.
+       * @param size the size of the render target (pixels).
+       * @param parent the parent of this object.
+       */
+      OffscreenRenderer2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                          ome::files::dimension_size_type            series,
+                          const QSize&                               size,
+                          QObject                                   *parent = 0);
+
+      /// Destructor.
+      ~OffscreenRenderer2D();
+
+      /**
+       * Check if the renderer is usable.
+       *
+       * @returns @c true if the GL context and framebuffer were
+       * created successfully, @c false otherwise.
+       */
+      bool
+      isValid() const;
+
+      /**
+       * Get the render target size.
+       *
+       * @returns the size (pixels).
+       */
+      QSize
+      getSize() const;
+
+      /**
+       * Set the render target size.
+       *
+       * The framebuffer will be reallocated if the size changed.
+       *
+       * @param size the new size (pixels).
+       */
+      void
+      setSize(const QSize& size);
+
+      /**
+       * Get axis visibility.
+       *
+       * @returns @c true if axes are rendered.
+       */
+      bool
+      getAxesVisible() const;
+
+      /**
+       * Set axis visibility.
+       *
+       * @param visible @c true to render axes, @c false to hide.
+       */
+      void
+      setAxesVisible(bool visible);
+
+      /**
+       * Get grid visibility.
+       *
+       * @returns @c true if the grid is rendered.
+       */
+      bool
+      getGridVisible() const;
+
+      /**
+       * Set grid visibility.
+       *
+       * @param visible @c true to render the grid, @c false to hide.
+       */
+      void
+      setGridVisible(bool visible);
+
+      /**
+       * Get ROI overlay visibility.
+       *
+       * @returns @c true if the overlay is rendered.
+       */
+      bool
+      getOverlayVisible() const;
+
+      /**
+       * Set ROI overlay visibility.
+       *
+       * @param visible @c true to render the overlay, @c false to hide.
+       */
+      void
+      setOverlayVisible(bool visible);
+
+      /**
+       * Set the reader pool.
+       *
+       * Planes which are not provided by the caller are read with a
+       * reader leased from the pool, waiting for one if none is
+       * idle.
+       *
+       * @param pool the reader pool, or null to read with the image
+       * reader.
+       */
+      void
+      setReaderPool(std::shared_ptr<ReaderPool> pool);
+
+      /**
+       * Get the lookup table.
+       *
+       * @returns the row of the shared LUT texture.
+       */
+      int
+      getLUTRow() const;
+
+      /**
+       * Set the lookup table.
+       *
+       * @param row the row of the shared LUT texture; see
+       * GLView2D::getLUTRow().
+       */
+      void
+      setLUTRow(int row);
+
+      /**
+       * Set point localisations to render over the image.
+       *
+       * Loading starts immediately, in the background.  Frames are
+       * not rendered until loading is complete; see
+       * updateLocalisations().  See gl::PointCloud2D::load() for the
+       * table format.
+       *
+       * @param filename the binary localisation table, or an empty
+       * string to remove all points.
+       * @param columns the number of float columns per row.
+       * @param xcolumn the column containing the x coordinate.
+       * @param ycolumn the column containing the y coordinate.
+       * @returns @c true on success, @c false if the table could not
+       * be loaded.
+       */
+      bool
+      setLocalisations(const QString& filename,
+                       unsigned int   columns = 2,
+                       unsigned int   xcolumn = 0,
+                       unsigned int   ycolumn = 1);
+
+      /**
+       * Continue loading localisations without blocking.
+       *
+       * Uploads the points binned since the last call.  Callers
+       * which must not block, such as timer-driven exporters, should
+       * call this until it returns @c true before rendering, since
+       * rendering waits for loading to complete.
+       *
+       * @returns @c true if all localisations are loaded, @c false
+       * if loading is still in progress.
+       */
+      bool
+      updateLocalisations();
+
+      /**
+       * Render a frame to an image.
+       *
+       * The view and projection of the camera are recomputed for the
+       * render target size.
+       *
+       * @param camera the camera to render with.
+       * @param plane the plane to render.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @returns the rendered image.
+       */
+      QImage
+      render(const Camera2D&                 camera,
+             ome::files::dimension_size_type plane,
+             const glm::vec3&                min,
+             const glm::vec3&                max);
+
+      /**
+       * Render a frame to a raw buffer.
+       *
+       * The buffer is resized to hold the frame as 8-bit RGBA
+       * samples, with rows ordered from top to bottom.
+       *
+       * @param camera the camera to render with.
+       * @param plane the plane to render.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @param pixels the buffer to fill.
+       */
+      void
+      render(const Camera2D&                 camera,
+             ome::files::dimension_size_type plane,
+             const glm::vec3&                min,
+             const glm::vec3&                max,
+             std::vector<uint8_t>&           pixels);
+
+      /**
+       * Render part of a frame to a raw buffer.
+       *
+       * The view and projection of the camera are computed for a
+       * render target of the specified extent, and the region of
+       * that target is magnified to fill this renderer's target.
+       * This permits rendering images larger than the maximum
+       * framebuffer size as a series of tiles.
+       *
+       * The buffer is resized to hold the region as 8-bit RGBA
+       * samples, with rows ordered from top to bottom.
+       *
+       * @param camera the camera to render with.
+       * @param extent the size of the whole frame (pixels).
+       * @param region the region of the frame to render, as
+       * fractions of the extent, with the origin at the top left.
+       * @param plane the plane to render.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @param pixels the buffer to fill.
+       */
+      void
+      renderRegion(const Camera2D&                 camera,
+                   const QSizeF&                   extent,
+                   const QRectF&                   region,
+                   ome::files::dimension_size_type plane,
+                   const glm::vec3&                min,
+                   const glm::vec3&                max,
+                   std::vector<uint8_t>&           pixels);
+
+      /**
+       * Render a frame and start reading it back asynchronously.
+       *
+       * Fails if the maximum number of frames are already in
+       * flight; completed frames must be retrieved with takeFrame().
+       *
+       * @param camera the camera to render with.
+       * @param plane the plane to render.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @param pixels the decoded pixel data of the plane, or null
+       * to decode with the reader if not cached.
+       * @returns @c true if the frame was queued, @c false otherwise.
+       */
+      bool
+      queueFrame(const Camera2D&                                 camera,
+                 ome::files::dimension_size_type                 plane,
+                 const glm::vec3&                                min,
+                 const glm::vec3&                                max,
+                 std::shared_ptr<ome::files::VariantPixelBuffer> pixels = std::shared_ptr<ome::files::VariantPixelBuffer>());
+
+      /**
+       * Retrieve the oldest frame queued with queueFrame().
+       *
+       * The buffer is resized to hold the frame as 8-bit RGBA
+       * samples, with rows ordered from top to bottom.
+       *
+       * When waiting, the wait is bounded by a timeout of a few
+       * seconds.  If the readback does not complete in that time,
+       * @c false is returned and the frame remains in flight; it
+       * may be retrieved by a later call, or dropped with
+       * discardFrames().
+       *
+       * @param pixels the buffer to fill.
+       * @param wait @c true to block until the readback completes,
+       * @c false to return immediately if it is still in progress.
+       * @returns @c true if a frame was retrieved, @c false if no
+       * frame is queued, the oldest frame is not yet complete (if
+       * not waiting) or the wait timed out.
+       */
+      bool
+      takeFrame(std::vector<uint8_t>& pixels,
+                bool                  wait = false);
+
+      /**
+       * Discard all frames in flight without reading them back.
+       *
+       * Their readback buffers become available to queueFrame()
+       * again.
+       */
+      void
+      discardFrames();
+
+      /**
+       * Get the number of frames in flight.
+       *
+       * @returns the number of frames queued and not yet retrieved.
+       */
+      std::size_t
+      queuedFrames() const;
+
+      /**
+       * Get the maximum number of frames in flight.
+       *
+       * @returns the maximum number of frames.
+       */
+      std::size_t
+      maxQueuedFrames() const;
+
+    protected:
+      /// Make the offscreen context current and bind the framebuffer.
+      void
+      makeCurrent();
+
+      /**
+       * Render the scene into the framebuffer.
+       *
+       * @param camera the camera to render with.
+       * @param extent the size of the whole frame (pixels).
+       * @param region the region of the frame to render, as
+       * fractions of the extent, with the origin at the top left.
+       * @param plane the plane to render.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @param pixels the decoded pixel data of the plane, or null
+       * to decode with the reader if not cached.
+       */
+      void
+      draw(const Camera2D&                                 camera,
+           const QSizeF&                                   extent,
+           const QRectF&                                   region,
+           ome::files::dimension_size_type                 plane,
+           const glm::vec3&                                min,
+           const glm::vec3&                                max,
+           std::shared_ptr<ome::files::VariantPixelBuffer> pixels = std::shared_ptr<ome::files::VariantPixelBuffer>());
+
+    private:
+      /// (Re)create the framebuffer for the current size.
+      void
+      createFramebuffer();
+
+      /// (Re)create the readback buffers for the current size.
+      void
+      createPixelBuffers();
+
+      /**
+       * Copy a frame from GL (bottom to top) to top to bottom row
+       * order.
+       *
+       * @param src the source frame.
+       * @param pixels the buffer to fill.
+       */
+      void
+      copyFrame(const uint8_t        *src,
+                std::vector<uint8_t>& pixels) const;
+
+      /// A frame in flight.
+      struct PendingFrame
+      {
+        /// Pixel buffer object receiving the frame.
+        GLuint pbo;
+        /// Fence signalled when the readback is complete.
+        GLsync fence;
+      };
+
+      /// The image reader.
+      std::shared_ptr<ome::files::FormatReader> reader;
+      /// The image series.
+      ome::files::dimension_size_type series;
+      /// Render target size.
+      QSize size;
+      /// Render axes?
+      bool axesVisible;
+      /// Render grid?
+      bool gridVisible;
+      /// Render overlay?
+      bool overlayVisible;
+      /// The LUT texture row to use.
+      int lutRow;
+      /// Offscreen surface.
+      QOffscreenSurface *surface;
+      /// OpenGL context.
+      QOpenGLContext *glcontext;
+      /// Framebuffer render target.
+      QOpenGLFramebufferObject *fbo;
+      /// Image to render.
+      gl::Image2D *image;
+      /// Axes to render.
+      gl::Axis2D *axes;
+      /// ROI overlay to render.
+      gl::Overlay2D *overlay;
+      /// Point localisations to render.
+      gl::PointCloud2D *pointcloud;
+      /// Grid to render.
+      gl::Grid2D *grid;
+      /// Readback pixel buffer objects.
+      std::vector<GLuint> pbos;
+      /// Next readback pixel buffer object to use.
+      std::size_t nextpbo;
+      /// Frames in flight, oldest first.
+      std::deque<PendingFrame> pending;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_OFFSCREENRENDERER2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
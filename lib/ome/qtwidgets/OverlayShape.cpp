@@ -0,0 +1,249 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <exception>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <ome/qtwidgets/OverlayShape.h>
+
+using ome::files::dimension_size_type;
+using ome::xml::meta::MetadataRetrieve;
+
+namespace
+{
+
+  /**
+   * Get an optional plane index.
+   *
+   * Unset optional metadata values throw when retrieved.
+   *
+   * @param getter the metadata getter.
+   * @param value the value to set.
+   * @returns @c true if the value was set, @c false if unset.
+   */
+  template<typename Getter>
+  bool
+  optional_index(Getter              getter,
+                 dimension_size_type& value)
+  {
+    try
+      {
+        value = static_cast<dimension_size_type>(getter());
+        return true;
+      }
+    catch (const std::exception&)
+      {
+        return false;
+      }
+  }
+
+  /**
+   * Get an optional stroke colour.
+   *
+   * @param getter the metadata getter.
+   * @param colour the colour to set; unchanged if unset.
+   */
+  template<typename Getter>
+  void
+  optional_colour(Getter     getter,
+                  glm::vec4& colour)
+  {
+    try
+      {
+        auto col = getter();
+        colour = glm::vec4(col.getRed(), col.getGreen(),
+                           col.getBlue(), col.getAlpha()) / 255.0f;
+      }
+    catch (const std::exception&)
+      {
+      }
+  }
+
+  /**
+   * Parse an OME points string ("x1,y1 x2,y2 ...").
+   *
+   * @param points the points string.
+   * @returns the parsed points.
+   */
+  std::vector<glm::vec2>
+  parse_points(std::string points)
+  {
+    std::replace(points.begin(), points.end(), ',', ' ');
+    std::istringstream is(points);
+
+    std::vector<glm::vec2> ret;
+    float x, y;
+    while (is >> x >> y)
+      ret.push_back(glm::vec2(x, y));
+    return ret;
+  }
+
+  /**
+   * Check if a shape applies to a plane.
+   *
+   * @param plane the plane index.
+   * @param set @c true if the shape has a plane index set.
+   * @param value the plane index of the shape.
+   * @returns @c true if the shape applies.
+   */
+  bool
+  applies(dimension_size_type plane,
+          bool                set,
+          dimension_size_type value)
+  {
+    return !set || plane == value;
+  }
+
+}
+
+// Retrieve plane indices and stroke colour for the specified shape
+// type.
+#define OME_QTWIDGETS_SHAPE_COMMON(Type)                                \
+  zset = optional_index([&]{ return meta.get##Type##TheZ(roi, shape); }, sz); \
+  cset = optional_index([&]{ return meta.get##Type##TheC(roi, shape); }, sc); \
+  tset = optional_index([&]{ return meta.get##Type##TheT(roi, shape); }, st); \
+  optional_colour([&]{ return meta.get##Type##StrokeColor(roi, shape); }, colour)
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    std::vector<OverlayShape>
+    overlayShapes(const MetadataRetrieve& meta,
+                  dimension_size_type     image,
+                  dimension_size_type     z,
+                  dimension_size_type     c,
+                  dimension_size_type     t)
+    {
+      std::vector<OverlayShape> shapes;
+
+      if (meta.getImageCount() <= image)
+        return shapes;
+
+      // ROIs linked to this image.
+      std::set<std::string> rois;
+      for (dimension_size_type ref = 0;
+           ref < meta.getImageROIRefCount(image);
+           ++ref)
+        rois.insert(meta.getImageROIRef(image, ref));
+
+      for (dimension_size_type roi = 0; roi < meta.getROICount(); ++roi)
+        {
+          if (rois.find(meta.getROIID(roi)) == rois.end())
+            continue;
+
+          for (dimension_size_type shape = 0;
+               shape < meta.getShapeCount(roi);
+               ++shape)
+            {
+              const std::string type(meta.getShapeType(roi, shape));
+
+              bool zset = false, cset = false, tset = false;
+              dimension_size_type sz = 0, sc = 0, st = 0;
+              glm::vec4 colour(1.0f, 1.0f, 0.0f, 1.0f);
+              OverlayShape::Type stype;
+              std::vector<glm::vec2> points;
+
+              if (type == "Point")
+                {
+                  OME_QTWIDGETS_SHAPE_COMMON(Point);
+                  stype = OverlayShape::POINT;
+                  points.push_back(glm::vec2(meta.getPointX(roi, shape),
+                                             meta.getPointY(roi, shape)));
+                }
+              else if (type == "Line")
+                {
+                  OME_QTWIDGETS_SHAPE_COMMON(Line);
+                  stype = OverlayShape::LINE;
+                  points.push_back(glm::vec2(meta.getLineX1(roi, shape),
+                                             meta.getLineY1(roi, shape)));
+                  points.push_back(glm::vec2(meta.getLineX2(roi, shape),
+                                             meta.getLineY2(roi, shape)));
+                }
+              else if (type == "Polyline")
+                {
+                  OME_QTWIDGETS_SHAPE_COMMON(Polyline);
+                  stype = OverlayShape::POLYLINE;
+                  points = parse_points(meta.getPolylinePoints(roi, shape));
+                }
+              else if (type == "Polygon")
+                {
+                  OME_QTWIDGETS_SHAPE_COMMON(Polygon);
+                  stype = OverlayShape::POLYGON;
+                  points = parse_points(meta.getPolygonPoints(roi, shape));
+                }
+              else if (type == "Rectangle")
+                {
+                  OME_QTWIDGETS_SHAPE_COMMON(Rectangle);
+                  stype = OverlayShape::RECTANGLE;
+                  points.push_back(glm::vec2(meta.getRectangleX(roi, shape),
+                                             meta.getRectangleY(roi, shape)));
+                  points.push_back(glm::vec2(meta.getRectangleWidth(roi, shape),
+                                             meta.getRectangleHeight(roi, shape)));
+                }
+              else if (type == "Ellipse")
+                {
+                  OME_QTWIDGETS_SHAPE_COMMON(Ellipse);
+                  stype = OverlayShape::ELLIPSE;
+                  points.push_back(glm::vec2(meta.getEllipseX(roi, shape),
+                                             meta.getEllipseY(roi, shape)));
+                  points.push_back(glm::vec2(meta.getEllipseRadiusX(roi, shape),
+                                             meta.getEllipseRadiusY(roi, shape)));
+                }
+              else
+                continue;
+
+              if (points.empty() ||
+                  !applies(z, zset, sz) ||
+                  !applies(c, cset, sc) ||
+                  !applies(t, tset, st))
+                continue;
+
+              shapes.push_back(OverlayShape(stype, points, colour));
+            }
+        }
+
+      return shapes;
+    }
+
+  }
+}
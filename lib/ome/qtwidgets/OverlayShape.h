@@ -0,0 +1,129 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_OVERLAYSHAPE_H
+#define OME_QTWIDGETS_OVERLAYSHAPE_H
+
+#include <vector>
+
+#include <ome/files/Types.h>
+
+#include <ome/xml/meta/MetadataRetrieve.h>
+
+#include <ome/qtwidgets/glm.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Overlay shape.
+     *
+     * A simplified representation of an OME ROI shape for display.
+     * Coordinates are in image pixel space (origin at the top left).
+     */
+    struct OverlayShape
+    {
+      /// Shape type.
+      enum Type
+        {
+          POINT,     ///< Point; one point.
+          LINE,      ///< Line; start and end points.
+          POLYLINE,  ///< Open polyline; any number of points.
+          POLYGON,   ///< Closed polygon; any number of points.
+          RECTANGLE, ///< Rectangle; top left corner and size.
+          ELLIPSE    ///< Ellipse; centre and radii.
+        };
+
+      /// The shape type.
+      Type type;
+      /// The shape points (interpretation depends upon the type).
+      std::vector<glm::vec2> points;
+      /// The stroke colour (RGBA).
+      glm::vec4 colour;
+
+      /**
+       * Constructor.
+       *
+       * @param type the shape type.
+       * @param points the shape points.
+       * @param colour the stroke colour.
+       */
+      OverlayShape(Type                          type,
+                   const std::vector<glm::vec2>& points,
+                   const glm::vec4&              colour = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f)):
+        type(type),
+        points(points),
+        colour(colour)
+      {}
+    };
+
+    /**
+     * Get the ROI shapes for a plane.
+     *
+     * All shapes of all ROIs linked to the specified image are
+     * returned if they apply to the specified plane.  A shape with
+     * no Z, C or T index set applies to all planes in that
+     * dimension.  Unsupported shape types (labels, masks) are
+     * skipped.
+     *
+     * @param meta the metadata to query.
+     * @param image the image index.
+     * @param z the Z index of the plane.
+     * @param c the C index of the plane.
+     * @param t the T index of the plane.
+     * @returns the shapes.
+     */
+    std::vector<OverlayShape>
+    overlayShapes(const ome::xml::meta::MetadataRetrieve& meta,
+                  ome::files::dimension_size_type         image,
+                  ome::files::dimension_size_type         z,
+                  ome::files::dimension_size_type         c,
+                  ome::files::dimension_size_type         t);
+
+  }
+}
+
+#endif // OME_QTWIDGETS_OVERLAYSHAPE_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,244 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include <ome/qtwidgets/MappedPlane.h>
+#include <ome/qtwidgets/PlaneLoader.h>
+#include <ome/qtwidgets/Trace.h>
+
+using ome::files::dimension_size_type;
+
+namespace
+{
+
+  // Weight of each new measurement in the mean decode time.
+  const double decode_weight = 0.25;
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    PlaneLoader::PlaneLoader(ReaderFactory                   factory,
+                             ome::files::dimension_size_type series,
+                             QObject                        *parent):
+      QObject(parent),
+      pool(std::make_shared<ReaderPool>(factory, 1)),
+      series(series),
+      mutex(),
+      condition(),
+      stopping(false),
+      queue(),
+      wanted(),
+      planes(),
+      decoding(),
+      decodeTime(0.0),
+      workers()
+    {
+      start(1);
+    }
+
+    PlaneLoader::PlaneLoader(std::shared_ptr<ReaderPool>     pool,
+                             ome::files::dimension_size_type series,
+                             unsigned int                    threads,
+                             QObject                        *parent):
+      QObject(parent),
+      pool(pool),
+      series(series),
+      mutex(),
+      condition(),
+      stopping(false),
+      queue(),
+      wanted(),
+      planes(),
+      decoding(),
+      decodeTime(0.0),
+      workers()
+    {
+      start(threads ? threads : static_cast<unsigned int>(pool->getMaxReaders()));
+    }
+
+    PlaneLoader::~PlaneLoader()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      condition.notify_all();
+      for (auto& worker : workers)
+        worker.join();
+    }
+
+    void
+    PlaneLoader::start(unsigned int threads)
+    {
+      for (unsigned int i = 0; i < threads; ++i)
+        workers.push_back(std::thread(&PlaneLoader::run, this));
+    }
+
+    void
+    PlaneLoader::request(const std::vector<ome::files::dimension_size_type>& planes)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        wanted.clear();
+        wanted.insert(planes.begin(), planes.end());
+
+        // Discard decoded planes which are no longer wanted.
+        for (auto i = this->planes.begin(); i != this->planes.end();)
+          {
+            if (wanted.find(i->first) == wanted.end())
+              i = this->planes.erase(i);
+            else
+              ++i;
+          }
+
+        queue.clear();
+        for (const auto& plane : planes)
+          if (this->planes.find(plane) == this->planes.end() &&
+              decoding.find(plane) == decoding.end())
+            queue.push_back(plane);
+      }
+      condition.notify_all();
+    }
+
+    std::shared_ptr<ome::files::VariantPixelBuffer>
+    PlaneLoader::find(ome::files::dimension_size_type plane) const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto i = planes.find(plane);
+      if (i != planes.end())
+        return i->second;
+      return std::shared_ptr<ome::files::VariantPixelBuffer>();
+    }
+
+    double
+    PlaneLoader::getDecodeTime() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return decodeTime / static_cast<double>(workers.size());
+    }
+
+    ome::files::dimension_size_type
+    PlaneLoader::getSeries() const
+    {
+      return series;
+    }
+
+    PlaneLoader::ReaderFactory
+    PlaneLoader::getReaderFactory() const
+    {
+      return pool->getReaderFactory();
+    }
+
+    std::shared_ptr<ReaderPool>
+    PlaneLoader::getReaderPool() const
+    {
+      return pool;
+    }
+
+    void
+    PlaneLoader::run()
+    {
+      setTraceThreadName("PlaneLoader");
+
+      while (true)
+        {
+          dimension_size_type plane;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if (stopping)
+              break;
+            plane = queue.front();
+            queue.pop_front();
+            decoding.insert(plane);
+          }
+
+          // Readers are leased per plane so that they may be shared
+          // with other users of the pool.
+          std::shared_ptr<ome::files::VariantPixelBuffer> buf;
+          double elapsed = 0.0;
+          {
+            ReaderPool::Lease reader(pool->acquire(series));
+            if (reader)
+              {
+                std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+                try
+                  {
+                    TraceScope trace("PlaneLoader::read", "read");
+                    buf = mapPlane(reader.get(), series, plane);
+                    if (!buf)
+                      {
+                        buf = std::make_shared<ome::files::VariantPixelBuffer>();
+                        reader->openBytes(plane, *buf);
+                      }
+                  }
+                catch (const std::exception& e)
+                  {
+                    std::cerr << "PlaneLoader: Failed to read plane " << plane << ": " << e.what() << std::endl;
+                    buf.reset();
+                  }
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+              }
+          }
+
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoding.erase(plane);
+            // Without a reader, requests can never be satisfied.
+            if (!buf)
+              continue;
+            decodeTime = decodeTime > 0.0 ? (decodeTime * (1.0 - decode_weight)) + (elapsed * decode_weight) : elapsed;
+            // The request may have changed while decoding.
+            if (wanted.find(plane) == wanted.end())
+              continue;
+            planes[plane] = buf;
+          }
+
+          emit planeLoaded(plane);
+        }
+    }
+
+  }
+}
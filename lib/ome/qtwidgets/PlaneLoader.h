@@ -0,0 +1,233 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_PLANELOADER_H
+#define OME_QTWIDGETS_PLANELOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+#include <ome/files/VariantPixelBuffer.h>
+
+#include <ome/qtwidgets/ReaderPool.h>
+
+#include <QtCore/QObject>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Background plane decoder for read-ahead.
+     *
+     * Planes are decoded in request order by background threads
+     * using readers from a ReaderPool, so that decoding never blocks
+     * the GUI thread.  Each request replaces the previous one:
+     * queued planes which are no longer wanted are not decoded, and
+     * decoded planes which are no longer wanted are discarded.  The
+     * mean decode time is measured so that the caller can size its
+     * read-ahead window.
+     *
+     * The planeLoaded() signal is emitted from the background
+     * threads; connections to objects in other threads are queued.
+     * With more than one thread, planes may complete out of order.
+     */
+    class PlaneLoader : public QObject
+    {
+      Q_OBJECT
+
+    public:
+      /// Reader factory.
+      typedef ReaderPool::ReaderFactory ReaderFactory;
+
+      /**
+       * Constructor.
+       *
+       * A single background thread is started immediately, using a
+       * private reader pool.
+       *
+       * @param factory the reader factory.
+       * @param series the image series.
+       * @param parent the parent of this object.
+       */
+      PlaneLoader(ReaderFactory                   factory,
+                  ome::files::dimension_size_type series,
+                  QObject                        *parent = 0);
+
+      /**
+       * Constructor.
+       *
+       * The background threads are started immediately.
+       *
+       * @param pool the reader pool.
+       * @param series the image series.
+       * @param threads the number of background threads, or zero to
+       * use the maximum reader count of the pool.
+       * @param parent the parent of this object.
+       */
+      PlaneLoader(std::shared_ptr<ReaderPool>     pool,
+                  ome::files::dimension_size_type series,
+                  unsigned int                    threads = 1,
+                  QObject                        *parent = 0);
+
+      /// Destructor.  Blocks until the background threads have stopped.
+      ~PlaneLoader();
+
+      /**
+       * Request planes.
+       *
+       * Replaces any previous request.  Planes are decoded in the
+       * specified order, skipping planes which are already decoded.
+       *
+       * @param planes the planes to decode.
+       */
+      void
+      request(const std::vector<ome::files::dimension_size_type>& planes);
+
+      /**
+       * Get a decoded plane.
+       *
+       * Does not block.
+       *
+       * @param plane the plane number.
+       * @returns the decoded plane, or null if not (yet) decoded.
+       */
+      std::shared_ptr<ome::files::VariantPixelBuffer>
+      find(ome::files::dimension_size_type plane) const;
+
+      /**
+       * Get the mean plane decode time.
+       *
+       * This is the mean interval between decoded planes, i.e. the
+       * mean time to decode a plane divided by the number of
+       * background threads.
+       *
+       * @returns the decode time (seconds), or zero if no planes
+       * have been decoded.
+       */
+      double
+      getDecodeTime() const;
+
+      /**
+       * Get the image series.
+       *
+       * @returns the series.
+       */
+      ome::files::dimension_size_type
+      getSeries() const;
+
+      /**
+       * Get the reader factory.
+       *
+       * @returns the reader factory.
+       */
+      ReaderFactory
+      getReaderFactory() const;
+
+      /**
+       * Get the reader pool.
+       *
+       * @returns the reader pool.
+       */
+      std::shared_ptr<ReaderPool>
+      getReaderPool() const;
+
+    signals:
+      /**
+       * Signal a plane has been decoded.
+       *
+       * @param plane the plane number.
+       */
+      void
+      planeLoaded(quint64 plane);
+
+    private:
+      /**
+       * Start the background threads.
+       *
+       * @param threads the number of threads.
+       */
+      void
+      start(unsigned int threads);
+
+      /// Decode planes (background thread).
+      void
+      run();
+
+      /// Reader pool.
+      std::shared_ptr<ReaderPool> pool;
+      /// Image series.
+      ome::files::dimension_size_type series;
+      /// Lock for request and decoded planes.
+      mutable std::mutex mutex;
+      /// Signalled on new requests and when stopping.
+      std::condition_variable condition;
+      /// Stop the background thread.
+      bool stopping;
+      /// Planes pending decoding, in order.
+      std::deque<ome::files::dimension_size_type> queue;
+      /// All requested planes.
+      std::set<ome::files::dimension_size_type> wanted;
+      /// Decoded planes.
+      std::map<ome::files::dimension_size_type, std::shared_ptr<ome::files::VariantPixelBuffer>> planes;
+      /// Planes being decoded.
+      std::set<ome::files::dimension_size_type> decoding;
+      /// Mean decode time (seconds).
+      double decodeTime;
+      /// Background threads.
+      std::vector<std::thread> workers;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_PLANELOADER_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,328 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_QUADTREE_H
+#define OME_QTWIDGETS_QUADTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <ome/qtwidgets/glm.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Static quadtree spatial index of axis-aligned bounding boxes.
+     *
+     * Boxes are specified as (xmin, ymin, xmax, ymax).  Each box is
+     * stored in the smallest node which fully contains it; a leaf
+     * node is split into quadrants once it holds more than a given
+     * number of boxes.  Queries return the indices of all boxes
+     * intersecting the query box, so the cost scales with the number
+     * of boxes near the query rather than the total number of boxes.
+     */
+    class QuadTree
+    {
+    public:
+      /// Box index type.
+      typedef std::size_t index_type;
+
+      /**
+       * Create an empty quadtree.
+       *
+       * @param maxItems the number of boxes a leaf node may hold
+       * before it is split.
+       * @param maxDepth the maximum depth of the tree.
+       */
+      explicit
+      QuadTree(std::size_t maxItems = 16,
+               unsigned int maxDepth = 16):
+        maxItems(maxItems),
+        maxDepth(maxDepth),
+        boxes(),
+        nodes()
+      {
+      }
+
+      /**
+       * Build the tree.
+       *
+       * Any existing content is replaced.
+       *
+       * @param boxes the boxes to index; box indices are positions
+       * in this vector.
+       */
+      void
+      build(const std::vector<glm::vec4>& boxes)
+      {
+        this->boxes = boxes;
+        nodes.clear();
+
+        if (boxes.empty())
+          return;
+
+        glm::vec4 bounds(boxes.front());
+        for (const auto& b : boxes)
+          {
+            bounds[0] = std::min(bounds[0], b[0]);
+            bounds[1] = std::min(bounds[1], b[1]);
+            bounds[2] = std::max(bounds[2], b[2]);
+            bounds[3] = std::max(bounds[3], b[3]);
+          }
+        nodes.push_back(Node(bounds, 0));
+
+        for (index_type i = 0; i < boxes.size(); ++i)
+          insert(i);
+      }
+
+      /**
+       * Find boxes intersecting a query box.
+       *
+       * @param box the query box.
+       * @param result the indices of the intersecting boxes are
+       * appended to this vector.
+       */
+      void
+      query(const glm::vec4&         box,
+            std::vector<index_type>& result) const
+      {
+        if (nodes.empty())
+          return;
+
+        std::vector<std::size_t> stack;
+        stack.push_back(0);
+        while (!stack.empty())
+          {
+            const Node& node(nodes[stack.back()]);
+            stack.pop_back();
+
+            if (!intersects(node.bounds, box))
+              continue;
+
+            for (const auto& i : node.items)
+              if (intersects(boxes[i], box))
+                result.push_back(i);
+
+            if (node.children)
+              for (std::size_t c = 0; c < 4; ++c)
+                stack.push_back(node.children + c);
+          }
+      }
+
+      /**
+       * Get the number of indexed boxes.
+       *
+       * @returns the box count.
+       */
+      std::size_t
+      size() const
+      {
+        return boxes.size();
+      }
+
+      /**
+       * Get an indexed box.
+       *
+       * @param i the box index.
+       * @returns the box.
+       */
+      const glm::vec4&
+      box(index_type i) const
+      {
+        return boxes[i];
+      }
+
+    private:
+      /// Tree node.
+      struct Node
+      {
+        /// Node bounds.
+        glm::vec4 bounds;
+        /// Node depth.
+        unsigned int depth;
+        /// Index of first of four children, or 0 if a leaf.
+        std::size_t children;
+        /// Boxes held by this node.
+        std::vector<index_type> items;
+
+        /**
+         * Constructor.
+         *
+         * @param bounds the node bounds.
+         * @param depth the node depth.
+         */
+        Node(const glm::vec4& bounds,
+             unsigned int     depth):
+          bounds(bounds),
+          depth(depth),
+          children(0),
+          items()
+        {}
+      };
+
+      /**
+       * Check if two boxes intersect.
+       *
+       * @param a the first box.
+       * @param b the second box.
+       * @returns @c true if the boxes intersect.
+       */
+      static bool
+      intersects(const glm::vec4& a,
+                 const glm::vec4& b)
+      {
+        return a[0] <= b[2] && b[0] <= a[2] &&
+          a[1] <= b[3] && b[1] <= a[3];
+      }
+
+      /**
+       * Check if a box is contained within another.
+       *
+       * @param outer the outer box.
+       * @param inner the inner box.
+       * @returns @c true if @p inner is within @p outer.
+       */
+      static bool
+      contains(const glm::vec4& outer,
+               const glm::vec4& inner)
+      {
+        return outer[0] <= inner[0] && inner[2] <= outer[2] &&
+          outer[1] <= inner[1] && inner[3] <= outer[3];
+      }
+
+      /**
+       * Find the child of a node fully containing a box.
+       *
+       * @param node the node index (must not be a leaf).
+       * @param box the box.
+       * @returns the child node index, or 0 if no child contains
+       * the box.
+       */
+      std::size_t
+      child(std::size_t      node,
+            const glm::vec4& box) const
+      {
+        for (std::size_t c = 0; c < 4; ++c)
+          {
+            std::size_t n = nodes[node].children + c;
+            if (contains(nodes[n].bounds, box))
+              return n;
+          }
+        return 0;
+      }
+
+      /**
+       * Insert a box.
+       *
+       * @param i the box index.
+       */
+      void
+      insert(index_type i)
+      {
+        std::size_t node = 0;
+        while (nodes[node].children)
+          {
+            std::size_t c = child(node, boxes[i]);
+            if (!c)
+              break;
+            node = c;
+          }
+
+        nodes[node].items.push_back(i);
+
+        if (!nodes[node].children &&
+            nodes[node].items.size() > maxItems &&
+            nodes[node].depth < maxDepth)
+          split(node);
+      }
+
+      /**
+       * Split a leaf node into quadrants.
+       *
+       * Boxes which fit within a quadrant are moved into it.
+       *
+       * @param node the node index.
+       */
+      void
+      split(std::size_t node)
+      {
+        const glm::vec4 b(nodes[node].bounds);
+        const unsigned int depth(nodes[node].depth + 1);
+        const float xmid = (b[0] + b[2]) * 0.5f;
+        const float ymid = (b[1] + b[3]) * 0.5f;
+
+        // Note nodes may be reallocated; do not hold references.
+        nodes[node].children = nodes.size();
+        nodes.push_back(Node(glm::vec4(b[0], b[1], xmid, ymid), depth));
+        nodes.push_back(Node(glm::vec4(xmid, b[1], b[2], ymid), depth));
+        nodes.push_back(Node(glm::vec4(b[0], ymid, xmid, b[3]), depth));
+        nodes.push_back(Node(glm::vec4(xmid, ymid, b[2], b[3]), depth));
+
+        std::vector<index_type> items;
+        items.swap(nodes[node].items);
+        for (const auto& i : items)
+          {
+            std::size_t c = child(node, boxes[i]);
+            nodes[c ? c : node].items.push_back(i);
+          }
+      }
+
+      /// Maximum number of boxes in a leaf before splitting.
+      std::size_t maxItems;
+      /// Maximum tree depth.
+      unsigned int maxDepth;
+      /// Indexed boxes.
+      std::vector<glm::vec4> boxes;
+      /// Tree nodes; the root is the first node.
+      std::vector<Node> nodes;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_QUADTREE_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
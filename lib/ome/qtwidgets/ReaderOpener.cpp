@@ -0,0 +1,159 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/ReaderOpener.h>
+#include <ome/qtwidgets/SeriesInfo.h>
+#include <ome/qtwidgets/Trace.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    ReaderOpener::ReaderOpener(ReaderFactory                   factory,
+                               ome::files::dimension_size_type series,
+                               QObject                        *parent):
+      QObject(parent),
+      factory(factory),
+      series(series),
+      cancelled(false),
+      worker(),
+      mutex(),
+      reader(),
+      error()
+    {
+    }
+
+    ReaderOpener::~ReaderOpener()
+    {
+      cancel();
+      if (worker.joinable())
+        worker.join();
+    }
+
+    void
+    ReaderOpener::start()
+    {
+      if (worker.joinable())
+        return;
+
+      worker = std::thread(&ReaderOpener::run, this);
+    }
+
+    void
+    ReaderOpener::cancel()
+    {
+      cancelled = true;
+    }
+
+    bool
+    ReaderOpener::isCancelled() const
+    {
+      return cancelled;
+    }
+
+    std::shared_ptr<ome::files::FormatReader>
+    ReaderOpener::getReader() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return reader;
+    }
+
+    ome::files::dimension_size_type
+    ReaderOpener::getSeries() const
+    {
+      return series;
+    }
+
+    QString
+    ReaderOpener::getError() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return error;
+    }
+
+    void
+    ReaderOpener::run()
+    {
+      setTraceThreadName("ReaderOpener");
+
+      std::shared_ptr<ome::files::FormatReader> opened;
+      QString failure;
+
+      try
+        {
+          {
+            TraceScope trace("ReaderOpener::open", "read");
+            opened = factory();
+          }
+          if (!opened)
+            failure = tr("No reader is available for the dataset");
+          else if (!cancelled)
+            {
+              // Build the snapshot used by the views here, rather
+              // than on first use in the GUI thread.
+              TraceScope trace("SeriesInfo::get", "read");
+              SeriesInfo::get(opened, series);
+            }
+        }
+      catch (const std::exception& e)
+        {
+          failure = QString::fromLocal8Bit(e.what());
+          opened.reset();
+        }
+
+      bool success = opened && !cancelled;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (success)
+          reader = opened;
+        if (!cancelled)
+          error = failure;
+      }
+
+      emit finished(success);
+    }
+
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
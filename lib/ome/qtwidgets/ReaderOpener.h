@@ -0,0 +1,189 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_READEROPENER_H
+#define OME_QTWIDGETS_READEROPENER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <ome/files/FormatReader.h>
+
+#include <ome/qtwidgets/ReaderPool.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Open a reader in the background.
+     *
+     * Initialising a reader parses all of the dataset metadata,
+     * which for large multi-file datasets may take a long time.  The
+     * reader is created by a factory on a worker thread, and the
+     * metadata snapshot of the initial series is built, so that a
+     * view of the series can be created immediately once finished()
+     * is emitted.
+     *
+     * Reader initialisation can not be interrupted.  Cancelling
+     * discards the reader once initialisation completes; the
+     * destructor cancels and waits for the worker thread to stop,
+     * so that the thread never outlives the opener.
+     *
+     * The finished() signal is emitted from the background thread;
+     * connections to objects in other threads are queued.
+     */
+    class ReaderOpener : public QObject
+    {
+      Q_OBJECT
+
+    public:
+      /// Reader factory.
+      typedef ReaderPool::ReaderFactory ReaderFactory;
+
+      /**
+       * Constructor.
+       *
+       * @param factory the reader factory.
+       * @param series the initial image series.
+       * @param parent the parent of this object.
+       */
+      ReaderOpener(ReaderFactory                   factory,
+                   ome::files::dimension_size_type series = 0,
+                   QObject                        *parent = 0);
+
+      /// Destructor.  Cancels opening and waits for the worker thread.
+      ~ReaderOpener();
+
+      /**
+       * Start opening the reader.
+       *
+       * Has no effect if already started.
+       */
+      void
+      start();
+
+      /**
+       * Cancel opening.
+       *
+       * Does not block; finished() is emitted with a failure status
+       * once the worker thread stops.
+       */
+      void
+      cancel();
+
+      /**
+       * Check if opening was cancelled.
+       *
+       * @returns @c true if cancelled.
+       */
+      bool
+      isCancelled() const;
+
+      /**
+       * Get the opened reader.
+       *
+       * @returns the reader, or null if not (successfully) opened.
+       */
+      std::shared_ptr<ome::files::FormatReader>
+      getReader() const;
+
+      /**
+       * Get the initial image series.
+       *
+       * @returns the series.
+       */
+      ome::files::dimension_size_type
+      getSeries() const;
+
+      /**
+       * Get the reason for failure.
+       *
+       * @returns the error message, or an empty string if opening
+       * succeeded or was cancelled.
+       */
+      QString
+      getError() const;
+
+    signals:
+      /**
+       * Signal completion.
+       *
+       * @param success @c true if the reader was opened, or @c false
+       * on failure or cancellation.
+       */
+      void
+      finished(bool success);
+
+    private:
+      /// Open the reader (worker thread).
+      void
+      run();
+
+      /// Reader factory.
+      ReaderFactory factory;
+      /// Initial image series.
+      ome::files::dimension_size_type series;
+      /// Opening cancelled.
+      std::atomic<bool> cancelled;
+      /// Worker thread.
+      std::thread worker;
+      /// Lock for the result.
+      mutable std::mutex mutex;
+      /// The opened reader (locked).
+      std::shared_ptr<ome::files::FormatReader> reader;
+      /// Failure reason (locked).
+      QString error;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_READEROPENER_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
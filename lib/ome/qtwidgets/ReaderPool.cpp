@@ -0,0 +1,236 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <iostream>
+
+#include <ome/qtwidgets/ReaderPool.h>
+
+namespace
+{
+
+  // Default maximum number of readers.
+  const std::size_t default_max_readers = 2;
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    ReaderPool::Lease::Lease():
+      pool(),
+      reader()
+    {
+    }
+
+    ReaderPool::Lease::Lease(std::shared_ptr<ReaderPool>                pool,
+                             std::shared_ptr<ome::files::FormatReader>  reader):
+      pool(pool),
+      reader(reader)
+    {
+    }
+
+    ReaderPool::Lease::Lease(Lease&& rhs):
+      pool(std::move(rhs.pool)),
+      reader(std::move(rhs.reader))
+    {
+    }
+
+    ReaderPool::Lease::~Lease()
+    {
+      release();
+    }
+
+    ReaderPool::Lease&
+    ReaderPool::Lease::operator= (Lease&& rhs)
+    {
+      if (this != &rhs)
+        {
+          release();
+          pool = std::move(rhs.pool);
+          reader = std::move(rhs.reader);
+        }
+      return *this;
+    }
+
+    const std::shared_ptr<ome::files::FormatReader>&
+    ReaderPool::Lease::get() const
+    {
+      return reader;
+    }
+
+    ome::files::FormatReader *
+    ReaderPool::Lease::operator-> () const
+    {
+      return reader.get();
+    }
+
+    ReaderPool::Lease::operator bool () const
+    {
+      return static_cast<bool>(reader);
+    }
+
+    void
+    ReaderPool::Lease::release()
+    {
+      if (pool && reader)
+        pool->release(reader);
+      pool.reset();
+      reader.reset();
+    }
+
+    ReaderPool::ReaderPool(ReaderFactory factory,
+                           std::size_t   maxReaders):
+      factory(factory),
+      maxReaders(maxReaders ? maxReaders : default_max_readers),
+      mutex(),
+      condition(),
+      idle(),
+      created(0)
+    {
+    }
+
+    ReaderPool::~ReaderPool()
+    {
+    }
+
+    ReaderPool::Lease
+    ReaderPool::acquire(ome::files::dimension_size_type series)
+    {
+      std::shared_ptr<ome::files::FormatReader> reader;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]{ return !idle.empty() || created < maxReaders; });
+        if (!idle.empty())
+          {
+            reader = idle.back();
+            idle.pop_back();
+          }
+        else
+          ++created;
+      }
+
+      try
+        {
+          // Create outside the lock; parsing the metadata may be slow.
+          if (!reader && factory)
+            reader = factory();
+          if (reader)
+            reader->setSeries(series);
+        }
+      catch (const std::exception& e)
+        {
+          std::cerr << "ReaderPool: Failed to create reader: " << e.what() << std::endl;
+          reader.reset();
+        }
+
+      if (!reader)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            --created;
+          }
+          condition.notify_one();
+          return Lease();
+        }
+
+      return Lease(shared_from_this(), reader);
+    }
+
+    ReaderPool::Lease
+    ReaderPool::tryAcquire(ome::files::dimension_size_type series)
+    {
+      std::shared_ptr<ome::files::FormatReader> reader;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.empty())
+          return Lease();
+        reader = idle.back();
+        idle.pop_back();
+      }
+
+      try
+        {
+          reader->setSeries(series);
+        }
+      catch (const std::exception& e)
+        {
+          std::cerr << "ReaderPool: Failed to set series: " << e.what() << std::endl;
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            --created;
+          }
+          condition.notify_one();
+          return Lease();
+        }
+
+      return Lease(shared_from_this(), reader);
+    }
+
+    ReaderPool::ReaderFactory
+    ReaderPool::getReaderFactory() const
+    {
+      return factory;
+    }
+
+    std::size_t
+    ReaderPool::getMaxReaders() const
+    {
+      return maxReaders;
+    }
+
+    std::size_t
+    ReaderPool::getReaderCount() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return created;
+    }
+
+    void
+    ReaderPool::release(std::shared_ptr<ome::files::FormatReader> reader)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(reader);
+      }
+      condition.notify_one();
+    }
+
+  }
+}
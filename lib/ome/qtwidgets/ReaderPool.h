@@ -0,0 +1,269 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_READERPOOL_H
+#define OME_QTWIDGETS_READERPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Pool of readers for a single dataset.
+     *
+     * A FormatReader holds the current series and file state, so a
+     * single reader may not be used by more than one thread at once.
+     * The pool hands out readers for exclusive use by one thread at
+     * a time, so that planes may be decoded concurrently without
+     * switching the series of a shared reader.
+     *
+     * Readers are created on demand with a factory, up to a maximum
+     * count, and are returned to the pool when released for reuse,
+     * so that the cost of parsing the dataset metadata is paid once
+     * per reader rather than once per task.
+     *
+     * The series of a pooled reader is set when it is acquired.
+     *
+     * The pool must be managed by a std::shared_ptr; leases keep
+     * the pool alive until released.
+     */
+    class ReaderPool : public std::enable_shared_from_this<ReaderPool>
+    {
+    public:
+      /**
+       * Reader factory.
+       *
+       * Must return a new reader with the dataset already set, or
+       * null on failure.  It may be called from any thread.
+       */
+      typedef std::function<std::shared_ptr<ome::files::FormatReader>()> ReaderFactory;
+
+      /**
+       * Exclusive use of a pooled reader.
+       *
+       * The reader is returned to the pool when the lease is
+       * destroyed or released.  Leases are movable but not
+       * copyable.
+       */
+      class Lease
+      {
+      public:
+        /// Construct an empty lease.
+        Lease();
+
+        /**
+         * Move constructor.
+         *
+         * @param rhs the lease to move from.
+         */
+        Lease(Lease&& rhs);
+
+        /// Destructor.  The reader is returned to the pool.
+        ~Lease();
+
+        /**
+         * Move assignment.
+         *
+         * Any reader currently held is returned to the pool.
+         *
+         * @param rhs the lease to move from.
+         * @returns this lease.
+         */
+        Lease&
+        operator= (Lease&& rhs);
+
+        /**
+         * Get the reader.
+         *
+         * @returns the reader, or null if the lease is empty.
+         */
+        const std::shared_ptr<ome::files::FormatReader>&
+        get() const;
+
+        /**
+         * Access the reader.
+         *
+         * @returns the reader.
+         */
+        ome::files::FormatReader *
+        operator-> () const;
+
+        /**
+         * Check if a reader is held.
+         *
+         * @returns @c true if a reader is held, @c false otherwise.
+         */
+        explicit
+        operator bool () const;
+
+        /// Return the reader to the pool early.
+        void
+        release();
+
+      private:
+        friend class ReaderPool;
+
+        /**
+         * Constructor.
+         *
+         * @param pool the pool owning the reader.
+         * @param reader the reader.
+         */
+        Lease(std::shared_ptr<ReaderPool>                pool,
+              std::shared_ptr<ome::files::FormatReader>  reader);
+
+        Lease(const Lease&) = delete;
+
+        Lease&
+        operator= (const Lease&) = delete;
+
+        /// The pool owning the reader.
+        std::shared_ptr<ReaderPool> pool;
+        /// The reader.
+        std::shared_ptr<ome::files::FormatReader> reader;
+      };
+
+      /**
+       * Constructor.
+       *
+       * @param factory the reader factory.
+       * @param maxReaders the maximum number of readers, or zero to
+       * use the default of two.  Each reader holds its own file
+       * handles and metadata, so the default is kept small.
+       */
+      explicit
+      ReaderPool(ReaderFactory factory,
+                 std::size_t   maxReaders = 0);
+
+      /// Destructor.
+      ~ReaderPool();
+
+      /**
+       * Acquire a reader.
+       *
+       * An idle reader is reused if available, otherwise a new
+       * reader is created if the maximum count has not been reached.
+       * Otherwise, blocks until a reader is released.
+       *
+       * @param series the image series to set.
+       * @returns a lease on the reader, which is empty if a reader
+       * could not be created.
+       */
+      Lease
+      acquire(ome::files::dimension_size_type series);
+
+      /**
+       * Acquire an idle reader without blocking.
+       *
+       * Only an idle reader is used; no reader is created, since
+       * creating a reader parses the dataset metadata.  This is
+       * suitable for use on the GUI thread.
+       *
+       * @param series the image series to set.
+       * @returns a lease on the reader, which is empty if no reader
+       * is idle.
+       */
+      Lease
+      tryAcquire(ome::files::dimension_size_type series);
+
+      /**
+       * Get the reader factory.
+       *
+       * @returns the reader factory.
+       */
+      ReaderFactory
+      getReaderFactory() const;
+
+      /**
+       * Get the maximum number of readers.
+       *
+       * @returns the maximum number of readers.
+       */
+      std::size_t
+      getMaxReaders() const;
+
+      /**
+       * Get the number of readers created.
+       *
+       * @returns the number of readers.
+       */
+      std::size_t
+      getReaderCount() const;
+
+    private:
+      /**
+       * Return a reader to the pool.
+       *
+       * @param reader the reader to return.
+       */
+      void
+      release(std::shared_ptr<ome::files::FormatReader> reader);
+
+      /// Reader factory.
+      ReaderFactory factory;
+      /// Maximum number of readers.
+      std::size_t maxReaders;
+      /// Lock for the idle readers and reader count.
+      mutable std::mutex mutex;
+      /// Signalled when a reader is released.
+      std::condition_variable condition;
+      /// Readers available for reuse.
+      std::vector<std::shared_ptr<ome::files::FormatReader>> idle;
+      /// Number of readers created (idle and leased).
+      std::size_t created;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_READERPOOL_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,153 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <ome/qtwidgets/SeriesInfo.h>
+
+using ome::files::dimension_size_type;
+
+namespace
+{
+
+  typedef std::pair<const ome::files::FormatReader *, dimension_size_type> cache_key;
+
+  struct cache_entry
+  {
+    std::weak_ptr<ome::files::FormatReader> reader;
+    std::shared_ptr<const ome::qtwidgets::SeriesInfo> info;
+  };
+
+  std::mutex cache_mutex;
+  std::map<cache_key, cache_entry> cache;
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    SeriesInfo::SeriesInfo(const ome::files::FormatReader&  reader,
+                           ome::files::dimension_size_type  series):
+      series(series),
+      sizeX(reader.getSizeX()),
+      sizeY(reader.getSizeY()),
+      sizeZ(reader.getSizeZ()),
+      sizeT(reader.getSizeT()),
+      sizeC(reader.getSizeC()),
+      effectiveSizeC(reader.getEffectiveSizeC()),
+      samples(reader.getRGBChannelCount(0)),
+      imageCount(reader.getImageCount()),
+      pixelType(reader.getPixelType()),
+      bitsPerPixel(reader.getBitsPerPixel()),
+      moduloZ(reader.getModuloZ().size()),
+      moduloT(reader.getModuloT().size()),
+      moduloC(reader.getModuloC().size()),
+      dimensionOrder(reader.getDimensionOrder()),
+      strides(),
+      zct()
+    {
+      // Strides follow the order of the non-spatial dimensions,
+      // e.g. Z, C then T for XYZCT.
+      dimension_size_type stride = 1;
+      for (std::string::size_type i = 2; i < dimensionOrder.size(); ++i)
+        {
+          switch (dimensionOrder[i])
+            {
+            case 'Z':
+              strides[0] = stride;
+              stride *= sizeZ;
+              break;
+            case 'C':
+              strides[1] = stride;
+              stride *= effectiveSizeC;
+              break;
+            case 'T':
+              strides[2] = stride;
+              stride *= sizeT;
+              break;
+            default:
+              break;
+            }
+        }
+
+      zct.reserve(imageCount);
+      for (dimension_size_type p = 0; p < imageCount; ++p)
+        zct.push_back(reader.getZCTCoords(p));
+    }
+
+    std::shared_ptr<const SeriesInfo>
+    SeriesInfo::get(const std::shared_ptr<ome::files::FormatReader>& reader,
+                    ome::files::dimension_size_type                  series)
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+
+      // Drop entries for destroyed readers; their addresses may be
+      // reused.
+      for (auto i = cache.begin(); i != cache.end();)
+        {
+          if (i->second.reader.expired())
+            i = cache.erase(i);
+          else
+            ++i;
+        }
+
+      cache_key key(reader.get(), series);
+      auto found = cache.find(key);
+      if (found != cache.end())
+        return found->second.info;
+
+      const ome::files::dimension_size_type oldseries = reader->getSeries();
+      if (oldseries != series)
+        reader->setSeries(series);
+      std::shared_ptr<const SeriesInfo> info(std::make_shared<SeriesInfo>(*reader, series));
+      if (oldseries != series)
+        reader->setSeries(oldseries);
+
+      cache_entry entry;
+      entry.reader = reader;
+      entry.info = info;
+      cache.insert(std::make_pair(key, entry));
+      return info;
+    }
+
+  }
+}
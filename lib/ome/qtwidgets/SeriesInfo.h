@@ -0,0 +1,173 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_SERIESINFO_H
+#define OME_QTWIDGETS_SERIESINFO_H
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Immutable metadata snapshot of a series.
+     *
+     * Querying a FormatReader requires switching the current series
+     * and making virtual calls, and is not thread-safe.  A snapshot
+     * is built once per reader and series, and is shared by all
+     * widgets, so that per-frame code only reads plain data.  The
+     * plane index to ZCT mapping is precomputed in both directions.
+     *
+     * Snapshots are obtained with get(); they may be used from any
+     * thread.
+     */
+    struct SeriesInfo
+    {
+      /// Plane coordinates (Z, C and T).
+      typedef std::array<ome::files::dimension_size_type, 3> Coords;
+
+      /**
+       * Constructor.
+       *
+       * The reader must have the series set as the current series.
+       *
+       * @param reader the image reader.
+       * @param series the image series.
+       */
+      SeriesInfo(const ome::files::FormatReader&  reader,
+                 ome::files::dimension_size_type  series);
+
+      /**
+       * Get the snapshot for a reader and series.
+       *
+       * The snapshot is built on first use, and cached for the
+       * lifetime of the reader.  The current series of the reader
+       * is switched while building the snapshot, and restored
+       * afterwards; the reader must not be in use by another thread.
+       *
+       * @param reader the image reader.
+       * @param series the image series.
+       * @returns the snapshot.
+       */
+      static std::shared_ptr<const SeriesInfo>
+      get(const std::shared_ptr<ome::files::FormatReader>& reader,
+          ome::files::dimension_size_type                  series);
+
+      /**
+       * Get the ZCT coordinates of a plane.
+       *
+       * @param plane the plane index.
+       * @returns the Z, C and T coordinates.
+       */
+      const Coords&
+      getZCTCoords(ome::files::dimension_size_type plane) const
+      {
+        return zct.at(plane);
+      }
+
+      /**
+       * Get the plane index of ZCT coordinates.
+       *
+       * @param z the Z coordinate.
+       * @param c the (effective) C coordinate.
+       * @param t the T coordinate.
+       * @returns the plane index.
+       */
+      ome::files::dimension_size_type
+      getIndex(ome::files::dimension_size_type z,
+               ome::files::dimension_size_type c,
+               ome::files::dimension_size_type t) const
+      {
+        return (z * strides[0]) + (c * strides[1]) + (t * strides[2]);
+      }
+
+      /// Image series.
+      const ome::files::dimension_size_type series;
+      /// Image width.
+      const ome::files::dimension_size_type sizeX;
+      /// Image height.
+      const ome::files::dimension_size_type sizeY;
+      /// Z size, including any Modulo annotation.
+      const ome::files::dimension_size_type sizeZ;
+      /// T size, including any Modulo annotation.
+      const ome::files::dimension_size_type sizeT;
+      /// C size, including samples and any Modulo annotation.
+      const ome::files::dimension_size_type sizeC;
+      /// Effective C size (excluding samples).
+      const ome::files::dimension_size_type effectiveSizeC;
+      /// Samples per pixel (of the first channel).
+      const ome::files::dimension_size_type samples;
+      /// Number of planes.
+      const ome::files::dimension_size_type imageCount;
+      /// Pixel type.
+      const ome::xml::model::enums::PixelType pixelType;
+      /// Significant bits per pixel.
+      const ome::files::pixel_size_type bitsPerPixel;
+      /// Modulo Z size.
+      const ome::files::dimension_size_type moduloZ;
+      /// Modulo T size.
+      const ome::files::dimension_size_type moduloT;
+      /// Modulo C size.
+      const ome::files::dimension_size_type moduloC;
+      /// Dimension order.
+      const std::string dimensionOrder;
+
+    private:
+      /// Plane index strides for Z, C and T.
+      Coords strides;
+      /// ZCT coordinates by plane index.
+      std::vector<Coords> zct;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_SERIESINFO_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -37,6 +37,8 @@
 
 #include <ome/qtwidgets/TexelProperties.h>
 
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 // Required with Boost 1.53 after variant include.
@@ -213,6 +215,63 @@ namespace ome
 
 #undef MAGNIFICATION_CASE
 
+#define SAMPLER_CASE(maR, maProperty, maType)                           \
+        case ::ome::xml::model::enums::PixelType::maType:               \
+          sampler = TexelProperties<::ome::xml::model::enums::PixelType::maType>::sampler; \
+          break;
+
+    TexelSampler
+    textureSampler(::ome::xml::model::enums::PixelType pixeltype)
+    {
+      TexelSampler sampler = FLOAT_SAMPLER;
+
+      switch(pixeltype)
+        {
+          BOOST_PP_SEQ_FOR_EACH(SAMPLER_CASE, size, OME_XML_MODEL_ENUMS_PIXELTYPE_VALUES);
+        }
+
+      return sampler;
+    }
+
+#undef SAMPLER_CASE
+
+    double
+    textureValueRange(::ome::xml::model::enums::PixelType pixeltype)
+    {
+      double range = 1.0;
+
+      switch(pixeltype)
+        {
+        case ::ome::xml::model::enums::PixelType::INT8:
+          range = std::numeric_limits<int8_t>::max();
+          break;
+        case ::ome::xml::model::enums::PixelType::INT16:
+          range = std::numeric_limits<int16_t>::max();
+          break;
+        case ::ome::xml::model::enums::PixelType::INT32:
+          range = std::numeric_limits<int32_t>::max();
+          break;
+        case ::ome::xml::model::enums::PixelType::UINT8:
+          range = std::numeric_limits<uint8_t>::max();
+          break;
+        case ::ome::xml::model::enums::PixelType::UINT16:
+          range = std::numeric_limits<uint16_t>::max();
+          break;
+        case ::ome::xml::model::enums::PixelType::UINT32:
+          range = std::numeric_limits<uint32_t>::max();
+          break;
+        case ::ome::xml::model::enums::PixelType::BIT:
+        case ::ome::xml::model::enums::PixelType::FLOAT:
+        case ::ome::xml::model::enums::PixelType::DOUBLE:
+        case ::ome::xml::model::enums::PixelType::COMPLEXFLOAT:
+        case ::ome::xml::model::enums::PixelType::COMPLEXDOUBLE:
+          range = 1.0;
+          break;
+        }
+
+      return range;
+    }
+
 #ifdef __GNUC__
 #  pragma GCC diagnostic pop
 #endif
@@ -234,6 +293,30 @@ namespace ome
         case GL_R16:
           ret = GL_R8;
           break;
+        case GL_R16_SNORM:
+          ret = GL_R8_SNORM;
+          break;
+        case GL_R8_SNORM:
+          // No smaller signed format.
+          ret = format;
+          break;
+        case GL_R32UI:
+          ret = GL_R16UI;
+          break;
+        case GL_R16UI:
+          ret = GL_R8UI;
+          break;
+        case GL_R32I:
+          ret = GL_R16I;
+          break;
+        case GL_R16I:
+          ret = GL_R8I;
+          break;
+        case GL_R8UI:
+        case GL_R8I:
+          // No smaller integer format.
+          ret = format;
+          break;
 
           // RG
         case GL_RG32F:
@@ -49,6 +49,16 @@ namespace ome
   namespace qtwidgets
   {
 
+    /**
+     * GLSL sampler type used to access a texture.
+     */
+    enum TexelSampler
+      {
+        FLOAT_SAMPLER,    ///< Floating point or normalized (@c sampler2D).
+        UNSIGNED_SAMPLER, ///< Unsigned integer (@c usampler2D).
+        SIGNED_SAMPLER    ///< Signed integer (@c isampler2D).
+      };
+
     /**
      * Map a given PixelType enum to the corresponding GL texel
      * definitions.  This is an extension of PixelProperties for GL
@@ -78,8 +88,16 @@ namespace ome
      * shader.
      *
      * Minification and magnification filters are also hints.  These
-     * default to a high filtering quality for all types except BIT,
-     * where the mask is clamped to the nearest pixel.
+     * default to a high filtering quality, with mipmaps, for
+     * normalized and floating point types.  8- and 16-bit integer
+     * types are stored in normalized textures, which represent them
+     * exactly.  32-bit integer types and BIT are stored unnormalized
+     * in integer textures to avoid precision loss; these are sampled
+     * with nearest filtering and have no mipmaps.
+     *
+     * The sampler type selects the fragment shader variant used to
+     * render the texture; integer textures are sampled raw and
+     * windowed exactly in the shader.
      */
     template<int>
     struct TexelProperties;
@@ -89,8 +107,8 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::INT8> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::INT8>
     {
-      /// Internal pixel format (single 8-bit channel).
-      static const GLenum internal_format = GL_R8;
+      /// Internal pixel format (single 8-bit signed normalized channel).
+      static const GLenum internal_format = GL_R8_SNORM;
       /// External pixel format (single channel).
       static const GLenum external_format = GL_RED;
       /// External pixel format fallback.
@@ -105,6 +123,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of INT16 texels.
@@ -112,8 +132,8 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::INT16> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::INT16>
     {
-      /// Internal pixel format (single 16-bit channel).
-      static const GLenum internal_format = GL_R16;
+      /// Internal pixel format (single 16-bit signed normalized channel).
+      static const GLenum internal_format = GL_R16_SNORM;
       /// External pixel format (single channel).
       static const GLenum external_format = GL_RED;
       /// External pixel type (@c int16_t).
@@ -128,6 +148,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of INT32 texels.
@@ -135,22 +157,24 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::INT32> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::INT32>
     {
-      /// Internal pixel format (single 16-bit channel; note precision loss).
-      static const GLenum internal_format = GL_R16;
-      /// External pixel format (single channel).
-      static const GLenum external_format = GL_RED;
+      /// Internal pixel format (single 32-bit signed integer channel).
+      static const GLenum internal_format = GL_R32I;
+      /// External pixel format (single integer channel).
+      static const GLenum external_format = GL_RED_INTEGER;
       /// External pixel type (@c int32_t).
       static const GLint external_type = GL_INT;
       /// External pixel format fallback.
       static const ::ome::xml::model::enums::PixelType::enum_value fallback_pixeltype = ome::xml::model::enums::PixelType::INT16;
       /// OME-Files type matches the GL type exactly.
       static const bool conversion_required = false;
-      /// Pixel values are automatically normalized by GL.
-      static const bool normalization_required = false;
-      /// Default minification filter.
-      static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
-      /// Default magnification filter.
-      static const GLint magnification_filter = GL_LINEAR;
+      /// Pixel values are not normalized by GL; windowed in the fragment shader.
+      static const bool normalization_required = true;
+      /// Default minification filter (integer textures are not filterable).
+      static const GLint minification_filter = GL_NEAREST;
+      /// Default magnification filter (integer textures are not filterable).
+      static const GLint magnification_filter = GL_NEAREST;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = SIGNED_SAMPLER;
     };
 
     /// Properties of UINT8 texels.
@@ -158,7 +182,7 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::UINT8> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::UINT8>
     {
-      /// Internal pixel format (single 8-bit channel).
+      /// Internal pixel format (single 8-bit normalized channel).
       static const GLenum internal_format = GL_R8;
       /// External pixel format (single channel).
       static const GLenum external_format = GL_RED;
@@ -174,6 +198,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of UINT16 texels.
@@ -181,7 +207,7 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::UINT16> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::UINT16>
     {
-      /// Internal pixel format (single 16-bit channel).
+      /// Internal pixel format (single 16-bit normalized channel).
       static const GLenum internal_format = GL_R16;
       /// External pixel format (single channel).
       static const GLenum external_format = GL_RED;
@@ -197,6 +223,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of UINT32 texels.
@@ -204,22 +232,24 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::UINT32> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::UINT32>
     {
-      /// Internal pixel format (single 16-bit channel; note precision loss).
-      static const GLenum internal_format = GL_R16;
-      /// External pixel format (single channel).
-      static const GLenum external_format = GL_RED;
+      /// Internal pixel format (single 32-bit unsigned integer channel).
+      static const GLenum internal_format = GL_R32UI;
+      /// External pixel format (single integer channel).
+      static const GLenum external_format = GL_RED_INTEGER;
       /// External pixel type (@c uint32_t).
       static const GLint external_type = GL_UNSIGNED_INT;
       /// External pixel format fallback.
       static const ::ome::xml::model::enums::PixelType::enum_value fallback_pixeltype = ome::xml::model::enums::PixelType::UINT16;
       /// OME-Files type matches the GL type exactly.
       static const bool conversion_required = false;
-      /// Pixel values are automatically normalized by GL.
-      static const bool normalization_required = false;
-      /// Default minification filter.
-      static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
-      /// Default magnification filter.
-      static const GLint magnification_filter = GL_LINEAR;
+      /// Pixel values are not normalized by GL; windowed in the fragment shader.
+      static const bool normalization_required = true;
+      /// Default minification filter (integer textures are not filterable).
+      static const GLint minification_filter = GL_NEAREST;
+      /// Default magnification filter (integer textures are not filterable).
+      static const GLint magnification_filter = GL_NEAREST;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = UNSIGNED_SAMPLER;
     };
 
     /// Properties of FLOAT texels.
@@ -243,6 +273,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of DOUBLE texels.
@@ -266,6 +298,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of BIT texels.
@@ -273,22 +307,24 @@ namespace ome
     struct TexelProperties<::ome::xml::model::enums::PixelType::BIT> :
       public ome::files::PixelProperties<::ome::xml::model::enums::PixelType::BIT>
     {
-      /// Internal pixel format (single 8-bit float channel).
-      static const GLenum internal_format = GL_R8;
-      /// External pixel format (single channel).
-      static const GLenum external_format = GL_RED;
+      /// Internal pixel format (single 8-bit unsigned integer channel).
+      static const GLenum internal_format = GL_R8UI;
+      /// External pixel format (single integer channel).
+      static const GLenum external_format = GL_RED_INTEGER;
       /// External pixel type (@c uint8_t).
       static const GLint external_type = GL_UNSIGNED_BYTE;
       /// External pixel format fallback.
       static const ::ome::xml::model::enums::PixelType::enum_value fallback_pixeltype = ome::xml::model::enums::PixelType::BIT;
-      /// OME-Files type does not match the GL type; convert to 0 or 255 for 0 and 1, respectively.
-      static const bool conversion_required = true;
-      /// Pixel values are automatically normalized by GL.
-      static const bool normalization_required = false;
-      /// Default minification filter.
-      static const GLint minification_filter = GL_NEAREST_MIPMAP_LINEAR;
-      /// Default magnification filter.
+      /// OME-Files type matches the GL type (0 or 1 stored as @c uint8_t).
+      static const bool conversion_required = false;
+      /// Pixel values are not normalized by GL; windowed in the fragment shader.
+      static const bool normalization_required = true;
+      /// Default minification filter (integer textures are not filterable).
+      static const GLint minification_filter = GL_NEAREST;
+      /// Default magnification filter (integer textures are not filterable).
       static const GLint magnification_filter = GL_NEAREST;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = UNSIGNED_SAMPLER;
     };
 
     /// Properties of COMPLEX texels.
@@ -312,6 +348,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /// Properties of DOUBLECOMPLEX texels.
@@ -335,6 +373,8 @@ namespace ome
       static const GLint minification_filter = GL_LINEAR_MIPMAP_LINEAR;
       /// Default magnification filter.
       static const GLint magnification_filter = GL_LINEAR;
+      /// GLSL sampler type.
+      static const TexelSampler sampler = FLOAT_SAMPLER;
     };
 
     /**
@@ -439,6 +479,28 @@ namespace ome
     GLint
     textureMagnificationFilter(::ome::xml::model::enums::PixelType pixeltype);
 
+    /**
+     * Get the GLSL sampler type.
+     *
+     * @param pixeltype the PixelType to query.
+     * @returns the sampler type.
+     */
+    TexelSampler
+    textureSampler(::ome::xml::model::enums::PixelType pixeltype);
+
+    /**
+     * Get the sample value corresponding to a normalized contrast
+     * limit of 1.
+     *
+     * For integer types this is the maximum value of the type; for
+     * floating point types, which are not normalized, it is 1.
+     *
+     * @param pixeltype the PixelType to query.
+     * @returns the sample value range.
+     */
+    double
+    textureValueRange(::ome::xml::model::enums::PixelType pixeltype);
+
   }
 }
 
@@ -0,0 +1,209 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ome/files/PixelBuffer.h>
+
+#include <ome/qtwidgets/Histogram.h>
+#include <ome/qtwidgets/Thumbnail.h>
+
+using ome::files::PixelBufferBase;
+using ome::qtwidgets::LUT8;
+using ome::qtwidgets::sample_value;
+
+namespace
+{
+
+  /*
+   * Reduce a VariantPixelBuffer to a thumbnail image.
+   *
+   * The buffer may only contain a single xy plane; up to three
+   * subchannels are used.
+   */
+  struct ThumbnailVisitor
+  {
+    QSize size;
+    const LUT8& lut;
+    QImage image;
+
+    ThumbnailVisitor(const QSize& size,
+                     const LUT8&  lut):
+      size(size),
+      lut(lut),
+      image()
+    {}
+
+    template<typename T>
+    void
+    operator() (const T& v)
+    {
+      typedef typename T::element_type::value_type value_type;
+
+      const PixelBufferBase::size_type *shape = v->shape();
+      const boost::multi_array_types::index *strides = v->array().strides();
+      const value_type *origin = v->array().origin();
+
+      const std::size_t sx = shape[ome::files::DIM_SPATIAL_X];
+      const std::size_t sy = shape[ome::files::DIM_SPATIAL_Y];
+      const std::size_t ns = std::min<std::size_t>(shape[ome::files::DIM_SUBCHANNEL], 3U);
+      const boost::multi_array_types::index xs = strides[ome::files::DIM_SPATIAL_X];
+      const boost::multi_array_types::index ys = strides[ome::files::DIM_SPATIAL_Y];
+      const boost::multi_array_types::index ss = strides[ome::files::DIM_SUBCHANNEL];
+
+      if (!sx || !sy || !ns)
+        return;
+
+      double scale = std::min(1.0, std::min(static_cast<double>(size.width()) / static_cast<double>(sx),
+                                            static_cast<double>(size.height()) / static_cast<double>(sy)));
+      const std::size_t ow = std::max<std::size_t>(1U, static_cast<std::size_t>(std::floor((static_cast<double>(sx) * scale) + 0.5)));
+      const std::size_t oh = std::max<std::size_t>(1U, static_cast<std::size_t>(std::floor((static_cast<double>(sy) * scale) + 0.5)));
+
+      // Box filter into per-sample means.
+      std::vector<double> means(ow * oh * ns);
+      std::vector<double> smin(ns, std::numeric_limits<double>::max());
+      std::vector<double> smax(ns, -std::numeric_limits<double>::max());
+
+      for (std::size_t oy = 0; oy < oh; ++oy)
+        {
+          const std::size_t y0 = (oy * sy) / oh;
+          const std::size_t y1 = std::max(y0 + 1, ((oy + 1) * sy) / oh);
+          for (std::size_t ox = 0; ox < ow; ++ox)
+            {
+              const std::size_t x0 = (ox * sx) / ow;
+              const std::size_t x1 = std::max(x0 + 1, ((ox + 1) * sx) / ow);
+              const double count = static_cast<double>((y1 - y0) * (x1 - x0));
+              for (std::size_t s = 0; s < ns; ++s)
+                {
+                  double sum = 0.0;
+                  for (std::size_t y = y0; y < y1; ++y)
+                    {
+                      const value_type *row = origin + (static_cast<boost::multi_array_types::index>(y) * ys) + (static_cast<boost::multi_array_types::index>(s) * ss);
+                      for (std::size_t x = x0; x < x1; ++x)
+                        sum += sample_value(row[static_cast<boost::multi_array_types::index>(x) * xs]);
+                    }
+                  double mean = sum / count;
+                  means[(((oy * ow) + ox) * ns) + s] = mean;
+                  smin[s] = std::min(smin[s], mean);
+                  smax[s] = std::max(smax[s], mean);
+                }
+            }
+        }
+
+      // Linear contrast over the range of the reduced samples.
+      std::vector<double> srange(ns);
+      for (std::size_t s = 0; s < ns; ++s)
+        srange[s] = smax[s] > smin[s] ? smax[s] - smin[s] : 1.0;
+
+      image = QImage(static_cast<int>(ow), static_cast<int>(oh), QImage::Format_RGB32);
+      for (std::size_t oy = 0; oy < oh; ++oy)
+        {
+          QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(static_cast<int>(oy)));
+          for (std::size_t ox = 0; ox < ow; ++ox)
+            {
+              const double *m = &means[((oy * ow) + ox) * ns];
+              uint8_t rgb[3] = {0, 0, 0};
+              for (std::size_t s = 0; s < ns; ++s)
+                {
+                  double n = std::min(1.0, std::max(0.0, (m[s] - smin[s]) / srange[s]));
+                  rgb[s] = static_cast<uint8_t>(std::floor((n * 255.0) + 0.5));
+                }
+              if (ns == 1)
+                line[ox] = qRgb(lut[rgb[0]][0], lut[rgb[0]][1], lut[rgb[0]][2]);
+              else
+                line[ox] = qRgb(rgb[0], rgb[1], rgb[2]);
+            }
+        }
+    }
+  };
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    QImage
+    renderThumbnail(const ome::files::VariantPixelBuffer& buffer,
+                    const QSize&                          size,
+                    const LUT8&                           lut)
+    {
+      ThumbnailVisitor v(size, lut);
+      ome::compat::visit(v, buffer.vbuffer());
+      return v.image;
+    }
+
+    QImage
+    renderThumbnail(const ome::files::FormatReader&  reader,
+                    ome::files::dimension_size_type  series,
+                    ome::files::dimension_size_type  plane,
+                    const QSize&                     size,
+                    const LUT8&                      lut)
+    {
+      ome::files::VariantPixelBuffer buf;
+      if (reader.getSeries() != series)
+        reader.setSeries(series);
+      reader.openBytes(plane, buf);
+
+      return renderThumbnail(buf, size, lut);
+    }
+
+    QImage
+    renderThumbnail(ReaderPool&                      pool,
+                    ome::files::dimension_size_type  series,
+                    ome::files::dimension_size_type  plane,
+                    const QSize&                     size,
+                    const LUT8&                      lut)
+    {
+      ome::files::VariantPixelBuffer buf;
+      {
+        ReaderPool::Lease reader(pool.acquire(series));
+        if (!reader)
+          return QImage();
+        reader->openBytes(plane, buf);
+      }
+
+      return renderThumbnail(buf, size, lut);
+    }
+
+  }
+}
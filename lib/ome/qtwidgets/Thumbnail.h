@@ -0,0 +1,128 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_THUMBNAIL_H
+#define OME_QTWIDGETS_THUMBNAIL_H
+
+#include <ome/files/FormatReader.h>
+#include <ome/files/VariantPixelBuffer.h>
+
+#include <ome/qtwidgets/LUT.h>
+#include <ome/qtwidgets/ReaderPool.h>
+
+#include <QtCore/QSize>
+#include <QtGui/QImage>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Render a thumbnail of a pixel buffer.
+     *
+     * This is intended for batch use where no GL context is
+     * available.  The plane is reduced with a box filter to fit
+     * within the specified size (preserving the aspect ratio), and
+     * linear contrast is autoscaled to the range of the reduced
+     * samples, rather than using the texel mapping and contrast
+     * limits of Image2D, so thumbnails may differ from the rendered
+     * view.
+     * Single channel data is coloured using the specified lookup
+     * table; data with multiple samples per pixel is rendered
+     * directly as RGB.
+     *
+     * @param buffer the pixel buffer containing a single xy plane.
+     * @param size the maximum thumbnail size.
+     * @param lut the lookup table to use.
+     * @returns the thumbnail image.
+     */
+    QImage
+    renderThumbnail(const ome::files::VariantPixelBuffer& buffer,
+                    const QSize&                          size,
+                    const LUT8&                           lut);
+
+    /**
+     * Render a thumbnail of a plane.
+     *
+     * The reader is left with @p series as the current series.
+     *
+     * @param reader the image reader.
+     * @param series the image series.
+     * @param plane the plane to render.
+     * @param size the maximum thumbnail size.
+     * @param lut the lookup table to use.
+     * @returns the thumbnail image.
+     */
+    QImage
+    renderThumbnail(const ome::files::FormatReader&  reader,
+                    ome::files::dimension_size_type  series,
+                    ome::files::dimension_size_type  plane,
+                    const QSize&                     size,
+                    const LUT8&                      lut);
+
+    /**
+     * Render a thumbnail of a plane.
+     *
+     * The plane is read with a reader leased from the pool.
+     *
+     * @param pool the reader pool.
+     * @param series the image series.
+     * @param plane the plane to render.
+     * @param size the maximum thumbnail size.
+     * @param lut the lookup table to use.
+     * @returns the thumbnail image, or a null image if no reader
+     * could be acquired.
+     */
+    QImage
+    renderThumbnail(ReaderPool&                      pool,
+                    ome::files::dimension_size_type  series,
+                    ome::files::dimension_size_type  plane,
+                    const QSize&                     size,
+                    const LUT8&                      lut);
+
+  }
+}
+
+#endif // OME_QTWIDGETS_THUMBNAIL_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
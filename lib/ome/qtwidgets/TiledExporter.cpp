@@ -0,0 +1,324 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include <ome/files/CoreMetadata.h>
+#include <ome/files/MetadataTools.h>
+#include <ome/files/PixelBuffer.h>
+#include <ome/files/VariantPixelBuffer.h>
+#include <ome/files/out/OMETIFFWriter.h>
+
+#include <ome/xml/meta/OMEXMLMetadata.h>
+
+#include <ome/qtwidgets/TiledExporter.h>
+
+#include <QtCore/QFile>
+#include <QtCore/QRectF>
+#include <QtCore/QTimerEvent>
+
+using ome::files::dimension_size_type;
+using ome::files::PixelBuffer;
+using ome::files::PixelBufferBase;
+using ome::xml::model::enums::DimensionOrder;
+using ome::xml::model::enums::PixelType;
+
+namespace
+{
+
+  // Image size (bytes) above which BigTIFF is used; leaves room for
+  // the IFDs and OME-XML below the 4 GiB classic TIFF limit.
+  const uint64_t bigtiff_threshold = 0xF0000000ULL;
+
+  // Step interval while waiting for localisations to load (ms).
+  const int idle_interval = 5;
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    TiledExporter::TiledExporter(std::shared_ptr<ome::files::FormatReader>  reader,
+                                 ome::files::dimension_size_type            series,
+                                 unsigned int                               tileSize,
+                                 QObject                                   *parent):
+      QObject(parent),
+      renderer(reader, series, QSize(static_cast<int>(tileSize), static_cast<int>(tileSize))),
+      tileSize(tileSize),
+      path(),
+      camera(),
+      view(),
+      width(0),
+      height(0),
+      plane(0),
+      min(0.0f),
+      max(1.0f),
+      done(0),
+      writer(),
+      rgba(),
+      timer()
+    {
+    }
+
+    TiledExporter::~TiledExporter()
+    {
+      if (isRunning())
+        close(false);
+    }
+
+    OffscreenRenderer2D&
+    TiledExporter::getRenderer()
+    {
+      return renderer;
+    }
+
+    unsigned int
+    TiledExporter::getTileSize() const
+    {
+      return tileSize;
+    }
+
+    bool
+    TiledExporter::start(const QString&                  path,
+                         const Camera2D&                 camera,
+                         const QSizeF&                   extent,
+                         const QSize&                    size,
+                         ome::files::dimension_size_type plane,
+                         const glm::vec3&                min,
+                         const glm::vec3&                max,
+                         int                             lutRow)
+    {
+      if (isRunning())
+        return false;
+      if (!renderer.isValid())
+        {
+          std::cerr << "TiledExporter: Offscreen renderer is not usable" << std::endl;
+          return false;
+        }
+      if (size.isEmpty() || extent.isEmpty())
+        return false;
+
+      this->path = path;
+      this->camera = camera;
+      this->plane = plane;
+      this->min = min;
+      this->max = max;
+      renderer.setLUTRow(lutRow);
+      width = static_cast<dimension_size_type>(size.width());
+      height = static_cast<dimension_size_type>(size.height());
+      done = 0;
+
+      // Preserve the horizontal field of view and the pixel aspect
+      // ratio.
+      view = QSizeF(extent.width(),
+                    extent.width() * static_cast<double>(height) / static_cast<double>(width));
+
+      try
+        {
+          // A single RGB plane.
+          std::shared_ptr<ome::xml::meta::OMEXMLMetadata> meta(std::make_shared<ome::xml::meta::OMEXMLMetadata>());
+          std::shared_ptr<ome::files::CoreMetadata> core(std::make_shared<ome::files::CoreMetadata>());
+          core->sizeX = width;
+          core->sizeY = height;
+          core->sizeC.clear();
+          core->sizeC.push_back(3);
+          core->pixelType = PixelType::UINT8;
+          core->interleaved = true;
+          core->bitsPerPixel = 8;
+          core->dimensionOrder = DimensionOrder::XYZTC;
+          std::vector<std::shared_ptr<ome::files::CoreMetadata>> seriesList;
+          seriesList.push_back(core);
+          ome::files::fillMetadata(*meta, seriesList);
+
+          std::shared_ptr<ome::files::out::OMETIFFWriter> tiffwriter(std::make_shared<ome::files::out::OMETIFFWriter>());
+          std::shared_ptr<ome::xml::meta::MetadataRetrieve> retrieve(std::static_pointer_cast<ome::xml::meta::MetadataRetrieve>(meta));
+          tiffwriter->setMetadataRetrieve(retrieve);
+          tiffwriter->setInterleaved(true);
+          tiffwriter->setTileSizeX(tileSize);
+          tiffwriter->setTileSizeY(tileSize);
+          tiffwriter->setBigTIFF(width * height * 3 > bigtiff_threshold);
+          tiffwriter->setId(path.toStdString());
+          tiffwriter->setSeries(0);
+          writer = tiffwriter;
+        }
+      catch (const std::exception& e)
+        {
+          std::cerr << "TiledExporter: Failed to create " << path.toStdString() << ": " << e.what() << std::endl;
+          writer.reset();
+          QFile::remove(path);
+          return false;
+        }
+
+      timer.start(0, this);
+      return true;
+    }
+
+    bool
+    TiledExporter::isRunning() const
+    {
+      return timer.isActive();
+    }
+
+    void
+    TiledExporter::cancel()
+    {
+      if (isRunning())
+        stop(false);
+    }
+
+    void
+    TiledExporter::timerEvent(QTimerEvent *event)
+    {
+      if (event->timerId() == timer.timerId())
+        step();
+      else
+        QObject::timerEvent(event);
+    }
+
+    void
+    TiledExporter::step()
+    {
+      // Localisations must be loaded before the first tile is
+      // rendered; wait without blocking the event loop.
+      if (!renderer.updateLocalisations())
+        {
+          timer.start(idle_interval, this);
+          return;
+        }
+
+      const dimension_size_type tile = tileSize;
+      const dimension_size_type xtiles = (width + tile - 1) / tile;
+      const dimension_size_type ytiles = (height + tile - 1) / tile;
+      const quint64 total = xtiles * ytiles;
+      const dimension_size_type tx = done % xtiles;
+      const dimension_size_type ty = done / xtiles;
+      const dimension_size_type x = tx * tile;
+      const dimension_size_type y = ty * tile;
+      const dimension_size_type w = std::min(tile, width - x);
+      const dimension_size_type h = std::min(tile, height - y);
+      const double tilew = static_cast<double>(tile) / static_cast<double>(width);
+      const double tileh = static_cast<double>(tile) / static_cast<double>(height);
+
+      try
+        {
+          // Edge tiles are rendered at full size and clipped, to keep
+          // the scale uniform.
+          QRectF region(static_cast<double>(tx) * tilew,
+                        static_cast<double>(ty) * tileh,
+                        tilew, tileh);
+          renderer.renderRegion(camera, view, region, plane, min, max, rgba);
+          if (rgba.empty())
+            {
+              stop(false);
+              return;
+            }
+
+          // Interleaved XYZTC storage order is RGB samples in rows
+          // from top to bottom, as for the rendered tile.
+          std::shared_ptr<PixelBuffer<uint8_t>> buffer
+            (std::make_shared<PixelBuffer<uint8_t>>(boost::extents[w][h][1][1][1][1][1][1][3],
+                                                    PixelType::UINT8,
+                                                    ome::files::ENDIAN_NATIVE,
+                                                    PixelBufferBase::make_storage_order(DimensionOrder::XYZTC, true)));
+          uint8_t *dest = buffer->data();
+          for (dimension_size_type r = 0; r < h; ++r)
+            {
+              const uint8_t *src = rgba.data() + (r * tile * 4);
+              for (dimension_size_type c = 0; c < w; ++c, src += 4, dest += 3)
+                {
+                  dest[0] = src[0];
+                  dest[1] = src[1];
+                  dest[2] = src[2];
+                }
+            }
+
+          ome::files::VariantPixelBuffer vbuffer(buffer);
+          writer->saveBytes(0, vbuffer, x, y, w, h);
+        }
+      catch (const std::exception& e)
+        {
+          std::cerr << "TiledExporter: Failed to write " << path.toStdString() << ": " << e.what() << std::endl;
+          stop(false);
+          return;
+        }
+
+      emit progress(++done, total);
+      if (done == total)
+        stop(true);
+      else if (isRunning())
+        // Render the next tile immediately; the export may have been
+        // cancelled by a progress handler.
+        timer.start(0, this);
+    }
+
+    void
+    TiledExporter::stop(bool success)
+    {
+      emit finished(close(success));
+    }
+
+    bool
+    TiledExporter::close(bool success)
+    {
+      timer.stop();
+      rgba.clear();
+
+      if (writer)
+        {
+          try
+            {
+              writer->close();
+            }
+          catch (const std::exception& e)
+            {
+              std::cerr << "TiledExporter: Failed to write " << path.toStdString() << ": " << e.what() << std::endl;
+              success = false;
+            }
+          writer.reset();
+        }
+
+      if (!success)
+        QFile::remove(path);
+      return success;
+    }
+
+  }
+}
@@ -0,0 +1,272 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_TILEDEXPORTER_H
+#define OME_QTWIDGETS_TILEDEXPORTER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ome/files/FormatReader.h>
+#include <ome/files/FormatWriter.h>
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/Camera2D.h>
+#include <ome/qtwidgets/OffscreenRenderer2D.h>
+
+#include <QtCore/QBasicTimer>
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QSizeF>
+#include <QtCore/QString>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Export a view as an image larger than the framebuffer.
+     *
+     * The view is rendered in tiles with an OffscreenRenderer2D,
+     * using a projection magnified to cover each tile in turn.  Each
+     * tile is written directly to a tiled OME-TIFF file, so peak
+     * memory use is a single tile regardless of the image size.
+     * BigTIFF is used if the image would exceed the classic TIFF
+     * size limit.
+     *
+     * Rendering is driven by a timer on the GUI thread, one tile at
+     * a time, so the event loop is never blocked for long.  The
+     * progress() signal is emitted after each tile, and finished()
+     * once the image is complete, has failed or was cancelled.
+     *
+     * @note The exporter must be constructed and used on the GUI
+     * thread, since it owns an OffscreenRenderer2D.
+     */
+    class TiledExporter : public QObject
+    {
+      Q_OBJECT
+
+    public:
+      /**
+       * Constructor.
+       *
+       * @param reader the image reader.
+       * @param series the image series.
+       * @param tileSize the tile size (pixels); must be a multiple
+       * of 16.
+       * @param parent the parent of this object.
+       */
+      TiledExporter(std::shared_ptr<ome::files::FormatReader>  reader,
+                    ome::files::dimension_size_type            series,
+                    unsigned int                               tileSize = 1024,
+                    QObject                                   *parent = 0);
+
+      /**
+       * Destructor.
+       *
+       * Any running export is cancelled and the output file is
+       * removed; finished() is not emitted.
+       */
+      ~TiledExporter();
+
+      /**
+       * Get the offscreen renderer.
+       *
+       * May be used to set the visibility of the axes, grid and
+       * overlay, and the point localisations, before starting.
+       *
+       * @returns the renderer.
+       */
+      OffscreenRenderer2D&
+      getRenderer();
+
+      /**
+       * Get the tile size.
+       *
+       * @returns the tile size (pixels).
+       */
+      unsigned int
+      getTileSize() const;
+
+      /**
+       * Start exporting an image.
+       *
+       * The camera frames the view as for a render target of size
+       * @p extent, typically the size of the interactive view.  The
+       * exported image shows the same field of view, scaled to
+       * @p size.  If the aspect ratios differ, the horizontal field
+       * of view is preserved.
+       *
+       * @param path the output path.
+       * @param camera the camera to render with.
+       * @param extent the size of the view framed by the camera.
+       * @param size the size of the exported image (pixels).
+       * @param plane the plane to render.
+       * @param min the minimum limits for linear contrast.
+       * @param max the maximum limits for linear contrast.
+       * @param lutRow the row of the shared LUT texture.
+       * @returns @c true if the export was started, or @c false if
+       * already running or the output could not be created.
+       */
+      bool
+      start(const QString&                  path,
+            const Camera2D&                 camera,
+            const QSizeF&                   extent,
+            const QSize&                    size,
+            ome::files::dimension_size_type plane,
+            const glm::vec3&                min,
+            const glm::vec3&                max,
+            int                             lutRow = 0);
+
+      /**
+       * Check if an export is running.
+       *
+       * @returns @c true if running.
+       */
+      bool
+      isRunning() const;
+
+    public slots:
+      /**
+       * Cancel a running export.
+       *
+       * The output file is removed, and finished() is emitted with a
+       * failure status.
+       */
+      void
+      cancel();
+
+    signals:
+      /**
+       * Signal progress.
+       *
+       * @param done the number of tiles written.
+       * @param total the total number of tiles.
+       */
+      void
+      progress(quint64 done,
+               quint64 total);
+
+      /**
+       * Signal completion.
+       *
+       * @param success @c true if the image was written, @c false on
+       * failure or cancellation, in which case the output file is
+       * removed.
+       */
+      void
+      finished(bool success);
+
+    protected:
+      /**
+       * Handle timer events.
+       *
+       * Used to render and write tiles.
+       *
+       * @param event the event to handle.
+       */
+      void
+      timerEvent(QTimerEvent *event);
+
+    private:
+      /// Render and write the next tile.
+      void
+      step();
+
+      /**
+       * Stop exporting and signal completion.
+       *
+       * @param success @c true if the export completed.
+       */
+      void
+      stop(bool success);
+
+      /**
+       * Stop the timer and close the output.
+       *
+       * The output file is removed unless the export completed and
+       * was closed successfully.
+       *
+       * @param success @c true if the export completed.
+       * @returns @c true if the image was written.
+       */
+      bool
+      close(bool success);
+
+      /// Offscreen renderer, sized to a single tile.
+      OffscreenRenderer2D renderer;
+      /// Tile size.
+      unsigned int tileSize;
+      /// Output path.
+      QString path;
+      /// Camera.
+      Camera2D camera;
+      /// Size of the view framed by the camera, at the image aspect ratio.
+      QSizeF view;
+      /// Image width (pixels).
+      ome::files::dimension_size_type width;
+      /// Image height (pixels).
+      ome::files::dimension_size_type height;
+      /// Plane to render.
+      ome::files::dimension_size_type plane;
+      /// Minimum limits for linear contrast.
+      glm::vec3 min;
+      /// Maximum limits for linear contrast.
+      glm::vec3 max;
+      /// Number of tiles written.
+      quint64 done;
+      /// Output writer.
+      std::shared_ptr<ome::files::FormatWriter> writer;
+      /// Rendered tile (8-bit RGBA samples, top to bottom).
+      std::vector<uint8_t> rgba;
+      /// Render timer.
+      QBasicTimer timer;
+    };
+
+  }
+}
+
+#endif // OME_QTWIDGETS_TILEDEXPORTER_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,432 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <ome/qtwidgets/Trace.h>
+
+#include <QtCore/QCoreApplication>
+
+namespace
+{
+
+  // Events retained per thread.
+  const std::size_t ring_capacity = 1U << 14;
+
+  /*
+   * A recorded span.
+   *
+   * Each slot is guarded by a sequence number: odd while being
+   * written, and even once complete, so that the slot may be read
+   * consistently while its thread continues recording.
+   */
+  struct Event
+  {
+    Event():
+      sequence(0),
+      name(nullptr),
+      category(nullptr),
+      start(0),
+      duration(0)
+    {}
+
+    /// Sequence number.
+    std::atomic<uint64_t> sequence;
+    /// Span name.
+    std::atomic<const char *> name;
+    /// Span category.
+    std::atomic<const char *> category;
+    /// Start time (ns).
+    std::atomic<uint64_t> start;
+    /// Duration (ns).
+    std::atomic<uint64_t> duration;
+  };
+
+  /*
+   * Event ring buffer of a single thread.  Only the owning thread
+   * writes to the ring.  When the thread exits, the ring is reused
+   * by the next new thread under a new identifier; the events of
+   * the previous thread are retired and no longer written to the
+   * trace.
+   */
+  struct Ring
+  {
+    explicit
+    Ring(uint64_t id):
+      tid(id),
+      first(0),
+      head(0),
+      events(ring_capacity),
+      nameMutex(),
+      name(),
+      active(true)
+    {}
+
+    /// Thread identifier in the trace (locked by the ring list lock).
+    uint64_t tid;
+    /// Index of the first event of the current thread (locked by the
+    /// ring list lock).
+    uint64_t first;
+    /// Number of events recorded.
+    std::atomic<uint64_t> head;
+    /// Event slots.
+    std::vector<Event> events;
+    /// Lock for the thread name.
+    std::mutex nameMutex;
+    /// Thread name.
+    std::string name;
+    /// Owned by a running thread (locked by the ring list lock).
+    bool active;
+  };
+
+  /*
+   * Global trace state.  Never destroyed, so that the trace may be
+   * written by an exit handler.
+   */
+  struct TraceState
+  {
+    TraceState():
+      enabled(false),
+      epoch(std::chrono::steady_clock::now()),
+      path(),
+      mutex(),
+      rings(),
+      nextTid(1)
+    {
+      const char *env = std::getenv("OME_QTWIDGETS_TRACE");
+      if (env && *env)
+        {
+          path = env;
+          enabled = true;
+        }
+    }
+
+    /// Recording enabled.
+    std::atomic<bool> enabled;
+    /// Time origin.
+    std::chrono::steady_clock::time_point epoch;
+    /// Trace file written on exit.
+    std::string path;
+    /// Lock for the ring list.
+    std::mutex mutex;
+    /// Rings of all threads which have recorded events (reused once
+    /// their thread exits).
+    std::vector<std::shared_ptr<Ring>> rings;
+    /// Next thread identifier.
+    uint64_t nextTid;
+  };
+
+  void
+  dump_at_exit()
+  {
+    ome::qtwidgets::setTraceEnabled(false);
+  }
+
+  TraceState&
+  state()
+  {
+    static TraceState *trace_state = nullptr;
+    static std::once_flag once;
+    std::call_once(once, []()
+                   {
+                     trace_state = new TraceState();
+                     if (!trace_state->path.empty())
+                       std::atexit(dump_at_exit);
+                   });
+    return *trace_state;
+  }
+
+  uint64_t
+  now()
+  {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>
+                                 (std::chrono::steady_clock::now() - state().epoch).count());
+  }
+
+  /*
+   * Ring of the current thread.  The ring is released for reuse when
+   * the thread exits, so that the ring count is bounded by the peak
+   * thread count rather than by the number of threads ever started.
+   */
+  struct ThreadRing
+  {
+    ThreadRing():
+      ring()
+    {}
+
+    ~ThreadRing()
+    {
+      if (ring)
+        {
+          TraceState& s(state());
+          std::lock_guard<std::mutex> lock(s.mutex);
+          ring->active = false;
+        }
+    }
+
+    /// The ring, or null if no events have been recorded.
+    std::shared_ptr<Ring> ring;
+  };
+
+  Ring&
+  thread_ring()
+  {
+    thread_local ThreadRing current;
+    if (!current.ring)
+      {
+        TraceState& s(state());
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto& ring : s.rings)
+          {
+            if (!ring->active)
+              {
+                ring->active = true;
+                ring->tid = s.nextTid++;
+                ring->first = ring->head.load(std::memory_order_relaxed);
+                std::lock_guard<std::mutex> nameLock(ring->nameMutex);
+                ring->name.clear();
+                current.ring = ring;
+                break;
+              }
+          }
+        if (!current.ring)
+          {
+            current.ring = std::make_shared<Ring>(s.nextTid++);
+            s.rings.push_back(current.ring);
+          }
+      }
+    return *current.ring;
+  }
+
+  void
+  record(const char *name,
+         const char *category,
+         uint64_t    start,
+         uint64_t    duration)
+  {
+    Ring& ring(thread_ring());
+    uint64_t n = ring.head.load(std::memory_order_relaxed);
+    Event& event(ring.events[n % ring_capacity]);
+
+    event.sequence.store((2 * n) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.category.store(category, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.sequence.store((2 * n) + 2, std::memory_order_release);
+
+    ring.head.store(n + 1, std::memory_order_release);
+  }
+
+  /*
+   * Write a JSON string.
+   */
+  void
+  write_string(std::ostream&      out,
+               const std::string& str)
+  {
+    out << '"';
+    for (const auto& c : str)
+      {
+        if (c == '"' || c == '\\')
+          out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+              << static_cast<unsigned int>(static_cast<unsigned char>(c))
+              << std::dec << std::setfill(' ');
+        else
+          out << c;
+      }
+    out << '"';
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    TraceScope::TraceScope(const char *spanName,
+                           const char *spanCategory):
+      name(spanName),
+      category(spanCategory),
+      start(state().enabled.load(std::memory_order_relaxed) ? now() : 0)
+    {
+    }
+
+    TraceScope::~TraceScope()
+    {
+      if (start && state().enabled.load(std::memory_order_relaxed))
+        record(name, category, start, now() - start);
+    }
+
+    bool
+    traceEnabled()
+    {
+      return state().enabled;
+    }
+
+    void
+    setTraceEnabled(bool enable)
+    {
+      TraceState& s(state());
+      bool was = s.enabled.exchange(enable);
+      // Write the trace when recording set up by the environment
+      // stops.
+      if (was && !enable && !s.path.empty())
+        dumpTrace(s.path);
+    }
+
+    void
+    setTraceThreadName(const std::string& name)
+    {
+      if (!traceEnabled())
+        return;
+
+      Ring& ring(thread_ring());
+      std::lock_guard<std::mutex> lock(ring.nameMutex);
+      ring.name = name;
+    }
+
+    bool
+    dumpTrace(const std::string& path)
+    {
+      TraceState& s(state());
+
+      // Rings with the identifier and event range of their current
+      // thread; events recorded after a ring is reused lie outside
+      // the range.
+      struct RingState
+      {
+        std::shared_ptr<Ring> ring;
+        uint64_t tid;
+        uint64_t first;
+        uint64_t head;
+      };
+      std::vector<RingState> rings;
+      {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto& ring : s.rings)
+          rings.push_back(RingState{ring, ring->tid, ring->first,
+                                    ring->head.load(std::memory_order_acquire)});
+      }
+
+      std::ofstream out(path.c_str());
+      if (!out)
+        {
+          std::cerr << "Trace: Failed to write " << path << std::endl;
+          return false;
+        }
+
+      const qint64 pid = QCoreApplication::applicationPid();
+      out << std::fixed << std::setprecision(3);
+      out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+      bool first = true;
+      for (const auto& rs : rings)
+        {
+          const std::shared_ptr<Ring>& ring(rs.ring);
+          std::string name;
+          {
+            std::lock_guard<std::mutex> lock(ring->nameMutex);
+            name = ring->name;
+          }
+          if (!name.empty())
+            {
+              out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                  << ",\"tid\":" << rs.tid << ",\"args\":{\"name\":";
+              write_string(out, name);
+              out << "}}";
+              first = false;
+            }
+
+          const uint64_t head = rs.head;
+          uint64_t begin = std::max(rs.first, head > ring_capacity ? head - ring_capacity : 0);
+          for (uint64_t n = begin; n < head; ++n)
+            {
+              const Event& event(ring->events[n % ring_capacity]);
+              uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+              const char *ename = event.name.load(std::memory_order_relaxed);
+              const char *ecategory = event.category.load(std::memory_order_relaxed);
+              uint64_t start = event.start.load(std::memory_order_relaxed);
+              uint64_t duration = event.duration.load(std::memory_order_relaxed);
+              std::atomic_thread_fence(std::memory_order_acquire);
+              // Skip slots overwritten while reading.
+              if (sequence != (2 * n) + 2 ||
+                  event.sequence.load(std::memory_order_relaxed) != sequence ||
+                  !ename || !ecategory)
+                continue;
+
+              out << (first ? "" : ",") << "\n{\"name\":";
+              write_string(out, ename);
+              out << ",\"cat\":";
+              write_string(out, ecategory);
+              out << ",\"ph\":\"X\",\"ts\":" << static_cast<double>(start) / 1000.0
+                  << ",\"dur\":" << static_cast<double>(duration) / 1000.0
+                  << ",\"pid\":" << pid << ",\"tid\":" << rs.tid << "}";
+              first = false;
+            }
+        }
+      out << "\n]}\n";
+
+      if (!out)
+        {
+          std::cerr << "Trace: Failed to write " << path << std::endl;
+          return false;
+        }
+      return true;
+    }
+
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,144 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_TRACE_H
+#define OME_QTWIDGETS_TRACE_H
+
+#include <cstdint>
+#include <string>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+
+    /**
+     * Scoped trace span.
+     *
+     * The span from construction to destruction is recorded in a
+     * per-thread ring buffer, if tracing is enabled.  Recording is
+     * lock-free; only the most recent events of each thread are
+     * retained.  Recorded spans may be written as Chrome trace event
+     * JSON with dumpTrace(), for viewing with chrome://tracing or
+     * Perfetto.
+     *
+     * Tracing is enabled by setting the environment variable
+     * OME_QTWIDGETS_TRACE to the path of a JSON file; the trace is
+     * written to this file on exit.  When disabled, a span costs a
+     * single flag check.
+     *
+     * The name and category must be string literals (or otherwise
+     * outlive the process), since only the pointers are recorded.
+     */
+    class TraceScope
+    {
+    public:
+      /**
+       * Start a span.
+       *
+       * @param name the span name.
+       * @param category the span category, e.g. "read", "convert",
+       * "upload" or "render".
+       */
+      explicit
+      TraceScope(const char *name,
+                 const char *category);
+
+      /// End the span.
+      ~TraceScope();
+
+      TraceScope(const TraceScope&) = delete;
+
+      TraceScope&
+      operator= (const TraceScope&) = delete;
+
+    private:
+      /// Span name.
+      const char *name;
+      /// Span category.
+      const char *category;
+      /// Start time (ns), or zero if not tracing.
+      uint64_t start;
+    };
+
+    /**
+     * Check if tracing is enabled.
+     *
+     * @returns @c true if spans are recorded.
+     */
+    bool
+    traceEnabled();
+
+    /**
+     * Enable or disable tracing.
+     *
+     * @param enable @c true to record spans, @c false to stop.
+     */
+    void
+    setTraceEnabled(bool enable);
+
+    /**
+     * Set the name of the current thread in the trace.
+     *
+     * @param name the thread name.
+     */
+    void
+    setTraceThreadName(const std::string& name);
+
+    /**
+     * Write the recorded spans of all threads.
+     *
+     * The spans are written as Chrome trace event JSON.  Recording
+     * may continue while the trace is written.
+     *
+     * @param path the file to write.
+     * @returns @c true on success, @c false on failure.
+     */
+    bool
+    dumpTrace(const std::string& path);
+
+  }
+}
+
+#endif // OME_QTWIDGETS_TRACE_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -36,6 +36,7 @@
  * #L%
  */
 
+#include <ome/qtwidgets/SeriesInfo.h>
 #include <ome/qtwidgets/gl/Axis2D.h>
 #include <ome/qtwidgets/gl/Util.h>
 
@@ -69,13 +70,11 @@ namespace ome
       void
       Axis2D::create()
       {
-        ome::files::dimension_size_type oldseries = reader->getSeries();
-        reader->setSeries(series);
-        setSize(glm::vec2(-(reader->getSizeX()/2.0f), reader->getSizeX()/2.0f),
-                glm::vec2(-(reader->getSizeY()/2.0f), reader->getSizeY()/2.0f),
-                glm::vec2(-(reader->getSizeX()/2.0f)-12.0, -(reader->getSizeY()/2.0f)-12.0),
+        std::shared_ptr<const SeriesInfo> info(SeriesInfo::get(reader, series));
+        setSize(glm::vec2(-(info->sizeX/2.0f), info->sizeX/2.0f),
+                glm::vec2(-(info->sizeY/2.0f), info->sizeY/2.0f),
+                glm::vec2(-(info->sizeX/2.0f)-12.0, -(info->sizeY/2.0f)-12.0),
                 glm::vec2(-6.0, 6.0));
-        reader->setSeries(oldseries);
       }
 
       void
@@ -36,10 +36,11 @@
  * #L%
  */
 
+#include <ome/qtwidgets/SeriesInfo.h>
 #include <ome/qtwidgets/gl/Grid2D.h>
 #include <ome/qtwidgets/gl/Util.h>
 
-#include <array>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -49,18 +50,6 @@
 
 namespace
 {
-  struct vert
-  {
-    glm::vec3 coords; // x, y, scalefactor
-    glm::vec3 colour;
-
-    vert(const glm::vec3& coords,
-         const glm::vec3& colour):
-      coords(coords),
-      colour(colour)
-    {}
-  };
-
   /**
    * Calculate major gridline.
    *
@@ -111,17 +100,16 @@ namespace ome
                      QObject                                                *parent):
         QObject(parent),
         vertices(),
-        grid_vertices(QOpenGLBuffer::VertexBuffer),
-        grid_elements(QOpenGLBuffer::IndexBuffer),
+        xlim(),
+        ylim(),
+        lmajor(),
         reader(reader),
         series(series)
       {
         initializeOpenGLFunctions();
 
-        ome::files::dimension_size_type oldseries = reader->getSeries();
-        reader->setSeries(series);
-        setSize(glm::vec2(-(static_cast<float>(reader->getSizeX())), reader->getSizeX()), glm::vec2(-(static_cast<float>(reader->getSizeY())), reader->getSizeY()));
-        reader->setSeries(oldseries);
+        std::shared_ptr<const SeriesInfo> info(SeriesInfo::get(reader, series));
+        setSize(glm::vec2(-(static_cast<float>(info->sizeX)), info->sizeX), glm::vec2(-(static_cast<float>(info->sizeY)), info->sizeY));
       }
 
       Grid2D::~Grid2D()
@@ -130,85 +118,22 @@ namespace ome
 
       void Grid2D::create()
       {
+        vertices.create();
       }
 
       void
       Grid2D::setSize(const glm::vec2& xlim,
                       const glm::vec2& ylim)
       {
-        std::array<glm::vec3, 3> gridcol;
-        gridcol[0] = glm::vec3(0.5f, 0.5f, 0.5f);
-        gridcol[1] = glm::vec3(0.7f, 0.7f, 0.7f);
-        gridcol[2] = glm::vec3(0.9f, 0.9f, 0.9f);
-        glm::vec3 xcol(0.5f, 0.0f, 0.0f);
-        glm::vec3 ycol(0.0f, 0.5f, 0.0f);
-
         float xdiff = xlim[1] - xlim[0];
         float ydiff = ylim[1] - ylim[0];
 
-        int lmajor = major(std::max(xdiff, ydiff));
-
-        float xmin = majorlimit(lmajor, xlim[0], false);
-        float xmax = majorlimit(lmajor, xlim[1], true);
-        float ymin = majorlimit(lmajor, ylim[0], false);
-        float ymax = majorlimit(lmajor, ylim[1], true);
-        std::vector<vert> verts;
-        std::vector<GLushort> idxs;
-
-        uint32_t id = 0;
-        // x and y origin
-        verts.push_back(vert(glm::vec3(xmin, 0.0f, 0.0f), xcol));
-        verts.push_back(vert(glm::vec3(xmax, 0.0f, 0.0f), xcol));
-        idxs.push_back(id++);
-        idxs.push_back(id++);
-        verts.push_back(vert(glm::vec3(0.0f, ymin, 0.0f), ycol));
-        verts.push_back(vert(glm::vec3(0.0f, ymax, 0.0f), ycol));
-        idxs.push_back(id++);
-        idxs.push_back(id++);
-
-        // Grid lines at increasing level of detail
-        for (int i = 0; i < 3; ++i)
-          {
-            float gmajor = std::pow(10.0f, static_cast<float>(lmajor-i));
-            uint32_t mf = static_cast<uint32_t>(std::pow(10.0f, static_cast<float>(i-1)));
-            for (uint32_t j = 0; j < static_cast<uint32_t>((xmax-xmin)/gmajor)+1; ++j)
-              {
-                if (mf <= 1 || j % mf)
-                  {
-                    float x = xmin + (static_cast<float>(j) * gmajor);
-                    verts.push_back(vert(glm::vec3(x, ymin, static_cast<float>(i)), gridcol.at(i)));
-                    verts.push_back(vert(glm::vec3(x, ymax, static_cast<float>(i)), gridcol.at(i)));
-                    idxs.push_back(id++);
-                    idxs.push_back(id++);
-                  }
-              }
-            for (uint32_t j = 0; j < static_cast<uint32_t>((ymax-ymin)/gmajor)+1; ++j)
-              {
-                if (mf <= 1 || j % mf)
-                  {
-                    float y = ymin + (static_cast<float>(j) * gmajor);
-                    verts.push_back(vert(glm::vec3(xmin, y, static_cast<float>(i)), gridcol.at(i)));
-                    verts.push_back(vert(glm::vec3(xmax, y, static_cast<float>(i)), gridcol.at(i)));
-                    idxs.push_back(id++);
-                    idxs.push_back(id++);
-                  }
-              }
-          }
+        lmajor = major(std::max(xdiff, ydiff));
 
-        vertices.create();
-        vertices.bind();
-
-        grid_vertices.create();
-        grid_vertices.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        grid_vertices.bind();
-        grid_vertices.allocate(verts.data(),
-                               sizeof(vert) * static_cast<size_t>(verts.size()));
-
-        grid_elements.create();
-        grid_elements.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        grid_elements.bind();
-        grid_elements.allocate(idxs.data(),
-                               sizeof(GLushort) * static_cast<size_t>(idxs.size()));
+        this->xlim = glm::vec2(majorlimit(lmajor, xlim[0], false),
+                               majorlimit(lmajor, xlim[1], true));
+        this->ylim = glm::vec2(majorlimit(lmajor, ylim[0], false),
+                               majorlimit(lmajor, ylim[1], true));
       }
 
     }
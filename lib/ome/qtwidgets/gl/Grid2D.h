@@ -43,7 +43,6 @@
 
 #include <QtCore/QObject>
 #include <QtGui/QOpenGLVertexArrayObject>
-#include <QtGui/QOpenGLBuffer>
 #include <QtGui/QOpenGLShader>
 #include <QtGui/QOpenGLFunctions_3_3_Core>
 
@@ -62,7 +61,10 @@ namespace ome
       /**
        * 2D (xy) grid renderer.
        *
-       * Draws x and y gridlines for the specified image.
+       * Draws x and y gridlines for the specified image.  The
+       * gridlines are computed procedurally in a single full-screen
+       * pass, so the cost is independent of the grid extent and
+       * density.
        */
       class Grid2D : public QObject,
                      protected QOpenGLFunctions_3_3_Core
@@ -88,7 +90,7 @@ namespace ome
         ~Grid2D() = 0;
 
         /**
-         * Create GL buffers.
+         * Create GL objects.
          *
          * @note Requires a valid GL context.  Must be called before
          * rendering.
@@ -123,12 +125,14 @@ namespace ome
         setSize(const glm::vec2& xlim,
                 const glm::vec2& ylim);
 
-        /// The vertex array.
+        /// The (empty) vertex array; required to draw in core profile.
         QOpenGLVertexArrayObject vertices;
-        /// The vertices for the grid.
-        QOpenGLBuffer grid_vertices;
-        /// The elements for the grid.
-        QOpenGLBuffer grid_elements;
+        /// The x limits of the grid.
+        glm::vec2 xlim;
+        /// The y limits of the grid.
+        glm::vec2 ylim;
+        /// The order of magnitude of the major gridlines.
+        int lmajor;
         /// The image reader.
         std::shared_ptr<ome::files::FormatReader> reader;
         /// The image series.
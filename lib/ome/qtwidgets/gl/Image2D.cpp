@@ -39,7 +39,11 @@
 #include <ome/files/PixelBuffer.h>
 #include <ome/files/VariantPixelBuffer.h>
 
+#include <ome/qtwidgets/MappedPlane.h>
+#include <ome/qtwidgets/TexelProperties.h>
+#include <ome/qtwidgets/Trace.h>
 #include <ome/qtwidgets/gl/Image2D.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
 #include <ome/qtwidgets/gl/Util.h>
 
 #include <iostream>
@@ -48,6 +52,7 @@ using ome::files::PixelBuffer;
 using ome::files::PixelBufferBase;
 using ome::files::PixelProperties;
 using ome::files::VariantPixelBuffer;
+using ome::qtwidgets::TraceScope;
 using ome::qtwidgets::gl::check_gl;
 typedef ome::xml::model::enums::PixelType PT;
 
@@ -60,92 +65,89 @@ namespace
     GLenum internal_format;
     GLenum external_format;
     GLint external_type;
-    bool make_normal;
+    bool mipmaps;
     GLint min_filter;
     GLint mag_filter;
     ome::files::dimension_size_type w;
     ome::files::dimension_size_type h;
 
-    TextureProperties(const ome::files::FormatReader& reader,
-                      ome::files::dimension_size_type series):
+    TextureProperties(const ome::qtwidgets::SeriesInfo& info):
       internal_format(GL_R8),
       external_format(GL_RED),
       external_type(GL_UNSIGNED_BYTE),
-      make_normal(false),
+      mipmaps(true),
       min_filter(GL_LINEAR_MIPMAP_LINEAR),
       mag_filter(GL_LINEAR),
       w(0),
       h(0)
     {
-      ome::files::dimension_size_type oldseries = reader.getSeries();
-      reader.setSeries(series);
-      ome::xml::model::enums::PixelType pixeltype = reader.getPixelType();
-      reader.setSeries(oldseries);
+      ome::xml::model::enums::PixelType pixeltype = info.pixelType;
+      w = info.sizeX;
+      h = info.sizeY;
+
+      // Mipmaps are generated for normalized and floating point
+      // textures.  32-bit integer and BIT types are stored raw in
+      // integer textures, which are sampled with nearest filtering.
+      internal_format = ome::qtwidgets::textureInternalFormat(pixeltype);
+      external_format = ome::qtwidgets::textureExternalFormat(pixeltype);
+      external_type = ome::qtwidgets::textureExternalType(pixeltype);
+      mipmaps = ome::qtwidgets::textureSampler(pixeltype) == ome::qtwidgets::FLOAT_SAMPLER;
+      min_filter = ome::qtwidgets::textureMinificationFilter(pixeltype);
+      mag_filter = ome::qtwidgets::textureMagnificationFilter(pixeltype);
+    }
+  };
 
-      w = reader.getSizeX();
-      h = reader.getSizeY();
+  /*
+   * Size of a texel in the specified internal format (bytes).
+   */
+  std::size_t
+  texel_size(GLenum internal_format)
+  {
+    std::size_t size = 1;
 
-      switch(pixeltype)
-        {
-        case ::ome::xml::model::enums::PixelType::INT8:
-          internal_format = GL_R8;
-          external_type = GL_BYTE;
-          break;
-        case ::ome::xml::model::enums::PixelType::INT16:
-          internal_format = GL_R16;
-          external_type = GL_SHORT;
-          break;
-        case ::ome::xml::model::enums::PixelType::INT32:
-          internal_format = GL_R16;
-          external_type = GL_INT;
-          make_normal = true;
-          break;
-        case ::ome::xml::model::enums::PixelType::UINT8:
-          internal_format = GL_R8;
-          external_type = GL_UNSIGNED_BYTE;
-          break;
-        case ::ome::xml::model::enums::PixelType::UINT16:
-          internal_format = GL_R16;
-          external_type = GL_UNSIGNED_SHORT;
-          break;
-        case ::ome::xml::model::enums::PixelType::UINT32:
-          internal_format = GL_R16;
-          external_type = GL_UNSIGNED_INT;
-          make_normal = true;
-          break;
-        case ::ome::xml::model::enums::PixelType::FLOAT:
-          internal_format = GL_R32F;
-          if (!GL_ARB_texture_float)
-            internal_format = GL_R16;
-          external_type = GL_FLOAT;
-          break;
-        case ::ome::xml::model::enums::PixelType::DOUBLE:
-          internal_format = GL_R32F;
-          if (!GL_ARB_texture_float)
-            internal_format = GL_R16;
-          external_type = GL_DOUBLE;
-          break;
-        case ::ome::xml::model::enums::PixelType::BIT:
-          internal_format = GL_R8;
-          external_type = GL_UNSIGNED_BYTE;
-          make_normal = true;
-          min_filter = GL_NEAREST_MIPMAP_LINEAR;
-          mag_filter = GL_NEAREST;
-          break;
-        case ::ome::xml::model::enums::PixelType::COMPLEXFLOAT:
-          internal_format = GL_RG32F;
-          if (!GL_ARB_texture_float)
-            internal_format = GL_RG16;
-          external_type = GL_FLOAT;
-          external_format = GL_RG;
-        case ::ome::xml::model::enums::PixelType::COMPLEXDOUBLE:
-          internal_format = GL_RG32F;
-          if (!GL_ARB_texture_float)
-            internal_format = GL_RG16;
-          external_type = GL_DOUBLE;
-          external_format = GL_RG;
-          break;
-        }
+    switch(internal_format)
+      {
+      case GL_R16:
+      case GL_R16_SNORM:
+      case GL_R16UI:
+      case GL_R16I:
+        size = 2;
+        break;
+      case GL_R32F:
+      case GL_R32UI:
+      case GL_R32I:
+      case GL_RG16:
+        size = 4;
+        break;
+      case GL_RG32F:
+        size = 8;
+        break;
+      default:
+        size = 1;
+        break;
+      }
+
+    return size;
+  }
+
+  /*
+   * Get the size of a VariantPixelBuffer's pixel data (bytes).
+   */
+  struct BufferSizeVisitor
+  {
+    std::size_t size;
+
+    BufferSizeVisitor():
+      size(0)
+    {}
+
+    template<typename T>
+    void
+    operator() (const T& v)
+    {
+      typedef typename T::element_type::value_type value_type;
+
+      size = v->num_elements() * sizeof(value_type);
     }
   };
 
@@ -222,6 +224,7 @@ namespace
 
       if (!(new_order == orig_order))
         {
+          TraceScope trace("Image2D::reorder", "convert");
           // Reorder as interleaved.
           const PixelBufferBase::size_type *shape = v->shape();
 
@@ -234,6 +237,7 @@ namespace
         }
 
       // In interleaved order.
+      TraceScope trace("Image2D::upload", "upload");
       glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // MultiArray buffers are packed
 
       glBindTexture(GL_TEXTURE_2D, textureid);
@@ -245,11 +249,13 @@ namespace
                       tprop.h,  // height
                       tprop.external_format,  // format
                       tprop.external_type, // type
-                      //                      testdata);
-                      v->data());
+                      src_buffer->data());
       check_gl("Texture set pixels in subregion");
-      glGenerateMipmap(GL_TEXTURE_2D);
-      check_gl("Generate mipmaps");
+      if (tprop.mipmaps)
+        {
+          glGenerateMipmap(GL_TEXTURE_2D);
+          check_gl("Generate mipmaps");
+        }
     }
 
     template <typename T>
@@ -280,13 +286,18 @@ namespace ome
         image_vertices(QOpenGLBuffer::VertexBuffer),
         image_texcoords(QOpenGLBuffer::VertexBuffer),
         image_elements(QOpenGLBuffer::IndexBuffer),
+        planetexture(),
         textureid(0),
         lutid(0),
+        lutrow(0),
         texmin(0.0f),
         texmax(0.1f),
         texcorr(1.0f),
+        texrange(1.0),
         reader(reader),
         series(series),
+        pool(),
+        info(SeriesInfo::get(reader, series)),
         plane(-1)
       {
         initializeOpenGLFunctions();
@@ -298,78 +309,17 @@ namespace ome
 
       void Image2D::create()
       {
-        TextureProperties tprop(*reader, series);
-
-        ome::files::dimension_size_type oldseries = reader->getSeries();
-        reader->setSeries(series);
-        ome::files::dimension_size_type sizeX = reader->getSizeX();
-        ome::files::dimension_size_type sizeY = reader->getSizeY();
+        ome::files::dimension_size_type sizeX = info->sizeX;
+        ome::files::dimension_size_type sizeY = info->sizeY;
         setSize(glm::vec2(-(sizeX/2.0f), sizeX/2.0f),
                 glm::vec2(-(sizeY/2.0f), sizeY/2.0f));
-        ome::files::dimension_size_type rbpp = reader->getBitsPerPixel();
-        ome::files::dimension_size_type bpp = ome::files::bitsPerPixel(reader->getPixelType());
+        ome::files::dimension_size_type rbpp = info->bitsPerPixel;
+        ome::files::dimension_size_type bpp = ome::files::bitsPerPixel(info->pixelType);
         texcorr[0] = texcorr[1] = texcorr[2] = (1 << (bpp - rbpp));
-        reader->setSeries(oldseries);
-
-        // Create image texture.
-        glGenTextures(1, &textureid);
-        glBindTexture(GL_TEXTURE_2D, textureid);
-        check_gl("Bind texture");
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, tprop.min_filter);
-        check_gl("Set texture min filter");
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, tprop.mag_filter);
-        check_gl("Set texture mag filter");
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        check_gl("Set texture wrap s");
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        check_gl("Set texture wrap t");
-
-        glTexImage2D(GL_TEXTURE_2D,         // target
-                     0,                     // level, 0 = base, no minimap,
-                     tprop.internal_format, // internal format
-                     sizeX,                 // width
-                     sizeY,                 // height
-                     0,                     // border
-                     tprop.external_format, // external format
-                     tprop.external_type,   // external type
-                     0);                    // no image data at this point
-        check_gl("Texture create");
-
-        // Create LUT texture.
-        glGenTextures(1, &lutid);
-        glBindTexture(GL_TEXTURE_1D_ARRAY, lutid);
-        check_gl("Bind texture");
-        glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        check_gl("Set texture min filter");
-        glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        check_gl("Set texture mag filter");
-        glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        check_gl("Set texture wrap s");
-
-        // HiLo
-        uint8_t lut[256][3];
-        for (uint16_t i = 0; i < 256; ++i)
-          for (uint16_t j = 0; j < 3; ++j)
-            {
-              lut[i][j] = i;
-            }
-        lut[0][0] = 0;
-        lut[0][2] = 0;
-        lut[0][2] = 255;
-        lut[255][0] = 255;
-        lut[255][1] = 0;
-        lut[255][2] = 0;
-
-        glTexImage2D(GL_TEXTURE_1D_ARRAY, // target
-                     0,                   // level, 0 = base, no minimap,
-                     GL_RGB8,             // internal format
-                     256,                 // width
-                     1,                   // height
-                     0,                   // border
-                     GL_RGB,              // external format
-                     GL_UNSIGNED_BYTE,    // external type
-                     lut);                // LUT data
-        check_gl("Texture create");
+        texrange = textureValueRange(info->pixelType);
+
+        // The LUT is shared by all contexts in the share group.
+        lutid = SharedResources::get().lut();
       }
 
       void
@@ -424,23 +374,131 @@ namespace ome
         image_elements.allocate(square_elements.data(), sizeof(GLushort) * square_elements.size());
       }
 
-      void
+      bool
       Image2D::setPlane(ome::files::dimension_size_type plane)
+      {
+        return setPlane(plane, std::shared_ptr<ome::files::VariantPixelBuffer>());
+      }
+
+      bool
+      Image2D::setPlane(ome::files::dimension_size_type                  plane,
+                        std::shared_ptr<ome::files::VariantPixelBuffer> pixels)
       {
         if (this->plane != plane)
           {
-            TextureProperties tprop(*reader, series);
-
-            ome::files::VariantPixelBuffer buf;
-            ome::files::dimension_size_type oldseries = reader->getSeries();
-            reader->setSeries(series);
-            reader->openBytes(plane, buf);
-            reader->setSeries(oldseries);
-
-            GLSetBufferVisitor v(textureid, tprop);
-            ome::compat::visit(v, buf.vbuffer());
+            TraceScope trace("Image2D::setPlane", "render");
+            SharedResources& resources(SharedResources::get());
+
+            // Reuse the texture if this plane has been uploaded
+            // previously by any view in the share group.
+            std::shared_ptr<Texture> cached(resources.findPlane(reader, series, plane));
+            if (!cached)
+              {
+                TextureProperties tprop(*info);
+
+                std::shared_ptr<ome::files::VariantPixelBuffer> buf(pixels);
+                // Uncompressed planes are uploaded directly from the
+                // file mapping.
+                if (!buf)
+                  {
+                    TraceScope read_trace("mapPlane", "read");
+                    buf = mapPlane(reader, series, plane);
+                  }
+                if (!buf)
+                  {
+                    TraceScope read_trace("FormatReader::openBytes", "read");
+                    buf = std::make_shared<ome::files::VariantPixelBuffer>();
+                    if (pool)
+                      {
+                        // Never wait for readers in use by background
+                        // tasks; keep the current plane instead.
+                        ReaderPool::Lease lease(pool->tryAcquire(series));
+                        if (!lease)
+                          return false;
+                        lease->openBytes(plane, *buf);
+                      }
+                    else
+                      {
+                        const ome::files::dimension_size_type oldseries = reader->getSeries();
+                        if (oldseries != series)
+                          reader->setSeries(series);
+                        reader->openBytes(plane, *buf);
+                        if (oldseries != series)
+                          reader->setSeries(oldseries);
+                      }
+                  }
+
+                unsigned int id = 0;
+                glGenTextures(1, &id);
+                glBindTexture(GL_TEXTURE_2D, id);
+                check_gl("Bind texture");
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, tprop.min_filter);
+                check_gl("Set texture min filter");
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, tprop.mag_filter);
+                check_gl("Set texture mag filter");
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                check_gl("Set texture wrap s");
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                check_gl("Set texture wrap t");
+
+                glTexImage2D(GL_TEXTURE_2D,         // target
+                             0,                     // level, 0 = base, no minimap,
+                             tprop.internal_format, // internal format
+                             tprop.w,               // width
+                             tprop.h,               // height
+                             0,                     // border
+                             tprop.external_format, // external format
+                             tprop.external_type,   // external type
+                             0);                    // no image data at this point
+                check_gl("Texture create");
+
+                GLSetBufferVisitor v(id, tprop);
+                ome::compat::visit(v, buf->vbuffer());
+
+                // Base level plus any mipmaps, and the retained pixel data.
+                BufferSizeVisitor bv;
+                ome::compat::visit(bv, buf->vbuffer());
+                std::size_t size = tprop.w * tprop.h * texel_size(tprop.internal_format);
+                if (tprop.mipmaps)
+                  size = (size * 4) / 3;
+                size += bv.size;
+                cached = std::make_shared<Texture>(resources.shareGroup(), id, size);
+                cached->setPixels(buf);
+                resources.insertPlane(reader, series, plane, cached);
+              }
+
+            planetexture = cached;
+            textureid = cached->id();
           }
         this->plane = plane;
+        return true;
+      }
+
+      ome::files::dimension_size_type
+      Image2D::getPlane() const
+      {
+        return plane;
+      }
+
+      std::shared_ptr<const ome::files::VariantPixelBuffer>
+      Image2D::getPlaneBuffer() const
+      {
+        std::shared_ptr<const ome::files::VariantPixelBuffer> ret;
+        if (planetexture)
+          ret = planetexture->pixels();
+        return ret;
+      }
+
+      std::shared_ptr<ReaderPool>
+      Image2D::getReaderPool() const
+      {
+        return pool;
+      }
+
+      void
+      Image2D::setReaderPool(std::shared_ptr<ReaderPool> pool)
+      {
+        this->pool = pool;
       }
 
       const glm::vec3&
@@ -467,6 +525,18 @@ namespace ome
         texmax = max;
       }
 
+      int
+      Image2D::getLUTRow() const
+      {
+        return lutrow;
+      }
+
+      void
+      Image2D::setLUTRow(int row)
+      {
+        lutrow = row;
+      }
+
       unsigned int
       Image2D::texture()
       {
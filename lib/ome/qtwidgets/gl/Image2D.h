@@ -49,8 +49,11 @@
 
 #include <ome/files/Types.h>
 #include <ome/files/FormatReader.h>
+#include <ome/files/VariantPixelBuffer.h>
 
 #include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/ReaderPool.h>
+#include <ome/qtwidgets/SeriesInfo.h>
 
 namespace ome
 {
@@ -59,6 +62,8 @@ namespace ome
     namespace gl
     {
 
+      class Texture;
+
       /**
        * 2D (xy) image renderer.
        *
@@ -118,10 +123,78 @@ namespace ome
          * Set the plane to render.
          *
          * @param plane the plane number.
+         * @returns @c true if the plane was set, or @c false if it
+         * must be decoded and no pooled reader is idle.
          */
-        void
+        bool
         setPlane(ome::files::dimension_size_type plane);
 
+        /**
+         * Set the plane to render from decoded pixel data.
+         *
+         * If the plane is not already cached, the specified pixel
+         * data is uploaded rather than decoding the plane with the
+         * reader.  This permits planes to be decoded in advance, for
+         * example by a PlaneLoader.
+         *
+         * With a reader pool set, planes are decoded only if a
+         * pooled reader is idle, so that the caller never blocks on
+         * background tasks.  Otherwise the current plane and texture
+         * are kept, and the caller should provide the pixel data
+         * once decoded, for example by requesting the plane from a
+         * PlaneLoader.
+         *
+         * @param plane the plane number.
+         * @param pixels the decoded pixel data of the plane, or null
+         * to decode with the reader.
+         * @returns @c true if the plane was set, or @c false if it
+         * must be decoded and no pooled reader is idle.
+         */
+        bool
+        setPlane(ome::files::dimension_size_type                  plane,
+                 std::shared_ptr<ome::files::VariantPixelBuffer> pixels);
+
+        /**
+         * Get the current plane.
+         *
+         * @returns the plane number.
+         */
+        ome::files::dimension_size_type
+        getPlane() const;
+
+        /**
+         * Get the decoded pixel data for the current plane.
+         *
+         * The data is retained with the plane texture, so raw sample
+         * values may be inspected without reading back from the GPU.
+         *
+         * @returns the pixel data, or null if no plane is loaded.
+         */
+        std::shared_ptr<const ome::files::VariantPixelBuffer>
+        getPlaneBuffer() const;
+
+        /**
+         * Get the reader pool.
+         *
+         * @returns the reader pool, or null if planes are read with
+         * the image reader.
+         */
+        std::shared_ptr<ReaderPool>
+        getReaderPool() const;
+
+        /**
+         * Set the reader pool.
+         *
+         * Planes which were not provided by the caller and could not
+         * be mapped are read with an idle reader leased from the
+         * pool (see setPlane()).
+         *
+         * @param pool the reader pool, or null to read with the image
+         * reader.
+         */
+        void
+        setReaderPool(std::shared_ptr<ReaderPool> pool);
+
         /**
          * Get minimum limit for linear contrast.
          *
@@ -160,6 +233,23 @@ namespace ome
         void
         setMax(const glm::vec3& max);
 
+        /**
+         * Get the lookup table.
+         *
+         * @returns the row of the shared LUT texture.
+         */
+        int
+        getLUTRow() const;
+
+        /**
+         * Set the lookup table.
+         *
+         * @param row the row of the shared LUT texture; see
+         * standardLUTNames() for the available tables.
+         */
+        void
+        setLUTRow(int row);
+
         /**
          * Range of min/max adjustment for linear contrast.
          */
@@ -211,20 +301,30 @@ namespace ome
         QOpenGLBuffer image_texcoords;
         /// The image elements.
         QOpenGLBuffer image_elements;
-        /// The identifier of the texture owned and used by this object.
+        /// The texture for the current plane (shared with the plane cache).
+        std::shared_ptr<Texture> planetexture;
+        /// The identifier of the texture for the current plane.
         unsigned int textureid;
-        /// The identifier of the LUTs owned and used by this object.
+        /// The identifier of the LUTs used by this object (shared).
         unsigned int lutid;
+        /// The LUT texture row to use.
+        int lutrow;
         /// Linear contrast minimum limits.
         glm::vec3 texmin;
         /// Linear contrast maximum limits.
         glm::vec3 texmax;
         /// Linear contrast correction multipliers.
         glm::vec3 texcorr;
+        /// Sample value corresponding to a normalized contrast limit of 1.
+        double texrange;
         /// The image reader.
         std::shared_ptr<ome::files::FormatReader> reader;
         /// The image series.
         ome::files::dimension_size_type series;
+        /// Pool of readers for decoding planes (optional).
+        std::shared_ptr<ReaderPool> pool;
+        /// Metadata of the image series.
+        std::shared_ptr<const SeriesInfo> info;
         /// The current image plane.
         ome::files::dimension_size_type plane;
       };
@@ -0,0 +1,300 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <ome/qtwidgets/SeriesInfo.h>
+#include <ome/qtwidgets/gl/Overlay2D.h>
+#include <ome/qtwidgets/gl/Util.h>
+
+namespace
+{
+
+  /// Number of line segments used to draw an ellipse.
+  const unsigned int ellipse_segments = 32;
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+
+      Overlay2D::Overlay2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                           ome::files::dimension_size_type            series,
+                           QObject                                   *parent):
+        QObject(parent),
+        vertices(),
+        shape_vertices(QOpenGLBuffer::VertexBuffer),
+        ranges(),
+        index(),
+        firsts(),
+        counts(),
+        view(std::numeric_limits<float>::quiet_NaN()),
+        visible(0),
+        size(),
+        reader(reader),
+        series(series),
+        plane(-1),
+        hits()
+      {
+        initializeOpenGLFunctions();
+
+        std::shared_ptr<const SeriesInfo> info(SeriesInfo::get(reader, series));
+        size = glm::vec2(info->sizeX, info->sizeY);
+      }
+
+      Overlay2D::~Overlay2D()
+      {
+      }
+
+      void
+      Overlay2D::create()
+      {
+        vertices.create();
+
+        shape_vertices.create();
+        shape_vertices.setUsagePattern(QOpenGLBuffer::StaticDraw);
+      }
+
+      void
+      Overlay2D::setPlane(ome::files::dimension_size_type plane)
+      {
+        if (this->plane != plane)
+          {
+            std::vector<OverlayShape> shapes;
+
+            const SeriesInfo::Coords& zct(SeriesInfo::get(reader, series)->getZCTCoords(plane));
+            std::shared_ptr<ome::xml::meta::MetadataRetrieve> meta
+              (std::dynamic_pointer_cast<ome::xml::meta::MetadataRetrieve>(reader->getMetadataStore()));
+            if (meta)
+              shapes = overlayShapes(*meta, series, zct[0], zct[1], zct[2]);
+
+            setShapes(shapes);
+            this->plane = plane;
+          }
+      }
+
+      // No switch default to avoid -Wunreachable-code errors.
+      // However, this then makes -Wswitch-default complain.  Disable
+      // temporarily.
+#ifdef __GNUC__
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wswitch-default"
+#endif
+
+      void
+      Overlay2D::setShapes(const std::vector<OverlayShape>& shapes)
+      {
+        std::vector<GLfloat> verts;
+        std::vector<glm::vec4> bounds;
+        ranges.clear();
+        ranges.reserve(shapes.size());
+        bounds.reserve(shapes.size());
+
+        for (const auto& shape : shapes)
+          {
+            if (shape.points.empty())
+              continue;
+
+            // Outline in image coordinates.
+            std::vector<glm::vec2> points;
+            Batch batch = BATCH_LINE_LOOP;
+
+            switch (shape.type)
+              {
+              case OverlayShape::POINT:
+                batch = BATCH_POINTS;
+                points.push_back(shape.points[0]);
+                break;
+              case OverlayShape::LINE:
+              case OverlayShape::POLYLINE:
+                batch = BATCH_LINE_STRIP;
+                points = shape.points;
+                break;
+              case OverlayShape::POLYGON:
+                points = shape.points;
+                break;
+              case OverlayShape::RECTANGLE:
+                if (shape.points.size() >= 2)
+                  {
+                    const glm::vec2& p(shape.points[0]);
+                    const glm::vec2& s(shape.points[1]);
+                    points.push_back(p);
+                    points.push_back(glm::vec2(p.x + s.x, p.y));
+                    points.push_back(p + s);
+                    points.push_back(glm::vec2(p.x, p.y + s.y));
+                  }
+                break;
+              case OverlayShape::ELLIPSE:
+                if (shape.points.size() >= 2)
+                  {
+                    const glm::vec2& c(shape.points[0]);
+                    const glm::vec2& r(shape.points[1]);
+                    for (unsigned int i = 0; i < ellipse_segments; ++i)
+                      {
+                        float a = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(ellipse_segments);
+                        points.push_back(c + r * glm::vec2(std::cos(a), std::sin(a)));
+                      }
+                  }
+                break;
+              }
+
+            if (points.empty())
+              continue;
+
+            Range range;
+            range.batch = batch;
+            range.first = static_cast<GLint>(verts.size() / 6);
+            range.count = static_cast<GLsizei>(points.size());
+            ranges.push_back(range);
+
+            glm::vec4 box(std::numeric_limits<float>::max(),
+                          std::numeric_limits<float>::max(),
+                          -std::numeric_limits<float>::max(),
+                          -std::numeric_limits<float>::max());
+            for (const auto& p : points)
+              {
+                // Image to world coordinates.
+                glm::vec2 w(p.x - (size.x / 2.0f), (size.y / 2.0f) - p.y);
+                verts.push_back(w.x);
+                verts.push_back(w.y);
+                verts.push_back(shape.colour.r);
+                verts.push_back(shape.colour.g);
+                verts.push_back(shape.colour.b);
+                verts.push_back(shape.colour.a);
+                box[0] = std::min(box[0], w.x);
+                box[1] = std::min(box[1], w.y);
+                box[2] = std::max(box[2], w.x);
+                box[3] = std::max(box[3], w.y);
+              }
+            bounds.push_back(box);
+          }
+
+        vertices.bind();
+        shape_vertices.bind();
+        shape_vertices.allocate(verts.data(),
+                                static_cast<int>(sizeof(GLfloat) * verts.size()));
+        shape_vertices.release();
+        vertices.release();
+
+        index.build(bounds);
+
+        // Force culling on next render.
+        view = glm::vec4(std::numeric_limits<float>::quiet_NaN());
+        for (auto& f : firsts)
+          f.clear();
+        for (auto& c : counts)
+          c.clear();
+        visible = 0;
+      }
+
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif
+
+      std::size_t
+      Overlay2D::getShapeCount() const
+      {
+        return ranges.size();
+      }
+
+      std::size_t
+      Overlay2D::getVisibleCount() const
+      {
+        return visible;
+      }
+
+      void
+      Overlay2D::cull(const glm::mat4& mvp)
+      {
+        // World bounds of the view, from the normalised device
+        // coordinates of the viewport corners.
+        glm::mat4 inv(glm::inverse(mvp));
+        glm::vec4 bounds(std::numeric_limits<float>::max(),
+                         std::numeric_limits<float>::max(),
+                         -std::numeric_limits<float>::max(),
+                         -std::numeric_limits<float>::max());
+        const std::array<glm::vec2, 4> corners
+          {
+            {
+              glm::vec2(-1.0f, -1.0f),
+              glm::vec2( 1.0f, -1.0f),
+              glm::vec2( 1.0f,  1.0f),
+              glm::vec2(-1.0f,  1.0f)
+            }
+          };
+        for (const auto& c : corners)
+          {
+            glm::vec4 w(inv * glm::vec4(c, 0.0f, 1.0f));
+            w /= w.w;
+            bounds[0] = std::min(bounds[0], w.x);
+            bounds[1] = std::min(bounds[1], w.y);
+            bounds[2] = std::max(bounds[2], w.x);
+            bounds[3] = std::max(bounds[3], w.y);
+          }
+
+        if (bounds == view)
+          return;
+        view = bounds;
+
+        hits.clear();
+        index.query(view, hits);
+        // Draw in shape order for consistent overlap and locality.
+        std::sort(hits.begin(), hits.end());
+
+        for (auto& f : firsts)
+          f.clear();
+        for (auto& c : counts)
+          c.clear();
+        for (const auto& i : hits)
+          {
+            const Range& range(ranges[i]);
+            firsts[range.batch].push_back(range.first);
+            counts[range.batch].push_back(range.count);
+          }
+        visible = hits.size();
+      }
+
+    }
+  }
+}
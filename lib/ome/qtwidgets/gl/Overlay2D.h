@@ -0,0 +1,232 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GL_OVERLAY2D_H
+#define OME_QTWIDGETS_GL_OVERLAY2D_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtGui/QOpenGLVertexArrayObject>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QOpenGLFunctions_3_3_Core>
+
+#include <ome/files/Types.h>
+#include <ome/files/FormatReader.h>
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/OverlayShape.h>
+#include <ome/qtwidgets/QuadTree.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+
+      /**
+       * 2D (xy) overlay renderer.
+       *
+       * Draws ROI shapes (points, lines, polylines, polygons,
+       * rectangles and ellipses) over the specified image.
+       *
+       * All shapes are tessellated once, when set, into a single
+       * vertex buffer.  Shape bounds are held in a quadtree, which is
+       * used to cull shapes against the view on each frame; the
+       * visible shapes are then drawn with one multi-draw call per
+       * primitive type.  The per-frame cost hence scales with the
+       * number of visible shapes rather than the total number of
+       * shapes.
+       */
+      class Overlay2D : public QObject,
+                        protected QOpenGLFunctions_3_3_Core
+      {
+        Q_OBJECT
+
+      public:
+        /**
+         * Create a 2D overlay.
+         *
+         * The size and position will be taken from the specified image.
+         *
+         * @param reader the image reader.
+         * @param series the image series.
+         * @param parent the parent of this object.
+         */
+        explicit Overlay2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                           ome::files::dimension_size_type            series,
+                           QObject                                   *parent = 0);
+
+        /// Destructor.
+        virtual
+        ~Overlay2D() = 0;
+
+        /**
+         * Create GL buffers.
+         *
+         * @note Requires a valid GL context.  Must be called before
+         * rendering.
+         */
+        virtual
+        void
+        create();
+
+        /**
+         * Set the plane to render.
+         *
+         * The shapes of the ROIs linked to the image are taken from
+         * the reader metadata, and replace any existing shapes.
+         *
+         * @param plane the plane number.
+         *
+         * @note Requires a valid GL context.
+         */
+        void
+        setPlane(ome::files::dimension_size_type plane);
+
+        /**
+         * Set the shapes to render.
+         *
+         * @param shapes the shapes, in image pixel coordinates.
+         *
+         * @note Requires a valid GL context.
+         */
+        void
+        setShapes(const std::vector<OverlayShape>& shapes);
+
+        /**
+         * Get the number of shapes.
+         *
+         * @returns the shape count.
+         */
+        std::size_t
+        getShapeCount() const;
+
+        /**
+         * Get the number of shapes visible in the last frame.
+         *
+         * @returns the visible shape count.
+         */
+        std::size_t
+        getVisibleCount() const;
+
+        /**
+         * Render the overlay.
+         *
+         * @param mvp the model view projection matrix.
+         */
+        virtual
+        void
+        render(const glm::mat4& mvp) = 0;
+
+      protected:
+        /// Primitive batches.
+        enum Batch
+          {
+            BATCH_LINE_LOOP,  ///< Closed outlines.
+            BATCH_LINE_STRIP, ///< Open lines.
+            BATCH_POINTS,     ///< Points.
+            BATCH_COUNT       ///< Number of batches.
+          };
+
+        /// Vertex range of a single shape.
+        struct Range
+        {
+          /// Primitive batch.
+          Batch batch;
+          /// First vertex.
+          GLint first;
+          /// Vertex count.
+          GLsizei count;
+        };
+
+        /**
+         * Cull shapes against the view.
+         *
+         * The visible shape ranges are placed in firsts and counts.
+         * The result is cached until the view or shapes change.
+         *
+         * @param mvp the model view projection matrix.
+         */
+        void
+        cull(const glm::mat4& mvp);
+
+        /// The vertex array.
+        QOpenGLVertexArrayObject vertices;
+        /// The vertices for all shapes (x, y, r, g, b, a).
+        QOpenGLBuffer shape_vertices;
+        /// Vertex range of each shape.
+        std::vector<Range> ranges;
+        /// Spatial index of shape bounds (world coordinates).
+        QuadTree index;
+        /// Visible shape first vertices, per batch.
+        std::array<std::vector<GLint>, BATCH_COUNT> firsts;
+        /// Visible shape vertex counts, per batch.
+        std::array<std::vector<GLsizei>, BATCH_COUNT> counts;
+        /// View bounds of the last cull.
+        glm::vec4 view;
+        /// Number of shapes visible in the last frame.
+        std::size_t visible;
+        /// Image size.
+        glm::vec2 size;
+        /// The image reader.
+        std::shared_ptr<ome::files::FormatReader> reader;
+        /// The image series.
+        ome::files::dimension_size_type series;
+        /// The current plane.
+        ome::files::dimension_size_type plane;
+
+      private:
+        /// Scratch buffer for culling.
+        std::vector<QuadTree::index_type> hits;
+      };
+
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GL_OVERLAY2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
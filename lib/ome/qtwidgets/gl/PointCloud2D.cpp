@@ -0,0 +1,517 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include <QtCore/QFile>
+
+#include <ome/qtwidgets/SeriesInfo.h>
+#include <ome/qtwidgets/Trace.h>
+#include <ome/qtwidgets/gl/PointCloud2D.h>
+#include <ome/qtwidgets/gl/Util.h>
+
+namespace
+{
+
+  /// Number of spatial grid cells in x and y.
+  const int grid_cells = 64;
+
+  /// Number of points binned per chunk.
+  const std::size_t chunk_points = 1 << 20;
+
+  /// Maximum number of binned chunks awaiting upload.
+  const std::size_t max_ready_chunks = 4;
+
+  /// Maximum number of chunks uploaded per frame.
+  const std::size_t frame_chunks = 2;
+
+  /**
+   * Get the grid cell of a coordinate.
+   *
+   * Coordinates outside the image are placed in the edge cells.
+   *
+   * @param v the coordinate (world).
+   * @param extent the image size in this dimension.
+   * @returns the cell index.
+   */
+  int
+  cell(float v,
+       float extent)
+  {
+    int c = static_cast<int>(std::floor(((v / extent) + 0.5f) * static_cast<float>(grid_cells)));
+    return std::min(std::max(c, 0), grid_cells - 1);
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+
+      PointCloud2D::PointCloud2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                                 ome::files::dimension_size_type            series,
+                                 QObject                                   *parent):
+        QObject(parent),
+        vertices(),
+        point_vertices(QOpenGLBuffer::VertexBuffer),
+        points(0),
+        chunks(0),
+        cellfirsts(),
+        cellcounts(),
+        firsts(),
+        counts(),
+        view(std::numeric_limits<float>::quiet_NaN()),
+        visible(0),
+        densityThreshold(0.25f),
+        densityMax(50.0f),
+        colour(1.0f, 0.0f, 1.0f, 0.8f),
+        pointSize(4.0f),
+        size(),
+        reader(reader),
+        series(series),
+        loader(),
+        loadMutex(),
+        loadCondition(),
+        ready(),
+        loadStopping(false),
+        loadComplete(true)
+      {
+        initializeOpenGLFunctions();
+
+        std::shared_ptr<const SeriesInfo> info(SeriesInfo::get(reader, series));
+        size = glm::vec2(info->sizeX, info->sizeY);
+      }
+
+      PointCloud2D::~PointCloud2D()
+      {
+        stopLoading();
+      }
+
+      void
+      PointCloud2D::create()
+      {
+        vertices.create();
+
+        point_vertices.create();
+        point_vertices.setUsagePattern(QOpenGLBuffer::StaticDraw);
+      }
+
+      bool
+      PointCloud2D::load(const QString& filename,
+                         unsigned int   columns,
+                         unsigned int   xcolumn,
+                         unsigned int   ycolumn)
+      {
+        clear();
+
+        if (xcolumn >= columns || ycolumn >= columns)
+          return false;
+
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly))
+          {
+            std::cerr << "PointCloud2D: Failed to open " << filename.toStdString() << std::endl;
+            return false;
+          }
+
+        const std::size_t rowsize = sizeof(float) * columns;
+        const std::size_t rows = static_cast<std::size_t>(file.size()) / rowsize;
+        if (!rows)
+          return true;
+
+        // Buffer sizes and vertex offsets are int.
+        if (rows > static_cast<std::size_t>(std::numeric_limits<int>::max()) / sizeof(glm::vec2))
+          {
+            std::cerr << "PointCloud2D: " << filename.toStdString() << " has " << rows
+                      << " points; at most " << std::numeric_limits<int>::max() / sizeof(glm::vec2)
+                      << " are supported" << std::endl;
+            return false;
+          }
+
+        const std::size_t ncells = grid_cells * grid_cells;
+        const std::size_t nchunks = (rows + chunk_points - 1) / chunk_points;
+        cellfirsts.assign(nchunks * ncells, 0);
+        cellcounts.assign(nchunks * ncells, 0);
+
+        vertices.bind();
+        point_vertices.bind();
+        point_vertices.allocate(static_cast<int>(sizeof(glm::vec2) * rows));
+        point_vertices.release();
+        vertices.release();
+
+        loadStopping = false;
+        loadComplete = false;
+        loader = std::thread(&PointCloud2D::bin, this, filename, rows, columns, xcolumn, ycolumn);
+
+        return true;
+      }
+
+      void
+      PointCloud2D::bin(QString      filename,
+                        std::size_t  rows,
+                        unsigned int columns,
+                        unsigned int xcolumn,
+                        unsigned int ycolumn)
+      {
+        setTraceThreadName("PointCloud2D");
+
+        QFile file(filename);
+        const std::size_t rowsize = sizeof(float) * columns;
+        const uchar *table = 0;
+        if (file.open(QIODevice::ReadOnly))
+          table = file.map(0, static_cast<qint64>(rows * rowsize));
+        if (!table)
+          {
+            std::cerr << "PointCloud2D: Failed to map " << filename.toStdString() << std::endl;
+            binningFinished();
+            return;
+          }
+
+        const std::size_t ncells = grid_cells * grid_cells;
+        const std::size_t nchunks = (rows + chunk_points - 1) / chunk_points;
+        std::vector<glm::vec2> coords;
+        std::vector<int> cells;
+        std::vector<GLsizei> offsets(ncells);
+
+        for (std::size_t c = 0; c < nchunks; ++c)
+          {
+            TraceScope trace("PointCloud2D::bin", "convert");
+
+            Chunk chunk;
+            chunk.start = c * chunk_points;
+            const std::size_t n = std::min(chunk_points, rows - chunk.start);
+            chunk.counts.assign(ncells, 0);
+
+            // Read and bin the chunk.
+            coords.resize(n);
+            cells.resize(n);
+            for (std::size_t i = 0; i < n; ++i)
+              {
+                const uchar *row = table + ((chunk.start + i) * rowsize);
+                float x, y;
+                std::memcpy(&x, row + (sizeof(float) * xcolumn), sizeof(float));
+                std::memcpy(&y, row + (sizeof(float) * ycolumn), sizeof(float));
+                // Image to world coordinates.
+                glm::vec2 w(x - (size.x / 2.0f), (size.y / 2.0f) - y);
+                coords[i] = w;
+                cells[i] = (cell(w.y, size.y) * grid_cells) + cell(w.x, size.x);
+                ++chunk.counts[static_cast<std::size_t>(cells[i])];
+              }
+
+            // Counting sort by cell.
+            GLsizei offset = 0;
+            for (std::size_t i = 0; i < ncells; ++i)
+              {
+                offsets[i] = offset;
+                offset += chunk.counts[i];
+              }
+            chunk.coords.resize(n);
+            for (std::size_t i = 0; i < n; ++i)
+              chunk.coords[static_cast<std::size_t>(offsets[static_cast<std::size_t>(cells[i])]++)] = coords[i];
+
+            {
+              // Limit the binned chunks held in memory.
+              std::unique_lock<std::mutex> lock(loadMutex);
+              loadCondition.wait(lock, [this]{ return loadStopping || ready.size() < max_ready_chunks; });
+              if (loadStopping)
+                break;
+              ready.push_back(std::move(chunk));
+            }
+            loadCondition.notify_all();
+            emit chunkReady();
+          }
+
+        file.unmap(const_cast<uchar *>(table));
+        binningFinished();
+      }
+
+      void
+      PointCloud2D::binningFinished()
+      {
+        {
+          std::lock_guard<std::mutex> lock(loadMutex);
+          loadComplete = true;
+        }
+        loadCondition.notify_all();
+      }
+
+      void
+      PointCloud2D::upload()
+      {
+        std::deque<Chunk> uploads;
+        {
+          std::lock_guard<std::mutex> lock(loadMutex);
+          while (!ready.empty() && uploads.size() < frame_chunks)
+            {
+              uploads.push_back(std::move(ready.front()));
+              ready.pop_front();
+            }
+        }
+        if (uploads.empty())
+          return;
+        loadCondition.notify_all();
+
+        TraceScope trace("PointCloud2D::upload", "upload");
+
+        const std::size_t ncells = grid_cells * grid_cells;
+
+        vertices.bind();
+        point_vertices.bind();
+        for (const auto& chunk : uploads)
+          {
+            GLsizei *ccounts = &cellcounts[chunks * ncells];
+            GLint *cfirsts = &cellfirsts[chunks * ncells];
+            GLint first = static_cast<GLint>(chunk.start);
+            for (std::size_t c = 0; c < ncells; ++c)
+              {
+                ccounts[c] = chunk.counts[c];
+                cfirsts[c] = first;
+                first += chunk.counts[c];
+              }
+
+            point_vertices.write(static_cast<int>(sizeof(glm::vec2) * chunk.start),
+                                 chunk.coords.data(),
+                                 static_cast<int>(sizeof(glm::vec2) * chunk.coords.size()));
+
+            ++chunks;
+            points += chunk.coords.size();
+          }
+        point_vertices.release();
+        vertices.release();
+
+        // Invalidate the cull.
+        view = glm::vec4(std::numeric_limits<float>::quiet_NaN());
+      }
+
+      void
+      PointCloud2D::stopLoading()
+      {
+        {
+          std::lock_guard<std::mutex> lock(loadMutex);
+          loadStopping = true;
+        }
+        loadCondition.notify_all();
+        if (loader.joinable())
+          loader.join();
+        ready.clear();
+        loadComplete = true;
+      }
+
+      bool
+      PointCloud2D::isLoading() const
+      {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        return !loadComplete || !ready.empty();
+      }
+
+      void
+      PointCloud2D::finishLoading()
+      {
+        while (true)
+          {
+            upload();
+            std::unique_lock<std::mutex> lock(loadMutex);
+            if (loadComplete && ready.empty())
+              break;
+            loadCondition.wait(lock, [this]{ return loadComplete || !ready.empty(); });
+          }
+      }
+
+      void
+      PointCloud2D::clear()
+      {
+        stopLoading();
+        points = 0;
+        chunks = 0;
+        cellfirsts.clear();
+        cellcounts.clear();
+        firsts.clear();
+        counts.clear();
+        visible = 0;
+        view = glm::vec4(std::numeric_limits<float>::quiet_NaN());
+      }
+
+      std::size_t
+      PointCloud2D::getPointCount() const
+      {
+        return points;
+      }
+
+      bool
+      PointCloud2D::hasPendingChunks() const
+      {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        return !ready.empty();
+      }
+
+      std::size_t
+      PointCloud2D::getVisibleCount() const
+      {
+        return visible;
+      }
+
+      float
+      PointCloud2D::getDensityThreshold() const
+      {
+        return densityThreshold;
+      }
+
+      void
+      PointCloud2D::setDensityThreshold(float threshold)
+      {
+        densityThreshold = threshold;
+      }
+
+      float
+      PointCloud2D::getDensityMax() const
+      {
+        return densityMax;
+      }
+
+      void
+      PointCloud2D::setDensityMax(float max)
+      {
+        densityMax = max;
+      }
+
+      const glm::vec4&
+      PointCloud2D::getColour() const
+      {
+        return colour;
+      }
+
+      void
+      PointCloud2D::setColour(const glm::vec4& colour)
+      {
+        this->colour = colour;
+      }
+
+      float
+      PointCloud2D::getPointSize() const
+      {
+        return pointSize;
+      }
+
+      void
+      PointCloud2D::setPointSize(float size)
+      {
+        pointSize = size;
+      }
+
+      void
+      PointCloud2D::cull(const glm::mat4& mvp)
+      {
+        // World bounds of the view, from the normalised device
+        // coordinates of the viewport corners.
+        glm::mat4 inv(glm::inverse(mvp));
+        glm::vec4 bounds(std::numeric_limits<float>::max(),
+                         std::numeric_limits<float>::max(),
+                         -std::numeric_limits<float>::max(),
+                         -std::numeric_limits<float>::max());
+        const std::array<glm::vec2, 4> corners
+          {
+            {
+              glm::vec2(-1.0f, -1.0f),
+              glm::vec2( 1.0f, -1.0f),
+              glm::vec2( 1.0f,  1.0f),
+              glm::vec2(-1.0f,  1.0f)
+            }
+          };
+        for (const auto& c : corners)
+          {
+            glm::vec4 w(inv * glm::vec4(c, 0.0f, 1.0f));
+            w /= w.w;
+            bounds[0] = std::min(bounds[0], w.x);
+            bounds[1] = std::min(bounds[1], w.y);
+            bounds[2] = std::max(bounds[2], w.x);
+            bounds[3] = std::max(bounds[3], w.y);
+          }
+
+        if (bounds == view)
+          return;
+        view = bounds;
+
+        firsts.clear();
+        counts.clear();
+        visible = 0;
+        if (!points)
+          return;
+
+        const int x0 = cell(view[0], size.x);
+        const int x1 = cell(view[2], size.x);
+        const int y0 = cell(view[1], size.y);
+        const int y1 = cell(view[3], size.y);
+        const std::size_t ncells = grid_cells * grid_cells;
+
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+          {
+            const GLint *cfirsts = &cellfirsts[chunk * ncells];
+            const GLsizei *ccounts = &cellcounts[chunk * ncells];
+            for (int y = y0; y <= y1; ++y)
+              {
+                for (int x = x0; x <= x1; ++x)
+                  {
+                    const int c = (y * grid_cells) + x;
+                    if (!ccounts[c])
+                      continue;
+                    // Cells adjacent in a row are contiguous; merge.
+                    if (!firsts.empty() &&
+                        firsts.back() + counts.back() == cfirsts[c])
+                      counts.back() += ccounts[c];
+                    else
+                      {
+                        firsts.push_back(cfirsts[c]);
+                        counts.push_back(ccounts[c]);
+                      }
+                    visible += static_cast<std::size_t>(ccounts[c]);
+                  }
+              }
+          }
+      }
+
+    }
+  }
+}
@@ -0,0 +1,406 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GL_POINTCLOUD2D_H
+#define OME_QTWIDGETS_GL_POINTCLOUD2D_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtGui/QOpenGLVertexArrayObject>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QOpenGLFunctions_3_3_Core>
+
+#include <ome/files/Types.h>
+#include <ome/files/FormatReader.h>
+
+#include <ome/qtwidgets/glm.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+
+      /**
+       * 2D (xy) point cloud renderer.
+       *
+       * Draws point localisations (for example from single-molecule
+       * localisation microscopy) over the specified image.
+       *
+       * Localisations are read from a binary table of native-endian
+       * 32-bit floats, one row per point, with the x and y
+       * coordinates (in image pixels) in configurable columns.  The
+       * table is memory mapped and binned on a background thread in
+       * chunks; within each chunk, points are sorted into the cells
+       * of a uniform spatial grid covering the image, so that only
+       * the cells intersecting the view are drawn.  Binned chunks are
+       * uploaded to the GPU incrementally over successive frames.
+       *
+       * When zoomed in, points are drawn individually as round
+       * sprites.  When the visible point count exceeds a threshold
+       * number of points per viewport pixel, point density is
+       * instead accumulated into a float framebuffer and composited
+       * through a LUT.
+       */
+      class PointCloud2D : public QObject,
+                           protected QOpenGLFunctions_3_3_Core
+      {
+        Q_OBJECT
+
+      public:
+        /**
+         * Create a 2D point cloud.
+         *
+         * The size and position will be taken from the specified image.
+         *
+         * @param reader the image reader.
+         * @param series the image series.
+         * @param parent the parent of this object.
+         */
+        explicit PointCloud2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                              ome::files::dimension_size_type            series,
+                              QObject                                   *parent = 0);
+
+        /// Destructor.
+        virtual
+        ~PointCloud2D() = 0;
+
+        /**
+         * Create GL buffers.
+         *
+         * @note Requires a valid GL context.  Must be called before
+         * rendering.
+         */
+        virtual
+        void
+        create();
+
+        /**
+         * Load localisations from a binary table.
+         *
+         * Any existing points are replaced.  The table is binned on a
+         * background thread; chunkReady() is emitted as each chunk
+         * becomes available, and the chunks are uploaded by
+         * subsequent calls to render().
+         *
+         * The vertex data may not exceed INT_MAX bytes (about 268
+         * million points).
+         *
+         * @param filename the table file.
+         * @param columns the number of float columns per row.
+         * @param xcolumn the column containing the x coordinate.
+         * @param ycolumn the column containing the y coordinate.
+         * @returns @c true on success, or @c false if the file could
+         * not be opened, the columns are invalid or the table is too
+         * large.
+         *
+         * @note Requires a valid GL context.
+         */
+        bool
+        load(const QString& filename,
+             unsigned int   columns = 2,
+             unsigned int   xcolumn = 0,
+             unsigned int   ycolumn = 1);
+
+        /**
+         * Remove all points.
+         *
+         * @note Requires a valid GL context.
+         */
+        void
+        clear();
+
+        /**
+         * Get the number of points.
+         *
+         * @returns the number of points uploaded.
+         */
+        std::size_t
+        getPointCount() const;
+
+        /**
+         * Check if binned chunks are waiting to be uploaded.
+         *
+         * @returns @c true if further frames are needed to upload
+         * the chunks which are ready.
+         */
+        bool
+        hasPendingChunks() const;
+
+        /**
+         * Check if loading is in progress.
+         *
+         * @returns @c true if the table is still being binned, or
+         * binned chunks have not yet been uploaded.
+         */
+        bool
+        isLoading() const;
+
+        /**
+         * Upload binned chunks.
+         *
+         * A limited number of chunks are uploaded per call, to avoid
+         * stalling the frame.  This is called by render(), but may
+         * also be called to continue loading without drawing.
+         *
+         * @note Requires a valid GL context.
+         */
+        void
+        upload();
+
+        /**
+         * Wait for loading to complete.
+         *
+         * Blocks until the table has been binned, uploading the
+         * chunks as they become available, so that all points are
+         * drawn by the next call to render().
+         *
+         * @note Requires a valid GL context.
+         */
+        void
+        finishLoading();
+
+        /**
+         * Get the number of points drawn in the last frame.
+         *
+         * @returns the visible point count.
+         */
+        std::size_t
+        getVisibleCount() const;
+
+        /**
+         * Get density rendering threshold.
+         *
+         * @returns the threshold (visible points per viewport pixel).
+         */
+        float
+        getDensityThreshold() const;
+
+        /**
+         * Set density rendering threshold.
+         *
+         * @param threshold the threshold (visible points per viewport
+         * pixel) above which density is rendered in place of
+         * individual points.
+         */
+        void
+        setDensityThreshold(float threshold);
+
+        /**
+         * Get maximum density for the LUT.
+         *
+         * @returns the maximum density (points per pixel).
+         */
+        float
+        getDensityMax() const;
+
+        /**
+         * Set maximum density for the LUT.
+         *
+         * @param max the maximum density (points per pixel).
+         */
+        void
+        setDensityMax(float max);
+
+        /**
+         * Get point colour.
+         *
+         * @returns the RGBA colour of individual points.
+         */
+        const glm::vec4&
+        getColour() const;
+
+        /**
+         * Set point colour.
+         *
+         * @param colour the RGBA colour of individual points.
+         */
+        void
+        setColour(const glm::vec4& colour);
+
+        /**
+         * Get point size.
+         *
+         * @returns the size of individual points (pixels).
+         */
+        float
+        getPointSize() const;
+
+        /**
+         * Set point size.
+         *
+         * @param size the size of individual points (pixels).
+         */
+        void
+        setPointSize(float size);
+
+        /**
+         * Render the point cloud.
+         *
+         * @param mvp the model view projection matrix.
+         */
+        virtual
+        void
+        render(const glm::mat4& mvp) = 0;
+
+      signals:
+        /**
+         * Signal a chunk of points has been binned.
+         *
+         * Emitted from the loading thread.
+         */
+        void
+        chunkReady();
+
+      protected:
+        /// Points binned by cell, ready for upload.
+        struct Chunk
+        {
+          /// First point of the chunk.
+          std::size_t start;
+          /// Point coordinates (world), sorted by cell.
+          std::vector<glm::vec2> coords;
+          /// Point count of each cell.
+          std::vector<GLsizei> counts;
+        };
+
+        /**
+         * Bin a table into chunks.
+         *
+         * Runs on the loading thread.
+         *
+         * @param filename the table file.
+         * @param rows the number of rows.
+         * @param columns the number of float columns per row.
+         * @param xcolumn the column containing the x coordinate.
+         * @param ycolumn the column containing the y coordinate.
+         */
+        void
+        bin(QString      filename,
+            std::size_t  rows,
+            unsigned int columns,
+            unsigned int xcolumn,
+            unsigned int ycolumn);
+
+        /// Mark binning as finished (loading thread).
+        void
+        binningFinished();
+
+        /// Stop and join the loading thread, discarding pending chunks.
+        void
+        stopLoading();
+
+        /**
+         * Cull grid cells against the view.
+         *
+         * The vertex ranges of the visible cells are placed in firsts
+         * and counts.  The result is cached until the view or points
+         * change.
+         *
+         * @param mvp the model view projection matrix.
+         */
+        void
+        cull(const glm::mat4& mvp);
+
+        /// The vertex array.
+        QOpenGLVertexArrayObject vertices;
+        /// The vertices for all points (x, y).
+        QOpenGLBuffer point_vertices;
+        /// Number of points uploaded.
+        std::size_t points;
+        /// Number of chunks uploaded.
+        std::size_t chunks;
+        /// First vertex of each cell of each chunk.
+        std::vector<GLint> cellfirsts;
+        /// Vertex count of each cell of each chunk.
+        std::vector<GLsizei> cellcounts;
+        /// Visible vertex range firsts.
+        std::vector<GLint> firsts;
+        /// Visible vertex range counts.
+        std::vector<GLsizei> counts;
+        /// View bounds of the last cull.
+        glm::vec4 view;
+        /// Number of points visible in the last frame.
+        std::size_t visible;
+        /// Density rendering threshold.
+        float densityThreshold;
+        /// Maximum density.
+        float densityMax;
+        /// Point colour.
+        glm::vec4 colour;
+        /// Point size.
+        float pointSize;
+        /// Image size.
+        glm::vec2 size;
+        /// The image reader.
+        std::shared_ptr<ome::files::FormatReader> reader;
+        /// The image series.
+        ome::files::dimension_size_type series;
+        /// Loading thread.
+        std::thread loader;
+        /// Lock for the loading state.
+        mutable std::mutex loadMutex;
+        /// Loading thread wakeup.
+        std::condition_variable loadCondition;
+        /// Chunks binned but not yet uploaded.
+        std::deque<Chunk> ready;
+        /// Stop loading?
+        bool loadStopping;
+        /// Binning finished?
+        bool loadComplete;
+      };
+
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GL_POINTCLOUD2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,308 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <algorithm>
+
+#include <ome/qtwidgets/LUT.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
+#include <ome/qtwidgets/gl/Util.h>
+
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+
+      Texture::Texture(QOpenGLContextGroup *group,
+                       unsigned int         id,
+                       std::size_t          size):
+        group(group),
+        textureid(id),
+        texturesize(size),
+        texturepixels()
+      {
+      }
+
+      Texture::~Texture()
+      {
+        if (textureid && group)
+          {
+            SharedResources *resources = group->findChild<SharedResources *>(QString(), Qt::FindDirectChildrenOnly);
+            if (resources)
+              resources->deleteTexture(textureid);
+          }
+      }
+
+      unsigned int
+      Texture::id() const
+      {
+        return textureid;
+      }
+
+      std::size_t
+      Texture::size() const
+      {
+        return texturesize;
+      }
+
+      std::shared_ptr<const ome::files::VariantPixelBuffer>
+      Texture::pixels() const
+      {
+        return texturepixels;
+      }
+
+      void
+      Texture::setPixels(std::shared_ptr<const ome::files::VariantPixelBuffer> pixels)
+      {
+        texturepixels = pixels;
+      }
+
+      bool
+      SharedResources::PlaneKey::operator< (const PlaneKey& rhs) const
+      {
+        if (reader != rhs.reader)
+          return reader < rhs.reader;
+        if (series != rhs.series)
+          return series < rhs.series;
+        return plane < rhs.plane;
+      }
+
+      SharedResources::SharedResources(QOpenGLContextGroup *group):
+        QObject(group),
+        group(group),
+        programs(),
+        luttexture(),
+        lutsize(0),
+        planes(),
+        planeorder(),
+        planesize(0),
+        planelimit(256 * 1024 * 1024),
+        deferred()
+      {
+        initializeOpenGLFunctions();
+      }
+
+      SharedResources::~SharedResources()
+      {
+        // Release textures while this object is still complete,
+        // since they call back to deleteTexture().
+        luttexture.reset();
+        planes.clear();
+        planeorder.clear();
+      }
+
+      SharedResources&
+      SharedResources::get(QOpenGLContext *context)
+      {
+        if (!context)
+          context = QOpenGLContext::currentContext();
+
+        QOpenGLContextGroup *group = context->shareGroup();
+        SharedResources *resources = group->findChild<SharedResources *>(QString(), Qt::FindDirectChildrenOnly);
+        if (!resources)
+          resources = new SharedResources(group);
+        resources->deleteDeferred();
+
+        return *resources;
+      }
+
+      unsigned int
+      SharedResources::lut()
+      {
+        if (!luttexture)
+          {
+            unsigned int lutid = 0;
+            glGenTextures(1, &lutid);
+            glBindTexture(GL_TEXTURE_1D_ARRAY, lutid);
+            check_gl("Bind texture");
+            glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            check_gl("Set texture min filter");
+            glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            check_gl("Set texture mag filter");
+            glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            check_gl("Set texture wrap s");
+
+            // As many entries as the hardware permits, up to one
+            // per 16-bit value.
+            GLint maxsize = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxsize);
+            lutsize = std::min<std::size_t>(65536U, static_cast<std::size_t>(std::max(maxsize, 256)));
+
+            const std::vector<std::string>& names(standardLUTNames());
+            std::vector<float> data;
+            data.reserve(lutsize * 4 * names.size());
+            for (const auto& name : names)
+              {
+                LUT lut(standardLUT(name, lutsize));
+                data.insert(data.end(), lut.data(), lut.data() + (lut.size() * 4));
+              }
+
+            glTexImage2D(GL_TEXTURE_1D_ARRAY,                   // target
+                         0,                                     // level, 0 = base, no minimap,
+                         GL_RGBA16F,                            // internal format
+                         static_cast<GLsizei>(lutsize),         // width
+                         static_cast<GLsizei>(names.size()),    // height (rows)
+                         0,                                     // border
+                         GL_RGBA,                               // external format
+                         GL_FLOAT,                              // external type
+                         data.data());                          // LUT data
+            check_gl("Texture create");
+
+            // 4 half float components per entry.
+            luttexture = std::make_shared<Texture>(group, lutid, lutsize * names.size() * 8);
+          }
+
+        return luttexture->id();
+      }
+
+      std::size_t
+      SharedResources::lutSize() const
+      {
+        return lutsize;
+      }
+
+      std::shared_ptr<Texture>
+      SharedResources::findPlane(const std::shared_ptr<ome::files::FormatReader>& reader,
+                                 ome::files::dimension_size_type                  series,
+                                 ome::files::dimension_size_type                  plane)
+      {
+        PlaneKey key = {reader.get(), series, plane};
+        std::map<PlaneKey, PlaneEntry>::iterator i = planes.find(key);
+        if (i == planes.end())
+          return std::shared_ptr<Texture>();
+
+        if (i->second.reader.lock() != reader)
+          {
+            // Stale entry from a destroyed reader at the same address.
+            planesize -= i->second.texture->size();
+            planeorder.erase(i->second.lru);
+            planes.erase(i);
+            return std::shared_ptr<Texture>();
+          }
+
+        // Mark as most recently used.
+        planeorder.splice(planeorder.begin(), planeorder, i->second.lru);
+        return i->second.texture;
+      }
+
+      void
+      SharedResources::insertPlane(const std::shared_ptr<ome::files::FormatReader>& reader,
+                                   ome::files::dimension_size_type                  series,
+                                   ome::files::dimension_size_type                  plane,
+                                   std::shared_ptr<Texture>                         texture)
+      {
+        PlaneKey key = {reader.get(), series, plane};
+        std::map<PlaneKey, PlaneEntry>::iterator i = planes.find(key);
+        if (i != planes.end())
+          {
+            planesize -= i->second.texture->size();
+            planeorder.erase(i->second.lru);
+            planes.erase(i);
+          }
+
+        planeorder.push_front(key);
+        PlaneEntry entry;
+        entry.reader = reader;
+        entry.texture = texture;
+        entry.lru = planeorder.begin();
+        planes.insert(std::make_pair(key, entry));
+        planesize += texture->size();
+
+        evict();
+      }
+
+      std::size_t
+      SharedResources::getPlaneCacheLimit() const
+      {
+        return planelimit;
+      }
+
+      void
+      SharedResources::setPlaneCacheLimit(std::size_t limit)
+      {
+        planelimit = limit;
+        evict();
+      }
+
+      void
+      SharedResources::deleteTexture(unsigned int id)
+      {
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if (context && context->shareGroup() == group)
+          context->functions()->glDeleteTextures(1, &id);
+        else
+          deferred.push_back(id);
+      }
+
+      QOpenGLContextGroup *
+      SharedResources::shareGroup() const
+      {
+        return group;
+      }
+
+      void
+      SharedResources::evict()
+      {
+        // Always retain the most recently used plane.
+        while (planesize > planelimit && planeorder.size() > 1)
+          {
+            std::map<PlaneKey, PlaneEntry>::iterator i = planes.find(planeorder.back());
+            planesize -= i->second.texture->size();
+            planes.erase(i);
+            planeorder.pop_back();
+          }
+      }
+
+      void
+      SharedResources::deleteDeferred()
+      {
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if (deferred.empty() || !context || context->shareGroup() != group)
+          return;
+
+        context->functions()->glDeleteTextures(static_cast<GLsizei>(deferred.size()), deferred.data());
+        deferred.clear();
+      }
+
+    }
+  }
+}
@@ -0,0 +1,368 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GL_SHAREDRESOURCES_H
+#define OME_QTWIDGETS_GL_SHAREDRESOURCES_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtGui/QOpenGLFunctions_3_3_Core>
+#include <QtGui/QOpenGLShaderProgram>
+
+#include <ome/files/Types.h>
+#include <ome/files/FormatReader.h>
+#include <ome/files/VariantPixelBuffer.h>
+
+QT_BEGIN_NAMESPACE
+class QOpenGLContext;
+class QOpenGLContextGroup;
+QT_END_NAMESPACE
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+
+      /**
+       * GL texture owned by a context share group.
+       *
+       * The texture is deleted on destruction if a context in the
+       * owning share group is current.  Otherwise its deletion is
+       * deferred until a context in the share group is next current
+       * (see SharedResources::deleteTexture()), or it is released
+       * with the share group.
+       *
+       * The decoded pixel data used to create the texture may
+       * optionally be retained with it, for CPU-side access to raw
+       * values without reading back from the GPU.
+       */
+      class Texture
+      {
+      public:
+        /**
+         * Create a texture.
+         *
+         * @param group the share group owning the texture.
+         * @param id the texture identifier.
+         * @param size the approximate size of the texture and any
+         * retained pixel data (bytes).
+         */
+        Texture(QOpenGLContextGroup *group,
+                unsigned int         id,
+                std::size_t          size);
+
+        /// Destructor.
+        ~Texture();
+
+        /**
+         * Get texture ID.
+         *
+         * @returns the texture ID.
+         */
+        unsigned int
+        id() const;
+
+        /**
+         * Get texture size.
+         *
+         * @returns the approximate size of the texture (bytes).
+         */
+        std::size_t
+        size() const;
+
+        /**
+         * Get retained pixel data.
+         *
+         * @returns the pixel data, or null if not retained.
+         */
+        std::shared_ptr<const ome::files::VariantPixelBuffer>
+        pixels() const;
+
+        /**
+         * Set retained pixel data.
+         *
+         * @param pixels the pixel data.
+         */
+        void
+        setPixels(std::shared_ptr<const ome::files::VariantPixelBuffer> pixels);
+
+      private:
+        Texture(const Texture&);
+        Texture& operator=(const Texture&);
+
+        /// The owning share group (null once destroyed).
+        QPointer<QOpenGLContextGroup> group;
+        /// The texture ID.
+        unsigned int textureid;
+        /// The texture size (bytes).
+        std::size_t texturesize;
+        /// Retained pixel data.
+        std::shared_ptr<const ome::files::VariantPixelBuffer> texturepixels;
+      };
+
+      /**
+       * GL resources shared between all contexts in a share group.
+       *
+       * Contexts in the same share group (see
+       * Qt::AA_ShareOpenGLContexts) may share shader programs and
+       * textures.  This registry holds a single instance of each
+       * shader program, the LUT textures, and a bounded cache of
+       * plane textures, so that additional views do not need to
+       * compile programs or allocate textures afresh.
+       *
+       * One instance exists per share group; it is destroyed with
+       * the share group.
+       *
+       * @note Not thread-safe; use from the thread owning the
+       * contexts only.
+       */
+      class SharedResources : public QObject,
+                              protected QOpenGLFunctions_3_3_Core
+      {
+        Q_OBJECT
+
+      public:
+        /**
+         * Get the shared resources for a context.
+         *
+         * @param context the context to query, or null to use the
+         * current context.
+         * @returns the resources of the context share group.
+         */
+        static SharedResources&
+        get(QOpenGLContext *context = 0);
+
+        /// Destructor.
+        ~SharedResources();
+
+        /**
+         * Get a shared shader program.
+         *
+         * The program is created and linked on first use.
+         *
+         * @tparam T the shader program type.
+         * @returns the shader program.
+         */
+        template<typename T>
+        std::shared_ptr<T>
+        program()
+        {
+          const std::string key(typeid(T).name());
+          std::map<std::string, std::shared_ptr<QOpenGLShaderProgram>>::const_iterator i = programs.find(key);
+          if (i != programs.end())
+            return std::static_pointer_cast<T>(i->second);
+
+          std::shared_ptr<T> p(std::make_shared<T>());
+          programs.insert(std::make_pair(key, std::static_pointer_cast<QOpenGLShaderProgram>(p)));
+          return p;
+        }
+
+        /**
+         * Get the LUT texture.
+         *
+         * The LUT is a GL_TEXTURE_1D_ARRAY created on first use,
+         * containing one row for each of the standard lookup tables
+         * (in the order of standardLUTNames()).  Each row has
+         * lutSize() entries, stored as GL_RGBA16F.
+         *
+         * @returns the texture ID.
+         */
+        unsigned int
+        lut();
+
+        /**
+         * Get the number of entries in each LUT texture row.
+         *
+         * @returns the LUT length, or zero if the LUT texture has not
+         * been created.
+         */
+        std::size_t
+        lutSize() const;
+
+        /**
+         * Get a cached plane texture.
+         *
+         * @param reader the image reader.
+         * @param series the image series.
+         * @param plane the image plane.
+         * @returns the texture, or null if not cached.
+         */
+        std::shared_ptr<Texture>
+        findPlane(const std::shared_ptr<ome::files::FormatReader>& reader,
+                  ome::files::dimension_size_type                  series,
+                  ome::files::dimension_size_type                  plane);
+
+        /**
+         * Add a plane texture to the cache.
+         *
+         * Least recently used textures will be evicted if the cache
+         * exceeds its size limit.  Evicted textures remain valid
+         * while still referenced elsewhere.
+         *
+         * @param reader the image reader.
+         * @param series the image series.
+         * @param plane the image plane.
+         * @param texture the texture to cache.
+         */
+        void
+        insertPlane(const std::shared_ptr<ome::files::FormatReader>& reader,
+                    ome::files::dimension_size_type                  series,
+                    ome::files::dimension_size_type                  plane,
+                    std::shared_ptr<Texture>                         texture);
+
+        /**
+         * Get the plane texture cache size limit.
+         *
+         * @returns the limit (bytes).
+         */
+        std::size_t
+        getPlaneCacheLimit() const;
+
+        /**
+         * Set the plane texture cache size limit.
+         *
+         * @param limit the limit (bytes).
+         */
+        void
+        setPlaneCacheLimit(std::size_t limit);
+
+        /**
+         * Delete a texture.
+         *
+         * The texture is deleted immediately if a context in the
+         * share group is current.  Otherwise deletion is deferred
+         * until get() is next called with a context in the share
+         * group current.
+         *
+         * @param id the texture ID.
+         */
+        void
+        deleteTexture(unsigned int id);
+
+        /**
+         * Get the owning share group.
+         *
+         * @returns the share group.
+         */
+        QOpenGLContextGroup *
+        shareGroup() const;
+
+      private:
+        /**
+         * Constructor.
+         *
+         * @param group the owning share group.
+         */
+        explicit SharedResources(QOpenGLContextGroup *group);
+
+        /// Evict plane textures until within the size limit.
+        void
+        evict();
+
+        /// Delete deferred textures if a context in the share group
+        /// is current.
+        void
+        deleteDeferred();
+
+        /// Plane cache key.
+        struct PlaneKey
+        {
+          /// Reader (used for identity only).
+          const ome::files::FormatReader *reader;
+          /// Series.
+          ome::files::dimension_size_type series;
+          /// Plane.
+          ome::files::dimension_size_type plane;
+
+          /// Ordering for map lookup.
+          bool
+          operator< (const PlaneKey& rhs) const;
+        };
+
+        /// Plane cache entry.
+        struct PlaneEntry
+        {
+          /// Reader; detects reuse of the address by a new reader.
+          std::weak_ptr<ome::files::FormatReader> reader;
+          /// The cached texture.
+          std::shared_ptr<Texture> texture;
+          /// Position in the LRU list.
+          std::list<PlaneKey>::iterator lru;
+        };
+
+        /// The owning share group.
+        QOpenGLContextGroup *group;
+        /// Shader programs by type.
+        std::map<std::string, std::shared_ptr<QOpenGLShaderProgram>> programs;
+        /// LUT texture.
+        std::shared_ptr<Texture> luttexture;
+        /// LUT texture row length.
+        std::size_t lutsize;
+        /// Plane textures.
+        std::map<PlaneKey, PlaneEntry> planes;
+        /// Plane texture use order (most recent first).
+        std::list<PlaneKey> planeorder;
+        /// Plane texture cache size (bytes).
+        std::size_t planesize;
+        /// Plane texture cache limit (bytes).
+        std::size_t planelimit;
+        /// Textures awaiting deletion.
+        std::vector<unsigned int> deferred;
+      };
+
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GL_SHAREDRESOURCES_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -36,7 +36,9 @@
  * #L%
  */
 
+#include <ome/qtwidgets/Trace.h>
 #include <ome/qtwidgets/gl/v33/V33Axis2D.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
 #include <ome/qtwidgets/gl/Util.h>
 
 #include <iostream>
@@ -54,7 +56,7 @@ namespace ome
                        ome::files::dimension_size_type                    series,
                        QObject                                           *parent):
           gl::Axis2D(reader, series, parent),
-          axis_shader(new glsl::v330::GLFlatShader2D(this))
+          axis_shader(SharedResources::get().program<glsl::v330::GLFlatShader2D>())
         {
         }
 
@@ -65,6 +67,8 @@ namespace ome
         void
         Axis2D::render(const glm::mat4& mvp)
         {
+          TraceScope trace("Axis2D::render", "shader");
+
           axis_shader->bind();
 
           vertices.bind();
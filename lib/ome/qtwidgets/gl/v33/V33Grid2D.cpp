@@ -36,7 +36,9 @@
  * #L%
  */
 
+#include <ome/qtwidgets/Trace.h>
 #include <ome/qtwidgets/gl/v33/V33Grid2D.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
 #include <ome/qtwidgets/gl/Util.h>
 
 #include <cmath>
@@ -54,7 +56,7 @@ namespace ome
                        ome::files::dimension_size_type                    series,
                        QObject                                           *parent):
           gl::Grid2D(reader, series, parent),
-          grid_shader(new glsl::v330::GLLineShader2D(this))
+          grid_shader(SharedResources::get().program<glsl::v330::GLGridShader2D>())
         {
         }
 
@@ -66,28 +68,22 @@ namespace ome
         Grid2D::render(const glm::mat4& mvp,
                        float zoom)
         {
+          TraceScope trace("Grid2D::render", "shader");
+
           grid_shader->bind();
 
           // Render grid
           grid_shader->setModelViewProjection(mvp);
           grid_shader->setZoom(zoom);
+          grid_shader->setExtent(xlim, ylim);
+          grid_shader->setMajor(lmajor);
 
+          // Full-screen triangle; vertices are generated in the shader.
           vertices.bind();
-
-          grid_shader->enableCoords();
-          grid_shader->setCoords(grid_vertices, 0, 3, 6 * sizeof(GLfloat));
-
-          grid_shader->enableColour();
-          grid_shader->setColour(grid_vertices, reinterpret_cast<const GLfloat *>(0)+3, 3, 6 * sizeof(GLfloat));
-
-          // Push each element to the vertex shader
-          grid_elements.bind();
-          glDrawElements(GL_LINES, grid_elements.size()/sizeof(GLushort), GL_UNSIGNED_SHORT, 0);
-          check_gl("Grid draw elements");
-
-          grid_shader->disableColour();
-          grid_shader->disableCoords();
+          glDrawArrays(GL_TRIANGLES, 0, 3);
+          check_gl("Grid draw arrays");
           vertices.release();
+
           grid_shader->release();
         }
 
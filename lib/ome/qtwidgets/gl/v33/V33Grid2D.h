@@ -39,15 +39,16 @@
 #ifndef OME_QTWIDGETS_GL_V33_V33GRID2D_H
 #define OME_QTWIDGETS_GL_V33_V33GRID2D_H
 
+#include <memory>
+
 #include <QtCore/QObject>
-#include <QtGui/QOpenGLBuffer>
 #include <QtGui/QOpenGLShader>
 
 #include <ome/files/Types.h>
 #include <ome/files/FormatReader.h>
 
 #include <ome/qtwidgets/gl/Grid2D.h>
-#include <ome/qtwidgets/glsl/v330/V330GLLineShader2D.h>
+#include <ome/qtwidgets/glsl/v330/V330GLGridShader2D.h>
 
 namespace ome
 {
@@ -98,7 +99,7 @@ namespace ome
 
         private:
           /// The shader program for grid shading.
-          glsl::v330::GLLineShader2D *grid_shader;
+          std::shared_ptr<glsl::v330::GLGridShader2D> grid_shader;
         };
 
       }
@@ -36,10 +36,86 @@
  * #L%
  */
 
+#include <ome/qtwidgets/TexelProperties.h>
+#include <ome/qtwidgets/Trace.h>
 #include <ome/qtwidgets/gl/v33/V33Image2D.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
 #include <ome/qtwidgets/gl/Util.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+
+// Required with Boost 1.53 after variant include.
+#include <boost/preprocessor.hpp>
+
+namespace
+{
+
+  using ome::qtwidgets::glsl::v330::GLImageShader2D;
+  using ome::qtwidgets::glsl::v330::GLImageShader2DVariant;
+
+  // No switch default to avoid -Wunreachable-code errors.
+  // However, this then makes -Wswitch-default complain.  Disable
+  // temporarily.
+#ifdef __GNUC__
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wswitch-default"
+#endif
+
+#define PROGRAM_CASE(maR, maProperty, maType)                           \
+    case ::ome::xml::model::enums::PixelType::maType:                   \
+      program = ome::qtwidgets::gl::SharedResources::get().program<GLImageShader2DVariant<ome::qtwidgets::TexelProperties<::ome::xml::model::enums::PixelType::maType>::sampler>>(); \
+      break;
+
+  /*
+   * Get the shader program variant for the pixel type of a series.
+   */
+  std::shared_ptr<GLImageShader2D>
+  image_program(const ome::qtwidgets::SeriesInfo& info)
+  {
+    ome::xml::model::enums::PixelType pixeltype = info.pixelType;
+
+    std::shared_ptr<GLImageShader2D> program;
+
+    switch(pixeltype)
+      {
+        BOOST_PP_SEQ_FOR_EACH(PROGRAM_CASE, size, OME_XML_MODEL_ENUMS_PIXELTYPE_VALUES);
+      }
+
+    return program;
+  }
+
+#undef PROGRAM_CASE
+
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif
+
+  /*
+   * Convert normalized contrast limits to sample values, rounded
+   * and clamped to the range of the integer type T.
+   */
+  template<typename V, typename T>
+  V
+  sample_limits(const glm::vec3& limits,
+                const glm::vec3& correction,
+                double           range)
+  {
+    V ret;
+    for (int i = 0; i < 3; ++i)
+      {
+        double value = std::round(static_cast<double>(limits[i]) / static_cast<double>(correction[i]) * range);
+        value = std::max(value, static_cast<double>(std::numeric_limits<T>::min()));
+        value = std::min(value, static_cast<double>(std::numeric_limits<T>::max()));
+        ret[i] = static_cast<T>(value);
+      }
+    return ret;
+  }
+
+}
 
 namespace ome
 {
@@ -54,7 +130,7 @@ namespace ome
                          ome::files::dimension_size_type                    series,
                          QObject                                           *parent):
           gl::Image2D(reader, series, parent),
-          image_shader(new glsl::v330::GLImageShader2D(this))
+          image_shader(image_program(*info))
         {
         }
 
@@ -65,11 +141,28 @@ namespace ome
         void
         Image2D::render(const glm::mat4& mvp)
         {
+          TraceScope trace("Image2D::render", "shader");
+
           image_shader->bind();
 
-          image_shader->setMin(texmin);
-          image_shader->setMax(texmax);
-          image_shader->setCorrection(texcorr);
+          // Integer textures are windowed using sample values.
+          switch(image_shader->getSampler())
+            {
+            case UNSIGNED_SAMPLER:
+              image_shader->setMin(sample_limits<glm::uvec3, uint32_t>(texmin, texcorr, texrange));
+              image_shader->setMax(sample_limits<glm::uvec3, uint32_t>(texmax, texcorr, texrange));
+              break;
+            case SIGNED_SAMPLER:
+              image_shader->setMin(sample_limits<glm::ivec3, int32_t>(texmin, texcorr, texrange));
+              image_shader->setMax(sample_limits<glm::ivec3, int32_t>(texmax, texcorr, texrange));
+              break;
+            case FLOAT_SAMPLER:
+            default:
+              image_shader->setMin(texmin);
+              image_shader->setMax(texmax);
+              image_shader->setCorrection(texcorr);
+              break;
+            }
           image_shader->setModelViewProjection(mvp);
 
           glActiveTexture(GL_TEXTURE0);
@@ -83,6 +176,7 @@ namespace ome
           glBindTexture(GL_TEXTURE_1D_ARRAY, lutid);
           check_gl("Bind texture");
           image_shader->setLUT(1);
+          image_shader->setLUTRow(lutrow);
 
           vertices.bind();
 
@@ -39,6 +39,8 @@
 #ifndef OME_QTWIDGETS_GL_V33_V33IMAGE2D_H
 #define OME_QTWIDGETS_GL_V33_V33IMAGE2D_H
 
+#include <memory>
+
 #include <QtCore/QObject>
 #include <QtGui/QOpenGLBuffer>
 #include <QtGui/QOpenGLShader>
@@ -94,7 +96,7 @@ namespace ome
 
         private:
           /// The shader program for image rendering.
-          glsl::v330::GLImageShader2D *image_shader;
+          std::shared_ptr<glsl::v330::GLImageShader2D> image_shader;
         };
 
       }
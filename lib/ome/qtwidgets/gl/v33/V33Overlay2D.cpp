@@ -0,0 +1,118 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/Trace.h>
+#include <ome/qtwidgets/gl/v33/V33Overlay2D.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
+#include <ome/qtwidgets/gl/Util.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+      namespace v33
+      {
+
+        Overlay2D::Overlay2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                             ome::files::dimension_size_type            series,
+                             QObject                                   *parent):
+          gl::Overlay2D(reader, series, parent),
+          overlay_shader(SharedResources::get().program<glsl::v330::GLOverlayShader2D>())
+        {
+        }
+
+        Overlay2D::~Overlay2D()
+        {
+        }
+
+        void
+        Overlay2D::render(const glm::mat4& mvp)
+        {
+          TraceScope trace("Overlay2D::render", "shader");
+
+          cull(mvp);
+          if (!visible)
+            return;
+
+          overlay_shader->bind();
+          overlay_shader->setModelViewProjection(mvp);
+          overlay_shader->setPointSize(5.0f);
+
+          vertices.bind();
+
+          overlay_shader->enableCoords();
+          overlay_shader->setCoords(shape_vertices, 0, 2, 6 * sizeof(GLfloat));
+
+          overlay_shader->enableColour();
+          overlay_shader->setColour(shape_vertices, reinterpret_cast<const GLfloat *>(0)+2, 4, 6 * sizeof(GLfloat));
+
+          glEnable(GL_PROGRAM_POINT_SIZE);
+
+          const std::array<GLenum, BATCH_COUNT> modes
+            {
+              {
+                GL_LINE_LOOP,
+                GL_LINE_STRIP,
+                GL_POINTS
+              }
+            };
+
+          // One draw call per primitive type for all visible shapes.
+          for (std::size_t b = 0; b < BATCH_COUNT; ++b)
+            {
+              if (firsts[b].empty())
+                continue;
+              glMultiDrawArrays(modes[b], firsts[b].data(), counts[b].data(),
+                                static_cast<GLsizei>(firsts[b].size()));
+              check_gl("Overlay multi-draw arrays");
+            }
+
+          glDisable(GL_PROGRAM_POINT_SIZE);
+
+          overlay_shader->disableColour();
+          overlay_shader->disableCoords();
+          vertices.release();
+          overlay_shader->release();
+        }
+
+      }
+    }
+  }
+}
@@ -0,0 +1,179 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/Trace.h>
+#include <ome/qtwidgets/gl/v33/V33PointCloud2D.h>
+#include <ome/qtwidgets/gl/SharedResources.h>
+#include <ome/qtwidgets/gl/Util.h>
+
+#include <QtGui/QOpenGLFramebufferObject>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+      namespace v33
+      {
+
+        PointCloud2D::PointCloud2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                                   ome::files::dimension_size_type            series,
+                                   QObject                                   *parent):
+          gl::PointCloud2D(reader, series, parent),
+          point_shader(SharedResources::get().program<glsl::v330::GLPointShader2D>()),
+          density_shader(SharedResources::get().program<glsl::v330::GLDensityShader2D>()),
+          densityfbo()
+        {
+        }
+
+        PointCloud2D::~PointCloud2D()
+        {
+          delete densityfbo;
+        }
+
+        void
+        PointCloud2D::render(const glm::mat4& mvp)
+        {
+          TraceScope trace("PointCloud2D::render", "shader");
+
+          upload();
+          cull(mvp);
+          if (firsts.empty())
+            return;
+
+          GLint viewport[4];
+          glGetIntegerv(GL_VIEWPORT, viewport);
+          float pixels = static_cast<float>(viewport[2]) * static_cast<float>(viewport[3]);
+
+          if (static_cast<float>(visible) > densityThreshold * pixels)
+            drawDensity(mvp, viewport);
+          else
+            drawPoints(mvp, colour, pointSize);
+        }
+
+        void
+        PointCloud2D::drawPoints(const glm::mat4& mvp,
+                                 const glm::vec4& colour,
+                                 float            size)
+        {
+          point_shader->bind();
+          point_shader->setModelViewProjection(mvp);
+          point_shader->setColour(colour);
+          point_shader->setPointSize(size);
+
+          vertices.bind();
+
+          point_shader->enableCoords();
+          point_shader->setCoords(point_vertices, 0, 2, 0);
+
+          glEnable(GL_PROGRAM_POINT_SIZE);
+          glMultiDrawArrays(GL_POINTS, firsts.data(), counts.data(),
+                            static_cast<GLsizei>(firsts.size()));
+          check_gl("Point cloud multi-draw arrays");
+          glDisable(GL_PROGRAM_POINT_SIZE);
+
+          point_shader->disableCoords();
+          vertices.release();
+          point_shader->release();
+        }
+
+        void
+        PointCloud2D::drawDensity(const glm::mat4& mvp,
+                                  const GLint     *viewport)
+        {
+          // Save state altered by the accumulation pass; the caller
+          // may be rendering into its own framebuffer.
+          GLint oldfbo = 0;
+          glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldfbo);
+          GLfloat oldclear[4];
+          glGetFloatv(GL_COLOR_CLEAR_VALUE, oldclear);
+
+          QSize fbosize(viewport[2], viewport[3]);
+          if (!densityfbo || densityfbo->size() != fbosize)
+            {
+              delete densityfbo;
+              densityfbo = new QOpenGLFramebufferObject(fbosize,
+                                                        QOpenGLFramebufferObject::NoAttachment,
+                                                        GL_TEXTURE_2D, GL_R32F);
+            }
+
+          // Accumulate one count per point.
+          densityfbo->bind();
+          glViewport(0, 0, fbosize.width(), fbosize.height());
+          glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+          glClear(GL_COLOR_BUFFER_BIT);
+          glBlendFunc(GL_ONE, GL_ONE);
+
+          drawPoints(mvp, glm::vec4(1.0f), 1.0f);
+
+          glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+          glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(oldfbo));
+          glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+          glClearColor(oldclear[0], oldclear[1], oldclear[2], oldclear[3]);
+
+          // Composite through the LUT.
+          density_shader->bind();
+          density_shader->setMax(densityMax);
+
+          glActiveTexture(GL_TEXTURE0);
+          check_gl("Activate texture");
+          glBindTexture(GL_TEXTURE_2D, densityfbo->texture());
+          check_gl("Bind texture");
+          density_shader->setDensity(0);
+
+          glActiveTexture(GL_TEXTURE1);
+          check_gl("Activate texture");
+          glBindTexture(GL_TEXTURE_1D_ARRAY, SharedResources::get().lut());
+          check_gl("Bind texture");
+          density_shader->setLUT(1);
+
+          // Full-screen triangle; vertices are generated in the shader.
+          vertices.bind();
+          glDrawArrays(GL_TRIANGLES, 0, 3);
+          check_gl("Point density composite");
+          vertices.release();
+
+          glActiveTexture(GL_TEXTURE0);
+          density_shader->release();
+        }
+
+      }
+    }
+  }
+}
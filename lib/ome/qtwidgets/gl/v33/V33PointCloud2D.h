@@ -0,0 +1,144 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GL_V33_V33POINTCLOUD2D_H
+#define OME_QTWIDGETS_GL_V33_V33POINTCLOUD2D_H
+
+#include <memory>
+
+#include <QtCore/QObject>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QOpenGLShader>
+
+#include <ome/files/Types.h>
+#include <ome/files/FormatReader.h>
+
+#include <ome/qtwidgets/gl/PointCloud2D.h>
+#include <ome/qtwidgets/glsl/v330/V330GLDensityShader2D.h>
+#include <ome/qtwidgets/glsl/v330/V330GLPointShader2D.h>
+
+QT_BEGIN_NAMESPACE
+class QOpenGLFramebufferObject;
+QT_END_NAMESPACE
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace gl
+    {
+      namespace v33
+      {
+
+        /**
+         * 2D (xy) point cloud renderer.
+         *
+         * Draws point localisations over the specified image.
+         */
+        class PointCloud2D : public gl::PointCloud2D
+        {
+          Q_OBJECT
+
+        public:
+          /**
+           * Create a 2D point cloud.
+           *
+           * The size and position will be taken from the specified image.
+           *
+           * @param reader the image reader.
+           * @param series the image series.
+           * @param parent the parent of this object.
+           */
+          explicit PointCloud2D(std::shared_ptr<ome::files::FormatReader>  reader,
+                                ome::files::dimension_size_type            series,
+                                QObject                                   *parent = 0);
+
+          /// Destructor.
+          ~PointCloud2D();
+
+          /**
+           * Render the point cloud.
+           *
+           * @param mvp the model view projection matrix.
+           */
+          void
+          render(const glm::mat4& mvp);
+
+        private:
+          /**
+           * Draw the visible points.
+           *
+           * @param mvp the model view projection matrix.
+           * @param colour the point colour.
+           * @param size the point size.
+           */
+          void
+          drawPoints(const glm::mat4& mvp,
+                     const glm::vec4& colour,
+                     float            size);
+
+          /**
+           * Accumulate point density and composite through the LUT.
+           *
+           * @param mvp the model view projection matrix.
+           * @param viewport the current viewport.
+           */
+          void
+          drawDensity(const glm::mat4& mvp,
+                      const GLint     *viewport);
+
+          /// The shader program for point shading.
+          std::shared_ptr<glsl::v330::GLPointShader2D> point_shader;
+          /// The shader program for density compositing.
+          std::shared_ptr<glsl::v330::GLDensityShader2D> density_shader;
+          /// Density accumulation framebuffer.
+          QOpenGLFramebufferObject *densityfbo;
+        };
+
+      }
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GL_V33_V33POINTCLOUD2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
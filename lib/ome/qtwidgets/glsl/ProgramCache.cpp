@@ -0,0 +1,279 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <iostream>
+
+#include <ome/qtwidgets/CacheDirectory.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#  define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#  define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#  define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace
+{
+
+  // Cache file identification.
+  const quint32 cache_magic = 0x4f4d5150; // "OMQP"
+  const quint32 cache_version = 1;
+
+  ome::qtwidgets::CacheDirectory cache_directory("shaders");
+
+  // Program binary entry points (GL 4.1 or ARB_get_program_binary).
+  typedef void (QOPENGLF_APIENTRYP GetProgramBinaryFunc)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+  typedef void (QOPENGLF_APIENTRYP ProgramBinaryFunc)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+  typedef void (QOPENGLF_APIENTRYP ProgramParameteriFunc)(GLuint program, GLenum pname, GLint value);
+
+  struct BinaryFunctions
+  {
+    GetProgramBinaryFunc getProgramBinary;
+    ProgramBinaryFunc programBinary;
+    ProgramParameteriFunc programParameteri;
+
+    BinaryFunctions():
+      getProgramBinary(0),
+      programBinary(0),
+      programParameteri(0)
+    {
+      QOpenGLContext *context = QOpenGLContext::currentContext();
+      if (!context)
+        return;
+
+      if (context->format().version() < qMakePair(4, 1) &&
+          !context->hasExtension("GL_ARB_get_program_binary"))
+        return;
+
+      // Some drivers advertise the entry points but support no
+      // binary formats.
+      GLint formats = 0;
+      context->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+      if (formats <= 0)
+        return;
+
+      getProgramBinary = reinterpret_cast<GetProgramBinaryFunc>(context->getProcAddress("glGetProgramBinary"));
+      programBinary = reinterpret_cast<ProgramBinaryFunc>(context->getProcAddress("glProgramBinary"));
+      programParameteri = reinterpret_cast<ProgramParameteriFunc>(context->getProcAddress("glProgramParameteri"));
+    }
+
+    bool
+    supported() const
+    {
+      return getProgramBinary && programBinary && programParameteri;
+    }
+  };
+
+  QByteArray
+  gl_string(QOpenGLFunctions *funcs,
+            GLenum            name)
+  {
+    const GLubyte *str = funcs->glGetString(name);
+    return str ? QByteArray(reinterpret_cast<const char *>(str)) : QByteArray();
+  }
+
+}
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+
+      ProgramCache::ProgramCache(const std::string&                 name,
+                                 std::initializer_list<const char *> sources):
+        name(name),
+        key()
+      {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+
+        // The binary is only valid for the same driver.
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if (context)
+          {
+            QOpenGLFunctions *funcs = context->functions();
+            hash.addData(gl_string(funcs, GL_VENDOR));
+            hash.addData(gl_string(funcs, GL_RENDERER));
+            hash.addData(gl_string(funcs, GL_VERSION));
+            hash.addData(gl_string(funcs, GL_SHADING_LANGUAGE_VERSION));
+          }
+
+        hash.addData(name.c_str(), static_cast<int>(name.size() + 1));
+        for (const auto& source : sources)
+          if (source)
+            hash.addData(source, static_cast<int>(qstrlen(source) + 1));
+
+        key = hash.result().toHex();
+      }
+
+      ProgramCache::~ProgramCache()
+      {
+      }
+
+      bool
+      ProgramCache::load(QOpenGLShaderProgram& program)
+      {
+        QString file(cacheFile());
+        if (file.isEmpty())
+          return false;
+
+        QFile in(file);
+        if (!in.open(QIODevice::ReadOnly))
+          return false;
+
+        QDataStream stream(&in);
+        stream.setVersion(QDataStream::Qt_5_0);
+        quint32 magic, version, format;
+        QByteArray binary;
+        stream >> magic >> version;
+        if (magic != cache_magic || version != cache_version)
+          return false;
+        stream >> format >> binary;
+        if (stream.status() != QDataStream::Ok || binary.isEmpty())
+          return false;
+        in.close();
+
+        BinaryFunctions funcs;
+        GLuint id = program.programId();
+        if (!id || !funcs.supported())
+          return false;
+
+        funcs.programBinary(id, format, binary.constData(), binary.size());
+        // Link status will be set if the binary was accepted; with
+        // no shaders attached, link() only queries the status.
+        if (!program.link())
+          {
+            // Rejected (e.g. after a driver update); recompile.
+            QOpenGLContext::currentContext()->functions()->glGetError();
+            QFile::remove(file);
+            return false;
+          }
+
+        return true;
+      }
+
+      bool
+      ProgramCache::link(QOpenGLShaderProgram& program)
+      {
+        BinaryFunctions funcs;
+        GLuint id = program.programId();
+        if (id && funcs.supported())
+          funcs.programParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        if (!program.link())
+          return false;
+
+        QString file(cacheFile());
+        if (file.isEmpty() || !funcs.supported())
+          return true;
+
+        QOpenGLFunctions *glfuncs = QOpenGLContext::currentContext()->functions();
+        GLint length = 0;
+        glfuncs->glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+          return true;
+
+        QByteArray binary(length, '\0');
+        GLsizei written = 0;
+        GLenum format = 0;
+        funcs.getProgramBinary(id, length, &written, &format, binary.data());
+        if (written <= 0)
+          return true;
+        binary.resize(written);
+
+        QDir().mkpath(QFileInfo(file).absolutePath());
+        QSaveFile out(file);
+        if (!out.open(QIODevice::WriteOnly))
+          {
+            std::cerr << "ProgramCache: Failed to write " << name << " program binary to " << file.toStdString() << std::endl;
+            return true;
+          }
+
+        QDataStream stream(&out);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << cache_magic << cache_version << static_cast<quint32>(format) << binary;
+        if (!out.commit())
+          std::cerr << "ProgramCache: Failed to write " << name << " program binary to " << file.toStdString() << std::endl;
+
+        return true;
+      }
+
+      QString
+      ProgramCache::cacheDirectory()
+      {
+        return cache_directory.get();
+      }
+
+      void
+      ProgramCache::setCacheDirectory(const QString& directory)
+      {
+        cache_directory.set(directory);
+      }
+
+      QString
+      ProgramCache::cacheFile() const
+      {
+        QString dir(cacheDirectory());
+        if (dir.isEmpty())
+          return QString();
+        return dir + "/" + QString::fromLatin1(key) + ".bin";
+      }
+
+    }
+  }
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
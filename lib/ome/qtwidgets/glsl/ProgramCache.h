@@ -0,0 +1,159 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GLSL_PROGRAMCACHE_H
+#define OME_QTWIDGETS_GLSL_PROGRAMCACHE_H
+
+#include <initializer_list>
+#include <string>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QOpenGLShaderProgram>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+
+      /**
+       * Persistent shader program binary cache.
+       *
+       * Linked program binaries are stored on disk, keyed by a hash
+       * of the GL vendor, renderer and version strings, and of the
+       * program name and shader sources.  Subsequent construction of
+       * the same program with the same driver restores the binary
+       * with glProgramBinary() and skips compilation entirely.  If
+       * program binaries are not supported by the driver, or the
+       * cached binary is rejected, the program is compiled and
+       * linked from source as usual.
+       *
+       * Usage:
+       * @code
+       * ProgramCache cache("MyShader", {vsource, fsource});
+       * if (!cache.load(*this))
+       *   {
+       *     // compile and add shaders
+       *     cache.link(*this);
+       *   }
+       * @endcode
+       *
+       * A current GL context is required.
+       */
+      class ProgramCache
+      {
+      public:
+        /**
+         * Constructor.
+         *
+         * @param name the program name.
+         * @param sources the shader source code of the program.
+         */
+        ProgramCache(const std::string&                 name,
+                     std::initializer_list<const char *> sources);
+
+        /// Destructor.
+        ~ProgramCache();
+
+        /**
+         * Restore a program from the cache.
+         *
+         * @param program the program to restore; it must not have
+         * any shaders attached.
+         * @returns @c true if the program was restored and linked,
+         * or @c false if it must be compiled.
+         */
+        bool
+        load(QOpenGLShaderProgram& program);
+
+        /**
+         * Link a program and store it in the cache.
+         *
+         * @param program the program to link, with its shaders
+         * attached.
+         * @returns @c true if the program was linked successfully.
+         */
+        bool
+        link(QOpenGLShaderProgram& program);
+
+        /**
+         * Get the cache directory.
+         *
+         * @returns the directory used to store program binaries.
+         */
+        static QString
+        cacheDirectory();
+
+        /**
+         * Set the cache directory.
+         *
+         * @param directory the directory used to store program
+         * binaries, or an empty string to disable caching.
+         */
+        static void
+        setCacheDirectory(const QString& directory);
+
+      private:
+        /**
+         * Get the cache file for the program.
+         *
+         * @returns the cache file, or an empty string if caching is
+         * disabled or not supported.
+         */
+        QString
+        cacheFile() const;
+
+        /// Program name.
+        std::string name;
+        /// Cache key.
+        QByteArray key;
+      };
+
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GLSL_PROGRAMCACHE_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
@@ -0,0 +1,167 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/glsl/v330/V330GLDensityShader2D.h>
+#include <ome/qtwidgets/gl/Util.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
+
+#include <iostream>
+
+using ome::qtwidgets::gl::check_gl;
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+      namespace v330
+      {
+
+        GLDensityShader2D::GLDensityShader2D(QObject *parent):
+          QOpenGLShaderProgram(parent),
+          vshader(),
+          fshader(),
+          uniform_density(),
+          uniform_lut(),
+          uniform_max()
+        {
+          initializeOpenGLFunctions();
+
+          static const char *vsource =
+            "#version 330 core\n"
+            "\n"
+            "out vec2 texcoord;\n"
+            "\n"
+            "void main(void) {\n"
+            "  // Full-screen triangle: (-1,-1), (3,-1), (-1,3).\n"
+            "  vec2 ndc = vec2(float((gl_VertexID & 1) << 2) - 1.0,\n"
+            "                  float((gl_VertexID & 2) << 1) - 1.0);\n"
+            "  gl_Position = vec4(ndc, 0.0, 1.0);\n"
+            "  texcoord = (ndc + 1.0) * 0.5;\n"
+            "}\n";
+
+          static const char *fsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform sampler2D density;\n"
+            "uniform sampler1DArray lut;\n"
+            "uniform float dmax;\n"
+            "\n"
+            "in vec2 texcoord;\n"
+            "\n"
+            "out vec4 outputColour;\n"
+            "\n"
+            "void main(void) {\n"
+            "  float d = texture(density, texcoord).r;\n"
+            "  if (d <= 0.0)\n"
+            "    discard;\n"
+            "  float v = clamp(log(1.0 + d) / log(1.0 + dmax), 0.0, 1.0);\n"
+            "  outputColour = vec4(texture(lut, vec2(v, 0.0)).rgb, 1.0);\n"
+            "}\n";
+
+          ProgramCache cache("V330GLDensityShader2D", {vsource, fsource});
+          if (!cache.load(*this))
+            {
+              vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
+              vshader->compileSourceCode(vsource);
+              if (!vshader->isCompiled())
+                {
+                  std::cerr << "V330GLDensityShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+                }
+
+              fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
+              fshader->compileSourceCode(fsource);
+              if (!fshader->isCompiled())
+                {
+                  std::cerr << "V330GLDensityShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
+                }
+
+              addShader(vshader);
+              addShader(fshader);
+              cache.link(*this);
+            }
+
+          if (!isLinked())
+            {
+              std::cerr << "V330GLDensityShader2D: Failed to link shader program\n" << log().toStdString() << std::endl;
+            }
+
+          uniform_density = uniformLocation("density");
+          if (uniform_density == -1)
+            std::cerr << "V330GLDensityShader2D: Failed to bind density texture" << std::endl;
+
+          uniform_lut = uniformLocation("lut");
+          if (uniform_lut == -1)
+            std::cerr << "V330GLDensityShader2D: Failed to bind lut" << std::endl;
+
+          uniform_max = uniformLocation("dmax");
+          if (uniform_max == -1)
+            std::cerr << "V330GLDensityShader2D: Failed to bind max" << std::endl;
+        }
+
+        GLDensityShader2D::~GLDensityShader2D()
+        {
+        }
+
+        void
+        GLDensityShader2D::setDensity(int texunit)
+        {
+          glUniform1i(uniform_density, texunit);
+          check_gl("Set density texture");
+        }
+
+        void
+        GLDensityShader2D::setLUT(int texunit)
+        {
+          glUniform1i(uniform_lut, texunit);
+          check_gl("Set density LUT");
+        }
+
+        void
+        GLDensityShader2D::setMax(float max)
+        {
+          glUniform1f(uniform_max, max);
+          check_gl("Set density max");
+        }
+
+      }
+    }
+  }
+}
@@ -0,0 +1,129 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GLSL_V330_V330GLDENSITYSHADER2D_H
+#define OME_QTWIDGETS_GLSL_V330_V330GLDENSITYSHADER2D_H
+
+#include <QOpenGLShader>
+#include <QtGui/QOpenGLFunctions_3_3_Core>
+
+#include <ome/qtwidgets/glm.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+      namespace v330
+      {
+
+        /**
+         * 2D density composite shader program.
+         *
+         * Maps an accumulated point density texture through a LUT, in
+         * a single pass over a full-screen triangle generated from
+         * @c gl_VertexID (as for GLGridShader2D).  Density is scaled
+         * logarithmically up to a maximum; pixels with no points are
+         * transparent.
+         */
+        class GLDensityShader2D : public QOpenGLShaderProgram,
+                                  protected QOpenGLFunctions_3_3_Core
+        {
+          Q_OBJECT
+
+        public:
+          /**
+           * Constructor.
+           *
+           * @param parent the parent of this object.
+           */
+          explicit GLDensityShader2D(QObject *parent = 0);
+
+          /// Destructor.
+          ~GLDensityShader2D();
+
+          /**
+           * Set density texture.
+           *
+           * @param texunit the texture unit to use.
+           */
+          void
+          setDensity(int texunit);
+
+          /// @copydoc GLImageShader2D::setLUT(int)
+          void
+          setLUT(int texunit);
+
+          /**
+           * Set maximum density.
+           *
+           * Densities at or above this value map to the top of the
+           * LUT.
+           *
+           * @param max the maximum density (points per pixel).
+           */
+          void
+          setMax(float max);
+
+        private:
+          /// @copydoc GLImageShader2D::vshader
+          QOpenGLShader *vshader;
+          /// @copydoc GLImageShader2D::fshader
+          QOpenGLShader *fshader;
+
+          /// Density texture uniform.
+          int uniform_density;
+          /// @copydoc GLImageShader2D::uniform_lut
+          int uniform_lut;
+          /// Maximum density uniform.
+          int uniform_max;
+        };
+
+      }
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GLSL_V330_V330GLDENSITYSHADER2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
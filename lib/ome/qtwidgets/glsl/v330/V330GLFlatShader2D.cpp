@@ -39,6 +39,7 @@
 #include <ome/qtwidgets/glm.h>
 #include <ome/qtwidgets/glsl/v330/V330GLFlatShader2D.h>
 #include <ome/qtwidgets/gl/Util.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
 
 #include <iostream>
 
@@ -64,53 +65,61 @@ namespace ome
         {
           initializeOpenGLFunctions();
 
-          vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
-          vshader->compileSourceCode
-            ("#version 330 core\n"
-             "\n"
-             "uniform vec4 colour;\n"
-             "uniform vec2 offset;\n"
-             "uniform mat4 mvp;\n"
-             "\n"
-             "layout (location = 0) in vec2 coord2d;\n"
-             "\n"
-             "out VertexData\n"
-             "{\n"
-             "  vec4 f_colour;\n"
-             "} outData;\n"
-             "\n"
-             "void main(void) {\n"
-             "  gl_Position = mvp * vec4(coord2d+offset, 2.0, 1.0);\n"
-             "  outData.f_colour = colour;\n"
-             "}\n");
-          if (!vshader->isCompiled())
+          static const char *vsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform vec4 colour;\n"
+            "uniform vec2 offset;\n"
+            "uniform mat4 mvp;\n"
+            "\n"
+            "layout (location = 0) in vec2 coord2d;\n"
+            "\n"
+            "out VertexData\n"
+            "{\n"
+            "  vec4 f_colour;\n"
+            "} outData;\n"
+            "\n"
+            "void main(void) {\n"
+            "  gl_Position = mvp * vec4(coord2d+offset, 2.0, 1.0);\n"
+            "  outData.f_colour = colour;\n"
+            "}\n";
+
+          static const char *fsource =
+            "#version 330 core\n"
+            "\n"
+            "in VertexData\n"
+            "{\n"
+            "  vec4 f_colour;\n"
+            "} inData;\n"
+            "\n"
+            "out vec4 outputColour;\n"
+            "\n"
+            "void main(void) {\n"
+            "  outputColour = inData.f_colour;\n"
+            "}\n";
+
+          ProgramCache cache("V330GLFlatShader2D", {vsource, fsource});
+          if (!cache.load(*this))
             {
-              std::cerr << "Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+              vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
+              vshader->compileSourceCode(vsource);
+              if (!vshader->isCompiled())
+                {
+                  std::cerr << "Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+                }
+
+              fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
+              fshader->compileSourceCode(fsource);
+              if (!fshader->isCompiled())
+                {
+                  std::cerr << "V330GLFlatShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
+                }
+
+              addShader(vshader);
+              addShader(fshader);
+              cache.link(*this);
             }
 
-          fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
-          fshader->compileSourceCode
-            ("#version 330 core\n"
-             "\n"
-             "in VertexData\n"
-             "{\n"
-             "  vec4 f_colour;\n"
-             "} inData;\n"
-             "\n"
-             "out vec4 outputColour;\n"
-             "\n"
-             "void main(void) {\n"
-             "  outputColour = inData.f_colour;\n"
-             "}\n");
-          if (!fshader->isCompiled())
-            {
-              std::cerr << "V330GLFlatShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
-            }
-
-          addShader(vshader);
-          addShader(fshader);
-          link();
-
           if (!isLinked())
             {
               std::cerr << "V330GLFlatShader2D: Failed to link shader program\n" << log().toStdString() << std::endl;
@@ -0,0 +1,218 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/glsl/v330/V330GLGridShader2D.h>
+#include <ome/qtwidgets/gl/Util.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
+
+#include <iostream>
+
+using ome::qtwidgets::gl::check_gl;
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+      namespace v330
+      {
+
+        GLGridShader2D::GLGridShader2D(QObject *parent):
+          QOpenGLShaderProgram(parent),
+          vshader(),
+          fshader(),
+          uniform_invmvp(),
+          uniform_zoom(),
+          uniform_extent(),
+          uniform_major()
+        {
+          initializeOpenGLFunctions();
+
+          static const char *vsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform mat4 invmvp;\n"
+            "\n"
+            "out vec2 world;\n"
+            "\n"
+            "void main(void) {\n"
+            "  // Full-screen triangle: (-1,-1), (3,-1), (-1,3).\n"
+            "  vec2 ndc = vec2(float((gl_VertexID & 1) << 2) - 1.0,\n"
+            "                  float((gl_VertexID & 2) << 1) - 1.0);\n"
+            "  gl_Position = vec4(ndc, 0.0, 1.0);\n"
+            "  vec4 w = invmvp * gl_Position;\n"
+            "  world = w.xy / w.w;\n"
+            "}\n";
+
+          static const char *fsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform float zoom;\n"
+            "uniform vec4 extent; // xmin, xmax, ymin, ymax\n"
+            "uniform float lmajor;\n"
+            "\n"
+            "in vec2 world;\n"
+            "\n"
+            "out vec4 outputColour;\n"
+            "\n"
+            "const vec3 gridcol[3] = vec3[3](vec3(0.5), vec3(0.7), vec3(0.9));\n"
+            "const vec3 xcol = vec3(0.5, 0.0, 0.0);\n"
+            "const vec3 ycol = vec3(0.0, 0.5, 0.0);\n"
+            "\n"
+            "void log10(in float v1, out float v2) { v2 = log2(v1) * 0.30103; }\n"
+            "\n"
+            "// Composite premultiplied colour c with alpha a over dst.\n"
+            "vec4 over(in vec4 dst, in vec3 c, in float a) { return vec4(c * a, a) + dst * (1.0 - a); }\n"
+            "\n"
+            "void main(void) {\n"
+            "  if (world.x < extent.x || world.x > extent.y ||\n"
+            "      world.y < extent.z || world.y > extent.w)\n"
+            "    discard;\n"
+            "\n"
+            "  // World units per pixel, for one pixel wide antialiased lines.\n"
+            "  vec2 fw = fwidth(world);\n"
+            "\n"
+            "  float logzoom;\n"
+            "  log10(zoom, logzoom);\n"
+            "\n"
+            "  vec4 colour = vec4(0.0);\n"
+            "  // Finest gridlines first, with coarser gridlines over them.\n"
+            "  for (int i = 2; i >= 0; --i) {\n"
+            "    float spacing = pow(10.0, lmajor - float(i));\n"
+            "    vec2 p = world / spacing;\n"
+            "    vec2 d = abs(fract(p - 0.5) - 0.5) * spacing / fw;\n"
+            "    vec2 c = 1.0 - clamp(d, 0.0, 1.0);\n"
+            "    // Logistic function offset by LOD and correction factor to set the transition points\n"
+            "    float fade = 1.0 / (1.0 + pow(10.0, ((-logzoom-1.0+float(i))*30.0)));\n"
+            "    colour = over(colour, gridcol[i], max(c.x, c.y) * fade);\n"
+            "  }\n"
+            "\n"
+            "  // x and y origin\n"
+            "  vec2 o = 1.0 - clamp(abs(world) / fw, 0.0, 1.0);\n"
+            "  colour = over(colour, ycol, o.x);\n"
+            "  colour = over(colour, xcol, o.y);\n"
+            "\n"
+            "  if (colour.a <= 0.0)\n"
+            "    discard;\n"
+            "  outputColour = vec4(colour.rgb / colour.a, colour.a);\n"
+            "}\n";
+
+          ProgramCache cache("V330GLGridShader2D", {vsource, fsource});
+          if (!cache.load(*this))
+            {
+              vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
+              vshader->compileSourceCode(vsource);
+              if (!vshader->isCompiled())
+                {
+                  std::cerr << "V330GLGridShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+                }
+
+              fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
+              fshader->compileSourceCode(fsource);
+              if (!fshader->isCompiled())
+                {
+                  std::cerr << "V330GLGridShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
+                }
+
+              addShader(vshader);
+              addShader(fshader);
+              cache.link(*this);
+            }
+
+          if (!isLinked())
+            {
+              std::cerr << "V330GLGridShader2D: Failed to link shader program\n" << log().toStdString() << std::endl;
+            }
+
+          uniform_invmvp = uniformLocation("invmvp");
+          if (uniform_invmvp == -1)
+            std::cerr << "V330GLGridShader2D: Failed to bind inverse transform" << std::endl;
+
+          uniform_zoom = uniformLocation("zoom");
+          if (uniform_zoom == -1)
+            std::cerr << "V330GLGridShader2D: Failed to bind zoom factor" << std::endl;
+
+          uniform_extent = uniformLocation("extent");
+          if (uniform_extent == -1)
+            std::cerr << "V330GLGridShader2D: Failed to bind extent" << std::endl;
+
+          uniform_major = uniformLocation("lmajor");
+          if (uniform_major == -1)
+            std::cerr << "V330GLGridShader2D: Failed to bind major magnitude" << std::endl;
+        }
+
+        GLGridShader2D::~GLGridShader2D()
+        {
+        }
+
+        void
+        GLGridShader2D::setModelViewProjection(const glm::mat4& mvp)
+        {
+          glm::mat4 invmvp(glm::inverse(mvp));
+          glUniformMatrix4fv(uniform_invmvp, 1, GL_FALSE, glm::value_ptr(invmvp));
+          check_gl("Set grid uniform inverse mvp");
+        }
+
+        void
+        GLGridShader2D::setZoom(float zoom)
+        {
+          glUniform1f(uniform_zoom, zoom);
+          check_gl("Set grid zoom level");
+        }
+
+        void
+        GLGridShader2D::setExtent(const glm::vec2& xlim,
+                                  const glm::vec2& ylim)
+        {
+          glUniform4f(uniform_extent, xlim[0], xlim[1], ylim[0], ylim[1]);
+          check_gl("Set grid extent");
+        }
+
+        void
+        GLGridShader2D::setMajor(int magnitude)
+        {
+          glUniform1f(uniform_major, static_cast<float>(magnitude));
+          check_gl("Set grid major magnitude");
+        }
+
+      }
+    }
+  }
+}
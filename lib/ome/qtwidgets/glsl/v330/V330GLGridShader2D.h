@@ -0,0 +1,151 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#ifndef OME_QTWIDGETS_GLSL_V330_V330GLGRIDSHADER2D_H
+#define OME_QTWIDGETS_GLSL_V330_V330GLGRIDSHADER2D_H
+
+#include <QOpenGLShader>
+#include <QtGui/QOpenGLFunctions_3_3_Core>
+
+#include <ome/qtwidgets/glm.h>
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+      namespace v330
+      {
+
+        /**
+         * 2D procedural grid shader program.
+         *
+         * Gridlines are computed analytically per fragment from the
+         * world coordinates, in a single pass over a full-screen
+         * triangle.  No vertex attributes are used; the triangle is
+         * generated from @c gl_VertexID, so an (empty) vertex array
+         * object must be bound when drawing three vertices.
+         *
+         * Three levels of gridline are drawn, at the major spacing
+         * and one and two orders of magnitude below; each level is
+         * faded in according to the zoom level, as for
+         * GLLineShader2D.
+         */
+        class GLGridShader2D : public QOpenGLShaderProgram,
+                               protected QOpenGLFunctions_3_3_Core
+        {
+          Q_OBJECT
+
+        public:
+          /**
+           * Constructor.
+           *
+           * @param parent the parent of this object.
+           */
+          explicit GLGridShader2D(QObject *parent = 0);
+
+          /// Destructor.
+          ~GLGridShader2D();
+
+          /**
+           * Set model view projection matrix.
+           *
+           * The inverse is used to map each fragment back to world
+           * coordinates.
+           *
+           * @param mvp the model view projection matrix.
+           */
+          void
+          setModelViewProjection(const glm::mat4& mvp);
+
+          /**
+           * Set zoom level.
+           *
+           * @param zoom the zoom level.
+           */
+          void
+          setZoom(float zoom);
+
+          /**
+           * Set grid extent.
+           *
+           * @param xlim the x limits (range).
+           * @param ylim the y limits (range).
+           */
+          void
+          setExtent(const glm::vec2& xlim,
+                    const glm::vec2& ylim);
+
+          /**
+           * Set major gridline magnitude.
+           *
+           * @param magnitude the order of magnitude of the major
+           * gridlines.
+           */
+          void
+          setMajor(int magnitude);
+
+        private:
+          /// @copydoc GLImageShader2D::vshader
+          QOpenGLShader *vshader;
+          /// @copydoc GLImageShader2D::fshader
+          QOpenGLShader *fshader;
+
+          /// Inverse model view projection uniform.
+          int uniform_invmvp;
+          /// Zoom uniform.
+          int uniform_zoom;
+          /// Extent uniform.
+          int uniform_extent;
+          /// Major gridline magnitude uniform.
+          int uniform_major;
+        };
+
+      }
+    }
+  }
+}
+
+#endif // OME_QTWIDGETS_GLSL_V330_V330GLGRIDSHADER2D_H
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
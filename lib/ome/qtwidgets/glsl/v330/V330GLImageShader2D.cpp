@@ -39,11 +39,96 @@
 #include <ome/qtwidgets/glm.h>
 #include <ome/qtwidgets/glsl/v330/V330GLImageShader2D.h>
 #include <ome/qtwidgets/gl/Util.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
 
 #include <iostream>
 #include <sstream>
+#include <string>
 
 using ome::qtwidgets::gl::check_gl;
+using ome::qtwidgets::TexelSampler;
+
+namespace
+{
+
+  /*
+   * Generate the fragment shader for a sampler type.
+   *
+   * Floating point textures are windowed using normalized limits
+   * and a correction multiplier.  Integer textures are windowed
+   * using the raw sample values; the comparisons and differences
+   * are computed with integer arithmetic so that the window limits
+   * are exact for all sample values.
+   */
+  std::string
+  fragment_source(TexelSampler sampler)
+  {
+    std::string prefix;
+    std::string window;
+
+    switch(sampler)
+      {
+      case ome::qtwidgets::UNSIGNED_SAMPLER:
+        prefix = "u";
+        window =
+          "  uint texval = texture(tex, flipped_texcoord)[0];\n"
+          "\n"
+          "  float lutpos = 0.0;\n"
+          "  if (texval >= texmax[0])\n"
+          "    lutpos = 1.0;\n"
+          "  else if (texval > texmin[0])\n"
+          "    lutpos = float(texval - texmin[0]) / float(texmax[0] - texmin[0]);\n";
+        break;
+      case ome::qtwidgets::SIGNED_SAMPLER:
+        prefix = "i";
+        window =
+          "  int texval = texture(tex, flipped_texcoord)[0];\n"
+          "\n"
+          "  // Differences may exceed the int range; they wrap to the\n"
+          "  // correct uint value.\n"
+          "  float lutpos = 0.0;\n"
+          "  if (texval >= texmax[0])\n"
+          "    lutpos = 1.0;\n"
+          "  else if (texval > texmin[0])\n"
+          "    lutpos = float(uint(texval - texmin[0])) / float(uint(texmax[0] - texmin[0]));\n";
+        break;
+      case ome::qtwidgets::FLOAT_SAMPLER:
+      default:
+        window =
+          "  vec4 texval = texture(tex, flipped_texcoord);\n"
+          "\n"
+          "  float lutpos = clamp((((texval[0] * correction[0]) - texmin[0]) / (texmax[0] - texmin[0])), 0.0, 1.0);\n";
+        break;
+      }
+
+    return
+      "#version 330 core\n"
+      "\n"
+      "uniform " + prefix + "sampler2D tex;\n"
+      "uniform sampler1DArray lut;\n"
+      "uniform int lutrow;\n"
+      "uniform " + prefix + "vec3 texmin;\n"
+      "uniform " + prefix + "vec3 texmax;\n"
+      "uniform vec3 correction;\n"
+      "\n"
+      "in VertexData\n"
+      "{\n"
+      "  vec2 f_texcoord;\n"
+      "} inData;\n"
+      "\n"
+      "out vec4 outputColour;\n"
+      "\n"
+      "void main(void) {\n"
+      "  vec2 flipped_texcoord = vec2(inData.f_texcoord.x, 1.0 - inData.f_texcoord.y);\n" +
+      window +
+      "\n"
+      "  // Map to texel centres so that every LUT entry is used.\n"
+      "  float lutsize = float(textureSize(lut, 0).x);\n"
+      "  outputColour = texture(lut, vec2((0.5 + (lutpos * (lutsize - 1.0))) / lutsize, float(lutrow)));\n"
+      "}\n";
+  }
+
+}
 
 namespace ome
 {
@@ -54,8 +139,10 @@ namespace ome
       namespace v330
       {
 
-        GLImageShader2D::GLImageShader2D(QObject *parent):
+        GLImageShader2D::GLImageShader2D(TexelSampler  sampler,
+                                         QObject      *parent):
           QOpenGLShaderProgram(parent),
+          sampler(sampler),
           vshader(),
           fshader(),
           attr_coords(),
@@ -63,68 +150,54 @@ namespace ome
           uniform_mvp(),
           uniform_texture(),
           uniform_lut(),
+          uniform_lutrow(),
           uniform_min(),
-          uniform_max()
+          uniform_max(),
+          uniform_corr()
         {
           initializeOpenGLFunctions();
 
-          vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
-
-          vshader->compileSourceCode
-            ("#version 330 core\n"
-             "\n"
-             "layout (location = 0) in vec2 coord2d;\n"
-             "layout (location = 1) in vec2 texcoord;\n"
-             "uniform mat4 mvp;\n"
-             "\n"
-             "out VertexData\n"
-             "{\n"
-             "  vec2 f_texcoord;\n"
-             "} outData;\n"
-             "\n"
-             "void main(void) {\n"
-             "  gl_Position = mvp * vec4(coord2d, 0.0, 1.0);\n"
-             "  outData.f_texcoord = texcoord;\n"
-             "}\n");
-
-          if (!vshader->isCompiled())
+          static const char *vsource =
+            "#version 330 core\n"
+            "\n"
+            "layout (location = 0) in vec2 coord2d;\n"
+            "layout (location = 1) in vec2 texcoord;\n"
+            "uniform mat4 mvp;\n"
+            "\n"
+            "out VertexData\n"
+            "{\n"
+            "  vec2 f_texcoord;\n"
+            "} outData;\n"
+            "\n"
+            "void main(void) {\n"
+            "  gl_Position = mvp * vec4(coord2d, 0.0, 1.0);\n"
+            "  outData.f_texcoord = texcoord;\n"
+            "}\n";
+
+          const std::string fsource(fragment_source(sampler));
+
+          ProgramCache cache("V330GLImageShader2D", {vsource, fsource.c_str()});
+          if (!cache.load(*this))
             {
-              std::cerr << "V330GLImageShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+              vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
+              vshader->compileSourceCode(vsource);
+              if (!vshader->isCompiled())
+                {
+                  std::cerr << "V330GLImageShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+                }
+
+              fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
+              fshader->compileSourceCode(fsource.c_str());
+              if (!fshader->isCompiled())
+                {
+                  std::cerr << "V330GLImageShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
+                }
+
+              addShader(vshader);
+              addShader(fshader);
+              cache.link(*this);
             }
 
-          fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
-          fshader->compileSourceCode
-            ("#version 330 core\n"
-             "\n"
-             "uniform sampler2D tex;\n"
-             "uniform sampler1DArray lut;\n"
-             "uniform vec3 texmin;\n"
-             "uniform vec3 texmax;\n"
-             "uniform vec3 correction;\n"
-             "\n"
-             "in VertexData\n"
-             "{\n"
-             "  vec2 f_texcoord;\n"
-             "} inData;\n"
-             "\n"
-             "out vec4 outputColour;\n"
-             "\n"
-             "void main(void) {\n"
-             "  vec2 flipped_texcoord = vec2(inData.f_texcoord.x, 1.0 - inData.f_texcoord.y);\n"
-             "  vec4 texval = texture(tex, flipped_texcoord);\n"
-             "\n"
-             "  outputColour = texture(lut, vec2(((((texval[0] * correction[0]) - texmin[0]) / (texmax[0] - texmin[0]))), 0.0));\n"
-             "}\n");
-
-          if (!fshader->isCompiled())
-            {
-              std::cerr << "V330GLImageShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
-            }
-
-          addShader(vshader);
-          addShader(fshader);
-          link();
-
           if (!isLinked())
             {
               std::cerr << "V330GLImageShader2D: Failed to link shader program\n" << log().toStdString() << std::endl;
@@ -150,6 +223,10 @@ namespace ome
           if (uniform_lut == -1)
             std::cerr << "V330GLImageShader2D: Failed to bind lut uniform " << std::endl;
 
+          uniform_lutrow = uniformLocation("lutrow");
+          if (uniform_lutrow == -1)
+            std::cerr << "V330GLImageShader2D: Failed to bind lut row uniform " << std::endl;
+
           uniform_min = uniformLocation("texmin");
           if (uniform_min == -1)
             std::cerr << "V330GLImageShader2D: Failed to bind min uniform " << std::endl;
@@ -158,8 +235,9 @@ namespace ome
           if (uniform_max == -1)
             std::cerr << "V330GLImageShader2D: Failed to bind max uniform " << std::endl;
 
+          // Integer samplers are windowed without correction.
           uniform_corr = uniformLocation("correction");
-          if (uniform_corr == -1)
+          if (uniform_corr == -1 && sampler == FLOAT_SAMPLER)
             std::cerr << "V330GLImageShader2D: Failed to bind correction uniform " << std::endl;
         }
 
@@ -231,6 +309,12 @@ namespace ome
           check_gl("Set image texture");
         }
 
+        TexelSampler
+        GLImageShader2D::getSampler() const
+        {
+          return sampler;
+        }
+
         void
         GLImageShader2D::setMin(const glm::vec3& min)
         {
@@ -238,6 +322,20 @@ namespace ome
           check_gl("Set min range");
         }
 
+        void
+        GLImageShader2D::setMin(const glm::uvec3& min)
+        {
+          glUniform3uiv(uniform_min, 1, glm::value_ptr(min));
+          check_gl("Set min range");
+        }
+
+        void
+        GLImageShader2D::setMin(const glm::ivec3& min)
+        {
+          glUniform3iv(uniform_min, 1, glm::value_ptr(min));
+          check_gl("Set min range");
+        }
+
         void
         GLImageShader2D::setMax(const glm::vec3& max)
         {
@@ -245,6 +343,20 @@ namespace ome
           check_gl("Set max range");
         }
 
+        void
+        GLImageShader2D::setMax(const glm::uvec3& max)
+        {
+          glUniform3uiv(uniform_max, 1, glm::value_ptr(max));
+          check_gl("Set max range");
+        }
+
+        void
+        GLImageShader2D::setMax(const glm::ivec3& max)
+        {
+          glUniform3iv(uniform_max, 1, glm::value_ptr(max));
+          check_gl("Set max range");
+        }
+
         void
         GLImageShader2D::setCorrection(const glm::vec3& corr)
         {
@@ -259,6 +371,13 @@ namespace ome
           check_gl("Set LUT texture");
         }
 
+        void
+        GLImageShader2D::setLUTRow(int row)
+        {
+          glUniform1i(uniform_lutrow, row);
+          check_gl("Set LUT row");
+        }
+
         void
         GLImageShader2D::setModelViewProjection(const glm::mat4& mvp)
         {
@@ -45,6 +45,7 @@
 
 #include <ome/files/Types.h>
 
+#include <ome/qtwidgets/TexelProperties.h>
 #include <ome/qtwidgets/glm.h>
 
 namespace ome
@@ -60,6 +61,13 @@ namespace ome
 
         /**
          * 2D image shader program (simple, up to three channels).
+         *
+         * The fragment shader is generated for the sampler type of
+         * the texture.  Floating point textures are sampled with @c
+         * sampler2D and windowed using normalized contrast limits
+         * and a correction multiplier.  Integer textures are sampled
+         * raw with @c usampler2D or @c isampler2D and windowed
+         * exactly using contrast limits in sample values.
          */
         class GLImageShader2D : public QOpenGLShaderProgram,
                                 protected QOpenGLFunctions_3_3_Core
@@ -70,9 +78,11 @@ namespace ome
           /**
            * Constructor.
            *
+           * @param sampler the sampler type of the image texture.
            * @param parent the parent of this object.
            */
-          explicit GLImageShader2D(QObject *parent = 0);
+          explicit GLImageShader2D(TexelSampler  sampler = FLOAT_SAMPLER,
+                                   QObject      *parent = 0);
 
           /// Destructor.
           ~GLImageShader2D();
@@ -156,22 +166,74 @@ namespace ome
           void
           setTexture(int texunit);
 
+          /**
+           * Get the sampler type of the image texture.
+           *
+           * @returns the sampler type.
+           */
+          TexelSampler
+          getSampler() const;
+
           /**
            * Set minimum limits for linear contrast.
            *
+           * For use with floating point samplers.
+           *
            * @param min the RGB channel limits.
            */
           void
           setMin(const glm::vec3& min);
 
+          /**
+           * Set minimum limits for linear contrast.
+           *
+           * For use with unsigned integer samplers.
+           *
+           * @param min the RGB channel limits (sample values).
+           */
+          void
+          setMin(const glm::uvec3& min);
+
+          /**
+           * Set minimum limits for linear contrast.
+           *
+           * For use with signed integer samplers.
+           *
+           * @param min the RGB channel limits (sample values).
+           */
+          void
+          setMin(const glm::ivec3& min);
+
           /**
            * Set maximum limits for linear contrast.
            *
+           * For use with floating point samplers.
+           *
            * @param max the RGB channel limits.
            */
           void
           setMax(const glm::vec3& max);
 
+          /**
+           * Set maximum limits for linear contrast.
+           *
+           * For use with unsigned integer samplers.
+           *
+           * @param max the RGB channel limits (sample values).
+           */
+          void
+          setMax(const glm::uvec3& max);
+
+          /**
+           * Set maximum limits for linear contrast.
+           *
+           * For use with signed integer samplers.
+           *
+           * @param max the RGB channel limits (sample values).
+           */
+          void
+          setMax(const glm::ivec3& max);
+
           /**
            * Set correction multipliers to normalise pixel intensity.
            *
@@ -181,7 +243,8 @@ namespace ome
            * multiplying by 2^(16-12) = 2^4 = 16.  To leave
            * uncorrected, e.g. for float and complex types, and
            * integer types where the bits per sample is the same as
-           * the storage size, set to 1.0.
+           * the storage size, set to 1.0.  Not used by integer
+           * samplers.
            *
            * @param corr the RGB channel correction multipliers.
            */
@@ -196,6 +259,14 @@ namespace ome
           void
           setLUT(int texunit);
 
+          /**
+           * Set the LUT texture row to use.
+           *
+           * @param row the row of the LUT texture array.
+           */
+          void
+          setLUTRow(int row);
+
           /**
            * Set model view projection matrix.
            *
@@ -205,9 +276,11 @@ namespace ome
           setModelViewProjection(const glm::mat4& mvp);
 
         private:
-          /// The vertex shader.
+          /// The sampler type of the image texture.
+          TexelSampler sampler;
+          /// The vertex shader (null if restored from the program cache).
           QOpenGLShader *vshader;
-          /// The fragment shader.
+          /// The fragment shader (null if restored from the program cache).
           QOpenGLShader *fshader;
 
           /// Vertex coordinates attribute.
@@ -220,6 +293,8 @@ namespace ome
           int uniform_texture;
           /// LUT uniform.
           int uniform_lut;
+          /// LUT row uniform.
+          int uniform_lutrow;
           /// Minimum limits for linear contrast uniform.
           int uniform_min;
           /// Maximum limits for linear contrast uniform.
@@ -228,6 +303,29 @@ namespace ome
           int uniform_corr;
         };
 
+        /**
+         * 2D image shader program for a specific sampler type.
+         *
+         * Each variant is a distinct type, so that it may be shared
+         * using SharedResources::program().
+         *
+         * @tparam S the sampler type of the image texture.
+         */
+        template<TexelSampler S>
+        class GLImageShader2DVariant : public GLImageShader2D
+        {
+        public:
+          /**
+           * Constructor.
+           *
+           * @param parent the parent of this object.
+           */
+          explicit GLImageShader2DVariant(QObject *parent = 0):
+            GLImageShader2D(S, parent)
+          {
+          }
+        };
+
       }
     }
   }
@@ -39,6 +39,7 @@
 #include <ome/qtwidgets/glm.h>
 #include <ome/qtwidgets/glsl/v330/V330GLLineShader2D.h>
 #include <ome/qtwidgets/gl/Util.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
 
 #include <iostream>
 
@@ -63,57 +64,65 @@ namespace ome
         {
           initializeOpenGLFunctions();
 
-          vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
-          vshader->compileSourceCode
-            ("#version 330 core\n"
-             "\n"
-             "uniform mat4 mvp;\n"
-             "uniform float zoom;\n"
-             "\n"
-             "layout (location = 0) in vec3 coord2d;\n"
-             "layout (location = 1) in vec3 colour;\n"
-             "out VertexData\n"
-             "{\n"
-             "  vec4 f_colour;\n"
-             "} outData;\n"
-             "\n"
-             "void log10(in float v1, out float v2) { v2 = log2(v1) * 0.30103; }\n"
-             "\n"
-             "void main(void) {\n"
-             "  gl_Position = mvp * vec4(coord2d[0], coord2d[1], -2.0, 1.0);\n"
-             "  // Logistic function offset by LOD and correction factor to set the transition points\n"
-             "  float logzoom;\n"
-             "  log10(zoom, logzoom);\n"
-             "  outData.f_colour = vec4(colour, 1.0 / (1.0 + pow(10.0,((-logzoom-1.0+coord2d[2])*30.0))));\n"
-             "}\n");
-          if (!vshader->isCompiled())
+          static const char *vsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform mat4 mvp;\n"
+            "uniform float zoom;\n"
+            "\n"
+            "layout (location = 0) in vec3 coord2d;\n"
+            "layout (location = 1) in vec3 colour;\n"
+            "out VertexData\n"
+            "{\n"
+            "  vec4 f_colour;\n"
+            "} outData;\n"
+            "\n"
+            "void log10(in float v1, out float v2) { v2 = log2(v1) * 0.30103; }\n"
+            "\n"
+            "void main(void) {\n"
+            "  gl_Position = mvp * vec4(coord2d[0], coord2d[1], -2.0, 1.0);\n"
+            "  // Logistic function offset by LOD and correction factor to set the transition points\n"
+            "  float logzoom;\n"
+            "  log10(zoom, logzoom);\n"
+            "  outData.f_colour = vec4(colour, 1.0 / (1.0 + pow(10.0,((-logzoom-1.0+coord2d[2])*30.0))));\n"
+            "}\n";
+
+          static const char *fsource =
+            "#version 330 core\n"
+            "\n"
+            "in VertexData\n"
+            "{\n"
+            "  vec4 f_colour;\n"
+            "} inData;\n"
+            "\n"
+            "out vec4 outputColour;\n"
+            "\n"
+            "void main(void) {\n"
+            "  outputColour = inData.f_colour;\n"
+            "}\n";
+
+          ProgramCache cache("V330GLLineShader2D", {vsource, fsource});
+          if (!cache.load(*this))
             {
-              std::cerr << "V330GLLineShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+              vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
+              vshader->compileSourceCode(vsource);
+              if (!vshader->isCompiled())
+                {
+                  std::cerr << "V330GLLineShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+                }
+
+              fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
+              fshader->compileSourceCode(fsource);
+              if (!fshader->isCompiled())
+                {
+                  std::cerr << "V330GLLineShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
+                }
+
+              addShader(vshader);
+              addShader(fshader);
+              cache.link(*this);
             }
 
-          fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
-          fshader->compileSourceCode
-            ("#version 330 core\n"
-             "\n"
-             "in VertexData\n"
-             "{\n"
-             "  vec4 f_colour;\n"
-             "} inData;\n"
-             "\n"
-             "out vec4 outputColour;\n"
-             "\n"
-             "void main(void) {\n"
-             "  outputColour = inData.f_colour;\n"
-             "}\n");
-          if (!fshader->isCompiled())
-            {
-              std::cerr << "V330GLLineShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
-            }
-
-          addShader(vshader);
-          addShader(fshader);
-          link();
-
           if (!isLinked())
             {
               std::cerr << "V330GLLineShader2D: Failed to link shader program\n" << log().toStdString() << std::endl;
@@ -0,0 +1,191 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+#include <ome/qtwidgets/glm.h>
+#include <ome/qtwidgets/glsl/v330/V330GLPointShader2D.h>
+#include <ome/qtwidgets/gl/Util.h>
+#include <ome/qtwidgets/glsl/ProgramCache.h>
+
+#include <iostream>
+
+using ome::qtwidgets::gl::check_gl;
+
+namespace ome
+{
+  namespace qtwidgets
+  {
+    namespace glsl
+    {
+      namespace v330
+      {
+
+        GLPointShader2D::GLPointShader2D(QObject *parent):
+          QOpenGLShaderProgram(parent),
+          vshader(),
+          fshader(),
+          attr_coords(),
+          uniform_colour(),
+          uniform_mvp(),
+          uniform_pointsize()
+        {
+          initializeOpenGLFunctions();
+
+          static const char *vsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform mat4 mvp;\n"
+            "uniform float pointsize;\n"
+            "\n"
+            "layout (location = 0) in vec2 coord2d;\n"
+            "\n"
+            "void main(void) {\n"
+            "  gl_Position = mvp * vec4(coord2d, 0.5, 1.0);\n"
+            "  gl_PointSize = pointsize;\n"
+            "}\n";
+
+          static const char *fsource =
+            "#version 330 core\n"
+            "\n"
+            "uniform vec4 colour;\n"
+            "\n"
+            "out vec4 outputColour;\n"
+            "\n"
+            "void main(void) {\n"
+            "  // Round sprite.\n"
+            "  vec2 p = gl_PointCoord - vec2(0.5);\n"
+            "  if (dot(p, p) > 0.25)\n"
+            "    discard;\n"
+            "  outputColour = colour;\n"
+            "}\n";
+
+          ProgramCache cache("V330GLPointShader2D", {vsource, fsource});
+          if (!cache.load(*this))
+            {
+              vshader = new QOpenGLShader(QOpenGLShader::Vertex, this);
+              vshader->compileSourceCode(vsource);
+              if (!vshader->isCompiled())
+                {
+                  std::cerr << "V330GLPointShader2D: Failed to compile vertex shader\n" << vshader->log().toStdString() << std::endl;
+                }
+
+              fshader = new QOpenGLShader(QOpenGLShader::Fragment, this);
+              fshader->compileSourceCode(fsource);
+              if (!fshader->isCompiled())
+                {
+                  std::cerr << "V330GLPointShader2D: Failed to compile fragment shader\n" << fshader->log().toStdString() << std::endl;
+                }
+
+              addShader(vshader);
+              addShader(fshader);
+              cache.link(*this);
+            }
+
+          if (!isLinked())
+            {
+              std::cerr << "V330GLPointShader2D: Failed to link shader program\n" << log().toStdString() << std::endl;
+            }
+
+          attr_coords = attributeLocation("coord2d");
+          if (attr_coords == -1)
+            std::cerr << "V330GLPointShader2D: Failed to bind coordinate location" << std::endl;
+
+          uniform_colour = uniformLocation("colour");
+          if (uniform_colour == -1)
+            std::cerr << "V330GLPointShader2D: Failed to bind colour" << std::endl;
+
+          uniform_mvp = uniformLocation("mvp");
+          if (uniform_mvp == -1)
+            std::cerr << "V330GLPointShader2D: Failed to bind transform" << std::endl;
+
+          uniform_pointsize = uniformLocation("pointsize");
+          if (uniform_pointsize == -1)
+            std::cerr << "V330GLPointShader2D: Failed to bind point size" << std::endl;
+        }
+
+        GLPointShader2D::~GLPointShader2D()
+        {
+        }
+
+        void
+        GLPointShader2D::enableCoords()
+        {
+          enableAttributeArray(attr_coords);
+        }
+
+        void
+        GLPointShader2D::disableCoords()
+        {
+          disableAttributeArray(attr_coords);
+        }
+
+        void
+        GLPointShader2D::setCoords(QOpenGLBuffer& coords,
+                                   const GLfloat *offset,
+                                   int            tupleSize,
+                                   int            stride)
+        {
+          coords.bind();
+          setAttributeArray(attr_coords, offset, tupleSize, stride);
+          coords.release();
+        }
+
+        void
+        GLPointShader2D::setColour(const glm::vec4& colour)
+        {
+          glUniform4fv(uniform_colour, 1, glm::value_ptr(colour));
+          check_gl("Set point colour");
+        }
+
+        void
+        GLPointShader2D::setModelViewProjection(const glm::mat4& mvp)
+        {
+          glUniformMatrix4fv(uniform_mvp, 1, GL_FALSE, glm::value_ptr(mvp));
+          check_gl("Set point uniform mvp");
+        }
+
+        void
+        GLPointShader2D::setPointSize(float size)
+        {
+          glUniform1f(uniform_pointsize, size);
+          check_gl("Set point size");
+        }
+
+      }
+    }
+  }
+}
@@ -0,0 +1,440 @@
+/*
+ * #%L
+ * THUMBNAIL program for batch rendering of OME-Files pixel data.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+// Include first to avoid clash with Windows headers pulled in via
+// QtCore/qt_windows.h; they define VOID and HALFTONE which clash with
+// the TIFF enums.
+#include <ome/files/FormatReader.h>
+#include <ome/files/in/OMETIFFReader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <ome/files/PixelProperties.h>
+
+#include <ome/qtwidgets/LUT.h>
+#include <ome/qtwidgets/Thumbnail.h>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QByteArray>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QStringList>
+
+using ome::files::dimension_size_type;
+
+namespace
+{
+
+  /// A unit of work: a single plane, or a whole file to be expanded.
+  struct Job
+  {
+    /// Input file.
+    boost::filesystem::path file;
+    /// Expand into plane jobs?
+    bool expand;
+    /// Image series.
+    dimension_size_type series;
+    /// Image plane.
+    dimension_size_type plane;
+  };
+
+  /// Shared job queue and statistics.
+  class JobQueue
+  {
+  public:
+    JobQueue():
+      mutex(),
+      cond(),
+      jobs(),
+      active(0),
+      rendered(0),
+      skipped(0),
+      failed(0),
+      bytes(0)
+    {}
+
+    void
+    push(const Job& job)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(job);
+      cond.notify_one();
+    }
+
+    /// Push jobs for the file being processed to the front, to limit reader switching.
+    void
+    pushFront(const std::vector<Job>& newjobs)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (std::vector<Job>::const_reverse_iterator i = newjobs.rbegin();
+           i != newjobs.rend();
+           ++i)
+        jobs.push_front(*i);
+      cond.notify_all();
+    }
+
+    /**
+     * Get the next job.
+     *
+     * Blocks while other workers may still add jobs.
+     *
+     * @returns @c false if all work is complete.
+     */
+    bool
+    pop(Job& job)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (jobs.empty())
+        {
+          if (active == 0)
+            {
+              cond.notify_all();
+              return false;
+            }
+          cond.wait(lock);
+        }
+      job = jobs.front();
+      jobs.pop_front();
+      ++active;
+      return true;
+    }
+
+    /// Mark the current job of a worker as complete.
+    void
+    done()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      --active;
+      cond.notify_all();
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Job> jobs;
+    unsigned int active;
+
+  public:
+    /// Number of thumbnails rendered.
+    std::atomic<unsigned long> rendered;
+    /// Number of thumbnails skipped (up to date).
+    std::atomic<unsigned long> skipped;
+    /// Number of failures.
+    std::atomic<unsigned long> failed;
+    /// Pixel data bytes read.
+    std::atomic<unsigned long long> bytes;
+  };
+
+  /// Thumbnail settings.
+  struct Settings
+  {
+    boost::filesystem::path outdir;
+    QSize size;
+    bool allSeries;
+    bool allPlanes;
+    bool force;
+    ome::qtwidgets::LUT8 lut;
+  };
+
+  std::mutex log_mutex;
+
+  void
+  log(const std::string& message)
+  {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::cerr << message << std::endl;
+  }
+
+  /**
+   * Get the output path for a plane thumbnail.
+   *
+   * The name includes a hash of the canonical input path, so that
+   * inputs with the same filename in different directories do not
+   * share a thumbnail.
+   */
+  boost::filesystem::path
+  outputPath(const Settings&                settings,
+             const boost::filesystem::path& file,
+             dimension_size_type            series,
+             dimension_size_type            plane)
+  {
+    boost::system::error_code ec;
+    boost::filesystem::path canonical(boost::filesystem::canonical(file, ec));
+    if (ec)
+      canonical = boost::filesystem::absolute(file);
+
+    const std::string key(canonical.string());
+    QByteArray hash(QCryptographicHash::hash(QByteArray(key.data(), static_cast<int>(key.size())),
+                                             QCryptographicHash::Sha1).toHex().left(12));
+
+    std::ostringstream name;
+    name << file.filename().string() << '.' << hash.constData()
+         << ".s" << series << ".p" << plane << ".png";
+    return settings.outdir / name.str();
+  }
+
+  bool
+  upToDate(const boost::filesystem::path& input,
+           const boost::filesystem::path& output)
+  {
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(output, ec))
+      return false;
+    std::time_t intime = boost::filesystem::last_write_time(input, ec);
+    if (ec)
+      return false;
+    std::time_t outtime = boost::filesystem::last_write_time(output, ec);
+    if (ec)
+      return false;
+    return outtime >= intime;
+  }
+
+  /**
+   * Thumbnail worker.
+   *
+   * Each worker holds its own reader, which is retained while
+   * successive jobs refer to the same file.
+   */
+  class Worker
+  {
+  public:
+    Worker(JobQueue&       queue,
+           const Settings& settings):
+      queue(queue),
+      settings(settings),
+      reader(),
+      current()
+    {}
+
+    void
+    operator()()
+    {
+      Job job;
+      while (queue.pop(job))
+        {
+          try
+            {
+              if (job.expand)
+                expand(job);
+              else
+                render(job);
+            }
+          catch (const std::exception& e)
+            {
+              ++queue.failed;
+              log(job.file.string() + ": " + e.what());
+              reader.reset();
+              current.clear();
+            }
+          queue.done();
+        }
+      if (reader)
+        reader->close();
+    }
+
+  private:
+    void
+    open(const boost::filesystem::path& file)
+    {
+      if (reader && current == file)
+        return;
+
+      if (reader)
+        reader->close();
+      reader = std::make_shared<ome::files::in::OMETIFFReader>();
+      reader->setId(file);
+      current = file;
+    }
+
+    void
+    expand(const Job& job)
+    {
+      open(job.file);
+
+      std::vector<Job> planes;
+      dimension_size_type seriesCount = settings.allSeries ? reader->getSeriesCount() : 1;
+      for (dimension_size_type s = 0; s < seriesCount; ++s)
+        {
+          reader->setSeries(s);
+          dimension_size_type planeCount = settings.allPlanes ? reader->getImageCount() : 1;
+          for (dimension_size_type p = 0; p < planeCount; ++p)
+            {
+              if (!settings.force && upToDate(job.file, outputPath(settings, job.file, s, p)))
+                {
+                  ++queue.skipped;
+                  continue;
+                }
+              Job pj;
+              pj.file = job.file;
+              pj.expand = false;
+              pj.series = s;
+              pj.plane = p;
+              planes.push_back(pj);
+            }
+        }
+      reader->setSeries(0);
+
+      queue.pushFront(planes);
+    }
+
+    void
+    render(const Job& job)
+    {
+      open(job.file);
+
+      QImage thumb(ome::qtwidgets::renderThumbnail(*reader, job.series, job.plane,
+                                                   settings.size, settings.lut));
+      boost::filesystem::path out(outputPath(settings, job.file, job.series, job.plane));
+      if (thumb.isNull() || !thumb.save(QString::fromStdString(out.string()), "PNG"))
+        {
+          ++queue.failed;
+          log(out.string() + ": Failed to write thumbnail");
+        }
+      else
+        {
+          ++queue.rendered;
+          // The reader is left with the rendered series current.
+          dimension_size_type channel = reader->getZCTCoords(job.plane)[1];
+          queue.bytes += reader->getSizeX() * reader->getSizeY() * reader->getRGBChannelCount(channel) *
+            ome::files::bytesPerPixel(reader->getPixelType());
+        }
+    }
+
+    JobQueue& queue;
+    const Settings& settings;
+    std::shared_ptr<ome::files::FormatReader> reader;
+    boost::filesystem::path current;
+  };
+
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("thumbnail");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Render thumbnail images for OME-TIFF files");
+  parser.addHelpOption();
+  parser.addPositionalArgument("files", "Image files to render", "files...");
+
+  QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                  "Write thumbnails to <directory>.", "directory", ".");
+  QCommandLineOption sizeOption(QStringList() << "s" << "size",
+                                "Maximum thumbnail width and height.", "pixels", "256");
+  QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+                                "Number of worker threads (default: all cores).", "count", "0");
+  QCommandLineOption seriesOption("all-series", "Render all series (default: first series only).");
+  QCommandLineOption planesOption("all-planes", "Render all planes (default: first plane only).");
+  QCommandLineOption greyOption("grey", "Use a greyscale LUT (default: HiLo).");
+  QCommandLineOption forceOption(QStringList() << "f" << "force",
+                                 "Render even if the thumbnail is up to date.");
+  parser.addOption(outputOption);
+  parser.addOption(sizeOption);
+  parser.addOption(jobsOption);
+  parser.addOption(seriesOption);
+  parser.addOption(planesOption);
+  parser.addOption(greyOption);
+  parser.addOption(forceOption);
+  parser.process(app);
+
+  const QStringList files(parser.positionalArguments());
+  if (files.isEmpty())
+    parser.showHelp(1);
+
+  Settings settings;
+  settings.outdir = parser.value(outputOption).toStdString();
+  int size = parser.value(sizeOption).toInt();
+  settings.size = QSize(size > 0 ? size : 256, size > 0 ? size : 256);
+  settings.allSeries = parser.isSet(seriesOption);
+  settings.allPlanes = parser.isSet(planesOption);
+  settings.force = parser.isSet(forceOption);
+  settings.lut = parser.isSet(greyOption) ? ome::qtwidgets::greyLUT() : ome::qtwidgets::hiloLUT();
+
+  boost::filesystem::create_directories(settings.outdir);
+
+  unsigned int nthreads = parser.value(jobsOption).toUInt();
+  if (nthreads == 0)
+    nthreads = std::max(1U, std::thread::hardware_concurrency());
+
+  JobQueue queue;
+  for (const auto& file : files)
+    {
+      Job job;
+      job.file = file.toStdString();
+      job.expand = true;
+      job.series = 0;
+      job.plane = 0;
+      queue.push(job);
+    }
+
+  std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < nthreads; ++i)
+    workers.push_back(std::thread(Worker(queue, settings)));
+  for (auto& worker : workers)
+    worker.join();
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (elapsed <= 0.0)
+    elapsed = 1.0e-6;
+
+  std::cout << "Rendered " << queue.rendered << " thumbnails ("
+            << queue.skipped << " up to date, "
+            << queue.failed << " failed) in " << elapsed << " s using "
+            << nthreads << " threads\n"
+            << "Throughput: " << static_cast<double>(queue.rendered) / elapsed << " thumbnails/s, "
+            << (static_cast<double>(queue.bytes) / (1024.0 * 1024.0)) / elapsed << " MiB/s"
+            << std::endl;
+
+  return queue.failed ? 1 : 0;
+}
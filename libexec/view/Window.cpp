@@ -42,21 +42,39 @@
 #include <ome/files/FormatReader.h>
 #include <ome/files/in/OMETIFFReader.h>
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 
 #include <view/Window.h>
 
 #include <ome/common/module.h>
 
+#include <ome/qtwidgets/FrameExporter.h>
 #include <ome/qtwidgets/GLContainer.h>
+#include <ome/qtwidgets/LUT.h>
 #include <ome/qtwidgets/module.h>
+#include <ome/qtwidgets/ReaderOpener.h>
+#include <ome/qtwidgets/ReaderPool.h>
+#include <ome/qtwidgets/TiledExporter.h>
 
+#include <QtCore/QPointer>
+
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QDoubleSpinBox>
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMenuBar>
+#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QProgressDialog>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QStatusBar>
 #include <QtWidgets/QToolBar>
+#include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QFileDialog>
+#include <QtWidgets/QInputDialog>
 
 using namespace ome::qtwidgets;
 using ome::files::dimension_size_type;
@@ -98,6 +116,21 @@ namespace view
     openAction->setStatusTip(tr("Open an existing image file"));
     connect(openAction, SIGNAL(triggered()), this, SLOT(open()));
 
+    openLocalisationsAction = new QAction(tr("Open &localisations..."), this);
+    openLocalisationsAction->setStatusTip(tr("Overlay point localisations from a binary float table"));
+    openLocalisationsAction->setEnabled(false);
+    connect(openLocalisationsAction, SIGNAL(triggered()), this, SLOT(openLocalisations()));
+
+    exportMovieAction = new QAction(tr("&Export movie..."), this);
+    exportMovieAction->setStatusTip(tr("Render the planes along the playback axis to a movie or image sequence"));
+    exportMovieAction->setEnabled(false);
+    connect(exportMovieAction, SIGNAL(triggered()), this, SLOT(exportMovie()));
+
+    exportImageAction = new QAction(tr("Export &image..."), this);
+    exportImageAction->setStatusTip(tr("Render the current view to a large tiled TIFF image"));
+    exportImageAction->setEnabled(false);
+    connect(exportImageAction, SIGNAL(triggered()), this, SLOT(exportImage()));
+
     quitAction = new QAction(tr("&Quit"), this);
     quitAction->setShortcuts(QKeySequence::Quit);
     quitAction->setStatusTip(tr("Quit the application"));
@@ -138,6 +171,19 @@ namespace view
     viewRotateAction->setEnabled(false);
     connect(viewRotateAction, SIGNAL(triggered()), this, SLOT(view_rotate()));
 
+    viewAutoContrastAction = new QAction(tr("&Auto contrast"), this);
+    viewAutoContrastAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_A));
+    viewAutoContrastAction->setStatusTip(tr("Set contrast from the histogram of the current plane"));
+    viewAutoContrastAction->setEnabled(false);
+    connect(viewAutoContrastAction, SIGNAL(triggered()), this, SLOT(view_autocontrast()));
+
+    viewPlayAction = new QAction(tr("P&lay"), this);
+    viewPlayAction->setCheckable(true);
+    viewPlayAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_Space));
+    viewPlayAction->setStatusTip(tr("Play the current image along the playback dimension"));
+    viewPlayAction->setEnabled(false);
+    connect(viewPlayAction, SIGNAL(toggled(bool)), this, SLOT(view_play(bool)));
+
     viewActionGroup = new QActionGroup(this);
     viewActionGroup->addAction(viewZoomAction);
     viewActionGroup->addAction(viewPanAction);
@@ -149,6 +195,9 @@ namespace view
   {
     fileMenu = menuBar()->addMenu(tr("&File"));
     fileMenu->addAction(openAction);
+    fileMenu->addAction(openLocalisationsAction);
+    fileMenu->addAction(exportMovieAction);
+    fileMenu->addAction(exportImageAction);
     fileMenu->addSeparator();
     fileMenu->addAction(quitAction);
 
@@ -158,6 +207,9 @@ namespace view
     viewMenu->addAction(viewZoomAction);
     viewMenu->addAction(viewPanAction);
     viewMenu->addAction(viewRotateAction);
+    viewMenu->addSeparator();
+    viewMenu->addAction(viewAutoContrastAction);
+    viewMenu->addAction(viewPlayAction);
   }
 
   void Window::createToolbars()
@@ -197,6 +249,39 @@ namespace view
     layout->addWidget(maxLabel, 1, 0);
     layout->addWidget(maxSlider, 1, 1);
 
+    QLabel *lutLabel = new QLabel(tr("LUT"));
+    lutCombo = new QComboBox;
+    const std::vector<std::string>& lutNames(ome::qtwidgets::standardLUTNames());
+    for (const auto& name : lutNames)
+      lutCombo->addItem(QString::fromStdString(name));
+    lutCombo->setEnabled(false);
+    connect(lutCombo, SIGNAL(activated(const QString&)), this, SLOT(lutChanged(const QString&)));
+
+    layout->addWidget(lutLabel, 2, 0);
+    layout->addWidget(lutCombo, 2, 1);
+
+    QLabel *playLabel = new QLabel(tr("Playback"));
+    playAxisCombo = new QComboBox;
+    playAxisCombo->addItem(tr("T"), static_cast<int>(GLView2D::PLAYBACK_T));
+    playAxisCombo->addItem(tr("Z"), static_cast<int>(GLView2D::PLAYBACK_Z));
+    playAxisCombo->addItem(tr("mT"), static_cast<int>(GLView2D::PLAYBACK_MODULO_T));
+    playAxisCombo->addItem(tr("mZ"), static_cast<int>(GLView2D::PLAYBACK_MODULO_Z));
+    playAxisCombo->addItem(tr("mC"), static_cast<int>(GLView2D::PLAYBACK_MODULO_C));
+    playAxisCombo->setEnabled(false);
+    connect(playAxisCombo, SIGNAL(activated(int)), this, SLOT(playbackAxisChanged(int)));
+    playRateSpin = new QDoubleSpinBox;
+    playRateSpin->setRange(1.0, 240.0);
+    playRateSpin->setValue(10.0);
+    playRateSpin->setSuffix(tr(" fps"));
+    playRateSpin->setEnabled(false);
+    connect(playRateSpin, SIGNAL(valueChanged(double)), this, SLOT(playbackRateChanged(double)));
+
+    QHBoxLayout *playLayout = new QHBoxLayout;
+    playLayout->addWidget(playAxisCombo);
+    playLayout->addWidget(playRateSpin);
+    layout->addWidget(playLabel, 3, 0);
+    layout->addLayout(playLayout, 3, 1);
+
     QWidget *mainWidget = new QWidget(this);
     mainWidget->setLayout(layout);
     dock->setWidget(mainWidget);
@@ -245,17 +330,261 @@ namespace view
     QFileInfo info(file);
     if (info.exists())
       {
-        std::shared_ptr<ome::files::FormatReader> reader(std::make_shared<ome::files::in::OMETIFFReader>());
-        reader->setId(file.toStdString());
-        GLView2D *newGlView = new GLView2D(reader, 0, this);
-        QWidget *glContainer = new GLContainer(this, newGlView);
-        newGlView->setObjectName("glcontainer");
-        // We need a minimum size or else the size defaults to zero.
-        glContainer->setMinimumSize(512, 512);
-        tabs->addTab(glContainer, info.fileName());
-        newGlView->setChannelMin(6 *16);
-        newGlView->setChannelMax(100 * 16);
-        newGlView->setPlane(0);
+        const std::string path(file.toStdString());
+        ReaderPool::ReaderFactory factory([path]() -> std::shared_ptr<ome::files::FormatReader>
+                                          {
+                                            std::shared_ptr<ome::files::FormatReader> r(std::make_shared<ome::files::in::OMETIFFReader>());
+                                            r->setId(path);
+                                            return r;
+                                          });
+        // Readers are shared by all background tasks for the dataset.
+        // The reader opened for the view is used by the GUI thread
+        // only, and is not added to the pool.
+        std::shared_ptr<ReaderPool> pool(std::make_shared<ReaderPool>(factory));
+
+        // Show a placeholder tab while the metadata is read in the
+        // background.  Reader initialisation does not report its
+        // progress, so the progress bar only shows activity.
+        QWidget *placeholder = new QWidget(this);
+        QLabel *status = new QLabel(tr("Opening %1").arg(info.fileName()));
+        QProgressBar *busy = new QProgressBar;
+        busy->setRange(0, 0);
+        QPushButton *cancelButton = new QPushButton(tr("Cancel"));
+        QVBoxLayout *layout = new QVBoxLayout;
+        layout->addStretch();
+        layout->addWidget(status, 0, Qt::AlignCenter);
+        layout->addWidget(busy);
+        layout->addWidget(cancelButton, 0, Qt::AlignCenter);
+        layout->addStretch();
+        placeholder->setLayout(layout);
+        tabs->setCurrentIndex(tabs->addTab(placeholder, info.fileName()));
+
+        ReaderOpener *opener = new ReaderOpener(factory, 0, this);
+        QPointer<QWidget> tab(placeholder);
+        const QString name(info.fileName());
+        connect(cancelButton, &QPushButton::clicked, opener,
+                [this, opener, placeholder]()
+                {
+                  opener->cancel();
+                  tabs->removeTab(tabs->indexOf(placeholder));
+                  placeholder->deleteLater();
+                });
+        connect(opener, &ReaderOpener::finished, this,
+                [this, opener, tab, pool, name](bool success)
+                {
+                  opener->deleteLater();
+                  if (opener->isCancelled() || !tab)
+                    return;
+
+                  bool current = tabs->currentWidget() == tab;
+                  int index = tabs->indexOf(tab);
+                  tabs->removeTab(index);
+                  tab->deleteLater();
+                  if (success)
+                    {
+                      tabs->insertTab(index, createView(opener->getReader(), opener->getSeries(), pool), name);
+                      if (current)
+                        tabs->setCurrentIndex(index);
+                    }
+                  else
+                    QMessageBox::warning(this, tr("Open Image"),
+                                         tr("Failed to open %1: %2").arg(name).arg(opener->getError()));
+                });
+        opener->start();
+      }
+  }
+
+  QWidget *Window::createView(std::shared_ptr<ome::files::FormatReader> reader,
+                              ome::files::dimension_size_type           series,
+                              std::shared_ptr<ReaderPool>               pool)
+  {
+    GLView2D *newGlView = new GLView2D(reader, series, this);
+    QWidget *glContainer = new GLContainer(this, newGlView);
+    newGlView->setObjectName("glcontainer");
+    // We need a minimum size or else the size defaults to zero.
+    glContainer->setMinimumSize(512, 512);
+    newGlView->setPlane(0);
+    newGlView->autoContrast();
+
+    // Compute statistics for all planes in the background (or
+    // load them from the cache), and then use them for
+    // consistent contrast.
+    std::shared_ptr<DatasetStatistics> statistics(std::make_shared<DatasetStatistics>(pool, series));
+    connect(statistics.get(), SIGNAL(finished()), newGlView, SLOT(autoContrast()));
+    newGlView->setStatistics(statistics);
+    statistics->start();
+
+    // Decode planes ahead of playback in the background.
+    newGlView->setPlaneLoader(std::make_shared<PlaneLoader>(pool, series, 0));
+
+    return glContainer;
+  }
+
+  void Window::openLocalisations()
+  {
+    if (!glView)
+      return;
+
+    QString file = QFileDialog::getOpenFileName(this,
+                                                tr("Open Localisations"),
+                                                QString(),
+                                                QString(),
+                                                0,
+                                                QFileDialog::DontResolveSymlinks);
+    if (file.isEmpty())
+      return;
+
+    bool ok = false;
+    int columns = QInputDialog::getInt(this,
+                                       tr("Open Localisations"),
+                                       tr("Float columns per row (x and y first):"),
+                                       2, 2, 64, 1, &ok);
+    if (ok)
+      glView->setLocalisations(file, static_cast<unsigned int>(columns));
+  }
+
+  void Window::exportMovie()
+  {
+    if (!glView)
+      return;
+
+    QString selected;
+    QString file = QFileDialog::getSaveFileName(this,
+                                                tr("Export Movie"),
+                                                QString(),
+                                                tr("Y4M video (*.y4m);;PNG sequence (*.png)"),
+                                                &selected);
+    if (file.isEmpty())
+      return;
+
+    FrameExporter::Format format(selected.contains("*.png") ?
+                                 FrameExporter::FORMAT_PNG :
+                                 FrameExporter::FORMAT_Y4M);
+
+    QStringList sizes;
+    sizes << "1920x1080" << "1280x720" << "1024x1024" << "3840x2160";
+    bool ok = false;
+    QString sizeName = QInputDialog::getItem(this,
+                                             tr("Export Movie"),
+                                             tr("Frame size:"),
+                                             sizes, 0, false, &ok);
+    if (!ok)
+      return;
+    QStringList dims(sizeName.split('x'));
+    QSize size(dims.at(0).toInt(), dims.at(1).toInt());
+
+    std::vector<ome::files::dimension_size_type> planes(glView->getPlaybackPlanes());
+
+    FrameExporter *exporter = new FrameExporter(glView->getReader(), glView->getSeries(), size, this);
+    std::shared_ptr<PlaneLoader> loader(glView->getPlaneLoader());
+    if (loader)
+      exporter->setReaderPool(loader->getReaderPool());
+    exporter->setFrameRate(glView->getPlaybackRate());
+
+    // Show the same layers as the view.
+    exporter->getRenderer().setOverlayVisible(glView->getOverlayVisible());
+    QString points;
+    unsigned int columns = 2, xcolumn = 0, ycolumn = 1;
+    glView->getLocalisations(points, columns, xcolumn, ycolumn);
+    exporter->getRenderer().setLocalisations(points, columns, xcolumn, ycolumn);
+
+    QProgressDialog *progress = new QProgressDialog(tr("Exporting movie..."), tr("Cancel"),
+                                                    0, static_cast<int>(planes.size()), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(exporter, &FrameExporter::progress, progress,
+            [progress](quint64 done, quint64) { progress->setValue(static_cast<int>(done)); });
+    connect(progress, &QProgressDialog::canceled, exporter, &FrameExporter::cancel);
+    const quint64 total = planes.size();
+    connect(exporter, &FrameExporter::finished, this,
+            [this, exporter, progress, total](bool success)
+            {
+              progress->close();
+              if (success)
+                statusBar()->showMessage(tr("Exported %1 frames in %2 s")
+                                         .arg(total)
+                                         .arg(exporter->getElapsed() / 1000.0, 0, 'f', 1));
+              exporter->deleteLater();
+            });
+
+    std::pair<glm::vec3, glm::vec3> limits(glView->getContrastLimits());
+    if (!exporter->start(file, format, glView->getCamera(), planes,
+                         limits.first, limits.second, glView->getLUTRow()))
+      {
+        progress->close();
+        exporter->deleteLater();
+        QMessageBox::warning(this, tr("Export Movie"), tr("Failed to start export to %1").arg(file));
+      }
+  }
+
+  void Window::exportImage()
+  {
+    if (!glView)
+      return;
+
+    QString file = QFileDialog::getSaveFileName(this,
+                                                tr("Export Image"),
+                                                QString(),
+                                                tr("OME-TIFF image (*.ome.tiff *.ome.tif)"));
+    if (file.isEmpty())
+      return;
+
+    // Scale the view, preserving its aspect ratio.
+    QSizeF extent(glView->size());
+    bool ok = false;
+    int width = QInputDialog::getInt(this,
+                                     tr("Export Image"),
+                                     tr("Image width (pixels):"),
+                                     static_cast<int>(extent.width()) * 8,
+                                     16, 131072, 1, &ok);
+    if (!ok || extent.isEmpty())
+      return;
+    QSize size(width,
+               std::max(1, static_cast<int>(width * extent.height() / extent.width())));
+
+    TiledExporter *exporter = new TiledExporter(glView->getReader(), glView->getSeries(), 1024, this);
+    std::shared_ptr<PlaneLoader> loader(glView->getPlaneLoader());
+    if (loader)
+      exporter->getRenderer().setReaderPool(loader->getReaderPool());
+
+    // Show the same layers as the view.
+    exporter->getRenderer().setOverlayVisible(glView->getOverlayVisible());
+    QString points;
+    unsigned int columns = 2, xcolumn = 0, ycolumn = 1;
+    glView->getLocalisations(points, columns, xcolumn, ycolumn);
+    exporter->getRenderer().setLocalisations(points, columns, xcolumn, ycolumn);
+
+    QProgressDialog *progress = new QProgressDialog(tr("Exporting image..."), tr("Cancel"), 0, 1, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(exporter, &TiledExporter::progress, progress,
+            [progress](quint64 done, quint64 total)
+            {
+              progress->setMaximum(static_cast<int>(total));
+              progress->setValue(static_cast<int>(done));
+            });
+    connect(progress, &QProgressDialog::canceled, exporter, &TiledExporter::cancel);
+    connect(exporter, &TiledExporter::finished, this,
+            [this, exporter, progress, file, size](bool success)
+            {
+              bool cancelled = progress->wasCanceled();
+              progress->close();
+              if (success)
+                statusBar()->showMessage(tr("Exported %1x%2 image").arg(size.width()).arg(size.height()));
+              else if (!cancelled)
+                QMessageBox::warning(this, tr("Export Image"), tr("Failed to export image to %1").arg(file));
+              exporter->deleteLater();
+            });
+
+    std::pair<glm::vec3, glm::vec3> limits(glView->getContrastLimits());
+    if (!exporter->start(file, glView->getCamera(), extent, size, glView->getPlane(),
+                         limits.first, limits.second, glView->getLUTRow()))
+      {
+        progress->close();
+        exporter->deleteLater();
+        QMessageBox::warning(this, tr("Export Image"), tr("Failed to start export to %1").arg(file));
       }
   }
 
@@ -270,11 +599,17 @@ namespace view
     disconnect(maxSliderUpdate);
     disconnect(navigationChanged);
     disconnect(navigationUpdate);
+    disconnect(probeUpdate);
+    disconnect(playStateUpdate);
+    disconnect(playRateUpdate);
+    statusBar()->clearMessage();
 
     viewResetAction->setEnabled(false);
     viewZoomAction->setEnabled(false);
     viewPanAction->setEnabled(false);
     viewRotateAction->setEnabled(false);
+    viewAutoContrastAction->setEnabled(false);
+    viewPlayAction->setEnabled(false);
 
     if (newGlView)
       {
@@ -286,10 +621,22 @@ namespace view
         navigation->setReader(newGlView->getReader(), newGlView->getSeries(), newGlView->getPlane());
         navigationChanged = connect(navigation, SIGNAL(planeChanged(ome::files::dimension_size_type)), newGlView, SLOT(setPlane(ome::files::dimension_size_type)));
         navigationUpdate = connect(newGlView, SIGNAL(planeChanged(ome::files::dimension_size_type)), navigation, SLOT(setPlane(ome::files::dimension_size_type)));
+        probeUpdate = connect(newGlView, SIGNAL(pixelProbed(QPointF,QVector<double>)), this, SLOT(pixelProbed(QPointF,QVector<double>)));
+        playStateUpdate = connect(newGlView, SIGNAL(playbackStateChanged(bool)), this, SLOT(playbackStateChanged(bool)));
+        playRateUpdate = connect(newGlView, SIGNAL(playbackRateMeasured(double,quint64)), this, SLOT(playbackRateMeasured(double,quint64)));
 
         minSlider->setValue(newGlView->getChannelMin());
         maxSlider->setValue(newGlView->getChannelMax());
+        lutCombo->setCurrentText(QString::fromStdString(newGlView->getChannelLUT(newGlView->getChannel())));
         navigation->setPlane(newGlView->getPlane());
+        playAxisCombo->setCurrentIndex(playAxisCombo->findData(static_cast<int>(newGlView->getPlaybackDimension())));
+        // Update without applying to the previous view.
+        playRateSpin->blockSignals(true);
+        playRateSpin->setValue(newGlView->getPlaybackRate());
+        playRateSpin->blockSignals(false);
+        viewPlayAction->blockSignals(true);
+        viewPlayAction->setChecked(newGlView->isPlaying());
+        viewPlayAction->blockSignals(false);
       }
     else
       {
@@ -299,11 +646,25 @@ namespace view
     bool enable(newGlView != 0);
     minSlider->setEnabled(enable);
     maxSlider->setEnabled(enable);
+    lutCombo->setEnabled(enable);
+    playAxisCombo->setEnabled(enable);
+    playRateSpin->setEnabled(enable);
 
+    openLocalisationsAction->setEnabled(enable);
+    exportMovieAction->setEnabled(enable);
+    exportImageAction->setEnabled(enable);
     viewResetAction->setEnabled(enable);
     viewZoomAction->setEnabled(enable);
     viewPanAction->setEnabled(enable);
     viewRotateAction->setEnabled(enable);
+    viewAutoContrastAction->setEnabled(enable);
+    viewPlayAction->setEnabled(enable);
+    if (!enable)
+      {
+        viewPlayAction->blockSignals(true);
+        viewPlayAction->setChecked(false);
+        viewPlayAction->blockSignals(false);
+      }
 
     glView = newGlView;
   }
@@ -316,7 +677,8 @@ namespace view
         QWidget *w = tabs->currentWidget();
         if (w)
           {
-            GLContainer *container = static_cast<GLContainer *>(w);
+            // Placeholder tabs of files being opened have no view.
+            GLContainer *container = qobject_cast<GLContainer *>(w);
             if (container)
               current = static_cast<GLView2D *>(container->getWindow());
           }
@@ -324,6 +686,57 @@ namespace view
     viewFocusChanged(current);
   }
 
+  void Window::pixelProbed(QPointF imagepos, QVector<double> values)
+  {
+    if (values.isEmpty())
+      {
+        statusBar()->clearMessage();
+        return;
+      }
+
+    QString message(tr("x=%1 y=%2:")
+                    .arg(static_cast<long>(imagepos.x()))
+                    .arg(static_cast<long>(imagepos.y())));
+    for (QVector<double>::const_iterator v = values.begin(); v != values.end(); ++v)
+      message += QString(" %1").arg(*v, 0, 'g', 6);
+    statusBar()->showMessage(message);
+  }
+
+  void Window::lutChanged(const QString& name)
+  {
+    if (glView)
+      glView->setChannelLUT(glView->getChannel(), name.toStdString());
+  }
+
+  void Window::playbackAxisChanged(int index)
+  {
+    if (glView)
+      glView->setPlaybackDimension(static_cast<GLView2D::PlaybackDimension>(playAxisCombo->itemData(index).toInt()));
+  }
+
+  void Window::playbackRateChanged(double fps)
+  {
+    if (glView)
+      glView->setPlaybackRate(fps);
+  }
+
+  void Window::playbackStateChanged(bool playing)
+  {
+    viewPlayAction->blockSignals(true);
+    viewPlayAction->setChecked(playing);
+    viewPlayAction->blockSignals(false);
+    if (!playing)
+      statusBar()->clearMessage();
+  }
+
+  void Window::playbackRateMeasured(double fps, quint64 dropped)
+  {
+    statusBar()->showMessage(tr("Playback: %1 fps (target %2 fps), %3 frames dropped")
+                             .arg(fps, 0, 'f', 1)
+                             .arg(glView ? glView->getPlaybackRate() : 0.0, 0, 'f', 1)
+                             .arg(dropped));
+  }
+
   void Window::quit()
   {
     close();
@@ -358,4 +771,29 @@ namespace view
       glView->setMouseMode(GLView2D::MODE_ROTATE);
   }
 
+  void Window::view_autocontrast()
+  {
+    if (glView)
+      glView->autoContrast();
+  }
+
+  void Window::view_play(bool play)
+  {
+    if (!glView)
+      return;
+
+    if (play)
+      {
+        glView->play();
+        // Playback does not start if the dimension has only one position.
+        if (!glView->isPlaying())
+          {
+            viewPlayAction->setChecked(false);
+            statusBar()->showMessage(tr("Nothing to play along the selected dimension"), 2000);
+          }
+      }
+    else
+      glView->pause();
+  }
+
 }
@@ -43,8 +43,11 @@
 
 #include <ome/qtwidgets/GLView2D.h>
 #include <ome/qtwidgets/NavigationDock2D.h>
+#include <ome/qtwidgets/ReaderPool.h>
 
 QT_BEGIN_NAMESPACE
+class QComboBox;
+class QDoubleSpinBox;
 class QSlider;
 class QMenu;
 class QAction;
@@ -64,19 +67,33 @@ namespace view
   private slots:
     void open();
     void open(const QString& file);
+    void openLocalisations();
+    void exportMovie();
+    void exportImage();
     void quit();
     void view_reset();
     void view_zoom();
     void view_pan();
     void view_rotate();
+    void view_autocontrast();
+    void view_play(bool play);
+    void playbackAxisChanged(int index);
+    void playbackRateChanged(double fps);
+    void playbackStateChanged(bool playing);
+    void playbackRateMeasured(double fps, quint64 dropped);
+    void lutChanged(const QString& name);
     void viewFocusChanged(ome::qtwidgets::GLView2D *glView);
     void tabChanged(int index);
+    void pixelProbed(QPointF imagepos, QVector<double> values);
 
   private:
     void createActions();
     void createMenus();
     void createToolbars();
     void createDockWindows();
+    QWidget *createView(std::shared_ptr<ome::files::FormatReader> reader,
+                        ome::files::dimension_size_type           series,
+                        std::shared_ptr<ome::qtwidgets::ReaderPool> pool);
 
     QMenu *fileMenu;
     QMenu *viewMenu;
@@ -84,6 +101,9 @@ namespace view
     QToolBar *Cam2DTools;
 
     QAction *openAction;
+    QAction *openLocalisationsAction;
+    QAction *exportMovieAction;
+    QAction *exportImageAction;
     QAction *quitAction;
 
     QAction *viewResetAction;
@@ -92,6 +112,8 @@ namespace view
     QAction *viewZoomAction;
     QAction *viewPanAction;
     QAction *viewRotateAction;
+    QAction *viewAutoContrastAction;
+    QAction *viewPlayAction;
 
     QSlider *createAngleSlider();
     QSlider *createRangeSlider();
@@ -101,6 +123,9 @@ namespace view
     ome::qtwidgets::GLView2D *glView;
     QSlider *minSlider;
     QSlider *maxSlider;
+    QComboBox *lutCombo;
+    QComboBox *playAxisCombo;
+    QDoubleSpinBox *playRateSpin;
 
     QMetaObject::Connection minSliderChanged;
     QMetaObject::Connection minSliderUpdate;
@@ -108,6 +133,9 @@ namespace view
     QMetaObject::Connection maxSliderUpdate;
     QMetaObject::Connection navigationChanged;
     QMetaObject::Connection navigationUpdate;
+    QMetaObject::Connection probeUpdate;
+    QMetaObject::Connection playStateUpdate;
+    QMetaObject::Connection playRateUpdate;
   };
 
 }
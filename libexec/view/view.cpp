@@ -39,13 +39,20 @@
 #include <QApplication>
 #include <QDesktopWidget>
 
+#include <ome/qtwidgets/Trace.h>
+
 #include <view/Window.h>
 
 using namespace view;
 
 int main(int argc, char *argv[])
 {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+  // Share GL textures and shader programs between all views.
+  QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+#endif
   QApplication app(argc, argv);
+  ome::qtwidgets::setTraceThreadName("GUI");
   Window window;
   window.resize(600,600);
 
@@ -0,0 +1,435 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+// Include first to avoid clash with Windows headers pulled in via
+// QtCore/qt_windows.h; they define VOID and HALFTONE which clash with
+// the TIFF enums.
+#include <ome/files/FormatReader.h>
+#include <ome/files/in/OMETIFFReader.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <ome/files/CoreMetadata.h>
+#include <ome/files/MetadataTools.h>
+#include <ome/files/PixelBuffer.h>
+#include <ome/files/VariantPixelBuffer.h>
+#include <ome/files/out/OMETIFFWriter.h>
+
+#include <ome/xml/meta/OMEXMLMetadata.h>
+
+#include <ome/qtwidgets/Histogram.h>
+#include <ome/qtwidgets/MappedPlane.h>
+#include <ome/qtwidgets/SeriesInfo.h>
+#include <ome/qtwidgets/TexelProperties.h>
+#include <ome/qtwidgets/gl/v33/V33Grid2D.h>
+
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QSurfaceFormat>
+
+// Required with Boost 1.53 after variant include.
+#include <boost/preprocessor.hpp>
+
+using ome::files::dimension_size_type;
+using ome::files::PixelBuffer;
+using ome::files::PixelBufferBase;
+using ome::files::VariantPixelBuffer;
+using ome::qtwidgets::Histogram;
+using ome::qtwidgets::SeriesInfo;
+using ome::xml::model::enums::DimensionOrder;
+using ome::xml::model::enums::PixelType;
+
+namespace
+{
+
+  // Benchmark dataset dimensions.
+  const dimension_size_type dataset_xy = 128;
+  const dimension_size_type dataset_z = 5;
+  const dimension_size_type dataset_c = 3;
+  const dimension_size_type dataset_t = 20;
+
+  /*
+   * Uncompressed OME-TIFF dataset, written to a temporary file on
+   * first use.
+   */
+  class Dataset
+  {
+  public:
+    Dataset():
+      path(boost::filesystem::temp_directory_path() /
+           boost::filesystem::unique_path("ome-qtwidgets-benchmark-%%%%-%%%%.ome.tiff")),
+      reader()
+    {
+      std::shared_ptr<ome::xml::meta::OMEXMLMetadata> meta(std::make_shared<ome::xml::meta::OMEXMLMetadata>());
+      std::shared_ptr<ome::files::CoreMetadata> core(std::make_shared<ome::files::CoreMetadata>());
+      core->sizeX = dataset_xy;
+      core->sizeY = dataset_xy;
+      core->sizeZ = dataset_z;
+      core->sizeT = dataset_t;
+      core->sizeC.assign(dataset_c, 1);
+      core->imageCount = dataset_z * dataset_c * dataset_t;
+      core->pixelType = PixelType::UINT16;
+      core->interleaved = false;
+      core->bitsPerPixel = 16;
+      core->dimensionOrder = DimensionOrder::XYZCT;
+      std::vector<std::shared_ptr<ome::files::CoreMetadata>> seriesList;
+      seriesList.push_back(core);
+      ome::files::fillMetadata(*meta, seriesList);
+
+      std::shared_ptr<ome::files::out::OMETIFFWriter> writer(std::make_shared<ome::files::out::OMETIFFWriter>());
+      std::shared_ptr<ome::xml::meta::MetadataRetrieve> retrieve(std::static_pointer_cast<ome::xml::meta::MetadataRetrieve>(meta));
+      writer->setMetadataRetrieve(retrieve);
+      writer->setId(path);
+      writer->setSeries(0);
+
+      std::shared_ptr<PixelBuffer<uint16_t>> buffer
+        (std::make_shared<PixelBuffer<uint16_t>>(boost::extents[dataset_xy][dataset_xy][1][1][1][1][1][1][1],
+                                                 PixelType::UINT16));
+      VariantPixelBuffer vbuffer(buffer);
+      for (dimension_size_type p = 0; p < core->imageCount; ++p)
+        {
+          uint16_t *data = buffer->data();
+          for (std::size_t i = 0; i < buffer->num_elements(); ++i)
+            data[i] = static_cast<uint16_t>((i + p) % 4096U);
+          writer->saveBytes(p, vbuffer);
+        }
+      writer->close();
+
+      reader = std::make_shared<ome::files::in::OMETIFFReader>();
+      reader->setId(path);
+    }
+
+    ~Dataset()
+    {
+      reader->close();
+      boost::system::error_code ec;
+      boost::filesystem::remove(path, ec);
+    }
+
+    /// Dataset file.
+    boost::filesystem::path path;
+    /// Reader for the dataset.
+    std::shared_ptr<ome::files::FormatReader> reader;
+  };
+
+  /*
+   * Offscreen OpenGL 3.3 context, made current on creation.
+   */
+  class GLContext
+  {
+  public:
+    GLContext():
+      surface(),
+      context(),
+      current(false)
+    {
+      QSurfaceFormat format;
+      format.setVersion(3, 3);
+      format.setProfile(QSurfaceFormat::CoreProfile);
+      surface.setFormat(format);
+      surface.create();
+      context.setFormat(format);
+      current = context.create() && context.makeCurrent(&surface);
+    }
+
+    /// Offscreen surface.
+    QOffscreenSurface surface;
+    /// OpenGL context.
+    QOpenGLContext context;
+    /// Context is current.
+    bool current;
+  };
+
+  /*
+   * Grid exposing its geometry update.
+   */
+  class Grid : public ome::qtwidgets::gl::v33::Grid2D
+  {
+  public:
+    using ome::qtwidgets::gl::v33::Grid2D::Grid2D;
+    using ome::qtwidgets::gl::v33::Grid2D::setSize;
+  };
+
+  std::unique_ptr<Dataset> dataset_instance;
+  std::unique_ptr<GLContext> glcontext_instance;
+
+  Dataset&
+  dataset()
+  {
+    if (!dataset_instance)
+      dataset_instance.reset(new Dataset());
+    return *dataset_instance;
+  }
+
+  GLContext&
+  glcontext()
+  {
+    if (!glcontext_instance)
+      glcontext_instance.reset(new GLContext());
+    return *glcontext_instance;
+  }
+
+  /*
+   * Runtime texture property lookups for every pixel type, as made
+   * for each texture upload.
+   */
+  void
+  BM_TexelProperties(benchmark::State& state)
+  {
+    std::vector<PixelType> types;
+#define PIXELTYPE_ENTRY(maR, maProperty, maType)      \
+    types.push_back(PixelType::maType);
+    BOOST_PP_SEQ_FOR_EACH(PIXELTYPE_ENTRY, ~, OME_XML_MODEL_ENUMS_PIXELTYPE_VALUES);
+#undef PIXELTYPE_ENTRY
+
+    while (state.KeepRunning())
+      {
+        for (const auto& t : types)
+          {
+            benchmark::DoNotOptimize(ome::qtwidgets::textureInternalFormat(t));
+            benchmark::DoNotOptimize(ome::qtwidgets::textureExternalFormat(t));
+            benchmark::DoNotOptimize(ome::qtwidgets::textureExternalType(t));
+            benchmark::DoNotOptimize(ome::qtwidgets::textureConversionRequired(t));
+            benchmark::DoNotOptimize(ome::qtwidgets::textureSampler(t));
+          }
+      }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(types.size()));
+  }
+  BENCHMARK(BM_TexelProperties);
+
+  /*
+   * Reorder of a planar RGB plane to interleaved order, as done
+   * before texture upload.
+   */
+  void
+  BM_PlaneReorder(benchmark::State& state)
+  {
+    const dimension_size_type size = static_cast<dimension_size_type>(state.range(0));
+    PixelBuffer<uint16_t> planar(boost::extents[size][size][1][1][1][1][1][1][3],
+                                 PixelType::UINT16, ome::files::ENDIAN_NATIVE,
+                                 PixelBufferBase::make_storage_order(DimensionOrder::XYZTC, false));
+    PixelBuffer<uint16_t> interleaved(boost::extents[size][size][1][1][1][1][1][1][3],
+                                      PixelType::UINT16, ome::files::ENDIAN_NATIVE,
+                                      PixelBufferBase::make_storage_order(DimensionOrder::XYZTC, true));
+    std::fill(planar.data(), planar.data() + planar.num_elements(), uint16_t(1));
+
+    while (state.KeepRunning())
+      {
+        interleaved = planar;
+        benchmark::ClobberMemory();
+      }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(planar.num_elements() * sizeof(uint16_t)));
+  }
+  BENCHMARK(BM_PlaneReorder)->Arg(256)->Arg(1024)->Arg(2048);
+
+  /*
+   * Histogram of a single channel plane.  Arguments are the plane
+   * size and thread count (zero for the hardware concurrency).
+   */
+  template<typename T, PixelType::enum_value P>
+  void
+  BM_Histogram(benchmark::State& state)
+  {
+    const dimension_size_type size = static_cast<dimension_size_type>(state.range(0));
+    const unsigned int threads = static_cast<unsigned int>(state.range(1));
+    std::shared_ptr<PixelBuffer<T>> buffer
+      (std::make_shared<PixelBuffer<T>>(boost::extents[size][size][1][1][1][1][1][1][1], P));
+    T *data = buffer->data();
+    for (std::size_t i = 0; i < buffer->num_elements(); ++i)
+      data[i] = static_cast<T>(i % 4096U);
+    VariantPixelBuffer vbuffer(buffer);
+
+    Histogram histogram;
+    while (state.KeepRunning())
+      histogram.compute(vbuffer, threads);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(buffer->num_elements()));
+  }
+  BENCHMARK_TEMPLATE(BM_Histogram, uint8_t, PixelType::UINT8)->Args({1024, 1})->Args({1024, 0});
+  BENCHMARK_TEMPLATE(BM_Histogram, uint16_t, PixelType::UINT16)->Args({1024, 1})->Args({1024, 0});
+  BENCHMARK_TEMPLATE(BM_Histogram, float, PixelType::FLOAT)->Args({1024, 1})->Args({1024, 0});
+
+  /*
+   * Plane index to ZCT coordinate mapping, and back, for all
+   * planes, as made by the navigation controls.
+   */
+  void
+  BM_SeriesInfoZCT(benchmark::State& state)
+  {
+    std::shared_ptr<const SeriesInfo> info(SeriesInfo::get(dataset().reader, 0));
+
+    while (state.KeepRunning())
+      {
+        for (dimension_size_type p = 0; p < info->imageCount; ++p)
+          {
+            const SeriesInfo::Coords& zct(info->getZCTCoords(p));
+            benchmark::DoNotOptimize(info->getIndex(zct[0], zct[1], zct[2]));
+          }
+      }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(info->imageCount));
+  }
+  BENCHMARK(BM_SeriesInfoZCT);
+
+  /*
+   * The same mapping made directly with the reader.
+   */
+  void
+  BM_ReaderZCT(benchmark::State& state)
+  {
+    std::shared_ptr<ome::files::FormatReader> reader(dataset().reader);
+    const dimension_size_type count = reader->getImageCount();
+
+    while (state.KeepRunning())
+      {
+        for (dimension_size_type p = 0; p < count; ++p)
+          {
+            SeriesInfo::Coords zct(reader->getZCTCoords(p));
+            benchmark::DoNotOptimize(reader->getIndex(zct[0], zct[1], zct[2]));
+          }
+      }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+  }
+  BENCHMARK(BM_ReaderZCT);
+
+  /*
+   * Building the series metadata snapshot.
+   */
+  void
+  BM_SeriesInfoBuild(benchmark::State& state)
+  {
+    std::shared_ptr<ome::files::FormatReader> reader(dataset().reader);
+
+    while (state.KeepRunning())
+      {
+        SeriesInfo info(*reader, 0);
+        benchmark::DoNotOptimize(info.imageCount);
+      }
+  }
+  BENCHMARK(BM_SeriesInfoBuild);
+
+  /*
+   * Decoding a plane with the reader.
+   */
+  void
+  BM_OpenBytes(benchmark::State& state)
+  {
+    std::shared_ptr<ome::files::FormatReader> reader(dataset().reader);
+    const dimension_size_type count = reader->getImageCount();
+    VariantPixelBuffer buffer;
+
+    dimension_size_type plane = 0;
+    while (state.KeepRunning())
+      {
+        reader->openBytes(plane, buffer);
+        plane = (plane + 1) % count;
+      }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dataset_xy * dataset_xy * sizeof(uint16_t)));
+  }
+  BENCHMARK(BM_OpenBytes);
+
+  /*
+   * Mapping a plane directly from the file.
+   */
+  void
+  BM_MapPlane(benchmark::State& state)
+  {
+    std::shared_ptr<ome::files::FormatReader> reader(dataset().reader);
+    const dimension_size_type count = reader->getImageCount();
+    if (!ome::qtwidgets::mapPlane(reader, 0, 0))
+      {
+        state.SkipWithError("Plane can not be mapped");
+        return;
+      }
+
+    dimension_size_type plane = 0;
+    while (state.KeepRunning())
+      {
+        benchmark::DoNotOptimize(ome::qtwidgets::mapPlane(reader, 0, plane));
+        plane = (plane + 1) % count;
+      }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dataset_xy * dataset_xy * sizeof(uint16_t)));
+  }
+  BENCHMARK(BM_MapPlane);
+
+  /*
+   * Grid geometry update across image extents.
+   */
+  void
+  BM_GridSetSize(benchmark::State& state)
+  {
+    if (!glcontext().current)
+      {
+        state.SkipWithError("OpenGL 3.3 context not available");
+        return;
+      }
+
+    Grid grid(dataset().reader, 0);
+    const float extent = static_cast<float>(state.range(0));
+    while (state.KeepRunning())
+      grid.setSize(glm::vec2(-extent, extent), glm::vec2(-extent * 0.75f, extent * 0.75f));
+  }
+  BENCHMARK(BM_GridSetSize)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+}
+
+int
+main(int argc, char *argv[])
+{
+  // Required for the OpenGL context.
+  QGuiApplication app(argc, argv);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+
+  glcontext_instance.reset();
+  dataset_instance.reset();
+  return 0;
+}
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */
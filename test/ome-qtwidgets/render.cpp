@@ -0,0 +1,507 @@
+/*
+ * #%L
+ * OME-QTWIDGETS C++ library for display of OME-Files pixel data and metadata.
+ * %%
+ * Copyright © 2014 - 2015 Open Microscopy Environment:
+ *   - Massachusetts Institute of Technology
+ *   - National Institutes of Health
+ *   - University of Dundee
+ *   - Board of Regents of the University of Wisconsin-Madison
+ *   - Glencoe Software, Inc.
+ * %%
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of any organization.
+ * #L%
+ */
+
+// Include first to avoid clash with Windows headers pulled in via
+// QtCore/qt_windows.h; they define VOID and HALFTONE which clash with
+// the TIFF enums.
+#include <ome/files/FormatReader.h>
+#include <ome/files/in/OMETIFFReader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <ome/files/CoreMetadata.h>
+#include <ome/files/MetadataTools.h>
+#include <ome/files/PixelBuffer.h>
+#include <ome/files/VariantPixelBuffer.h>
+#include <ome/files/out/OMETIFFWriter.h>
+
+#include <ome/xml/meta/OMEXMLMetadata.h>
+
+#include <ome/qtwidgets/Camera2D.h>
+#include <ome/qtwidgets/OffscreenRenderer2D.h>
+
+#include <ome/test/test.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QImage>
+
+using ome::files::dimension_size_type;
+using ome::files::PixelBuffer;
+using ome::files::PixelBufferBase;
+using ome::files::VariantPixelBuffer;
+using ome::qtwidgets::Camera2D;
+using ome::qtwidgets::OffscreenRenderer2D;
+using ome::xml::model::enums::DimensionOrder;
+using ome::xml::model::enums::PixelType;
+
+/*
+ * Golden-image and frame-time regression tests.
+ *
+ * Synthetic datasets are rendered offscreen, as by GLView2D, and
+ * compared with golden images.  Frame and upload times are measured
+ * and compared with a timing baseline.  A missing golden image is a
+ * test failure; golden images are only recorded when
+ * OME_QTWIDGETS_GOLDEN_UPDATE is "true".  Golden images are kept in
+ * the source tree.  Timing baselines are specific to the machine
+ * and are kept in the build tree; a missing baseline is recorded by
+ * the first run, and later runs are compared with it.
+ *
+ * Environment:
+ * - OME_QTWIDGETS_GOLDEN_DIR: golden image directory.
+ * - OME_QTWIDGETS_TIMING_DIR: timing baseline directory.
+ * - OME_QTWIDGETS_GOLDEN_UPDATE: "true" to record new references.
+ * - OME_QTWIDGETS_RENDER_THRESHOLD: permitted median time regression
+ *   as a fraction of the baseline.
+ */
+
+namespace
+{
+
+  // Render target size.
+  const int frame_size = 256;
+  // Dataset plane size and count.
+  const dimension_size_type dataset_xy = 192;
+  const dimension_size_type dataset_planes = 16;
+  // Renders of a cached plane for the frame time distribution.
+  const unsigned int frame_count = 64;
+  // Largest per-sample difference from the golden image which is
+  // not counted as a mismatch.
+  const int pixel_tolerance = 2;
+  // Largest fraction of mismatched pixels.
+  const double mismatch_tolerance = 0.005;
+  // Time differences below this are noise (ms).
+  const double time_noise = 0.5;
+
+  /*
+   * Qt application required for offscreen surfaces.
+   */
+  class QtEnvironment : public ::testing::Environment
+  {
+  public:
+    void
+    SetUp()
+    {
+      static int argc = 1;
+      static char name[] = "ome-qtwidgets-render";
+      static char *argv[] = { name, 0 };
+      app.reset(new QGuiApplication(argc, argv));
+    }
+
+    void
+    TearDown()
+    {
+      app.reset();
+    }
+
+  private:
+    std::unique_ptr<QGuiApplication> app;
+  };
+
+  QString
+  environment(const char     *name,
+              const QString&  fallback)
+  {
+    const char *value = std::getenv(name);
+    return value && *value ? QString::fromLocal8Bit(value) : fallback;
+  }
+
+  QString
+  golden_dir()
+  {
+    return environment("OME_QTWIDGETS_GOLDEN_DIR", PROJECT_SOURCE_DIR "/test/ome-qtwidgets/golden");
+  }
+
+  QString
+  timing_dir()
+  {
+    return environment("OME_QTWIDGETS_TIMING_DIR", PROJECT_BINARY_DIR "/test/ome-qtwidgets/timing");
+  }
+
+  bool
+  golden_update()
+  {
+    return environment("OME_QTWIDGETS_GOLDEN_UPDATE", "false") == "true";
+  }
+
+  double
+  regression_threshold()
+  {
+    return environment("OME_QTWIDGETS_RENDER_THRESHOLD", "0.25").toDouble();
+  }
+
+  /*
+   * Synthetic sample value, as a fraction of the type range.  The
+   * pattern is asymmetric so that flips and rotations are detected.
+   */
+  double
+  pattern(dimension_size_type x,
+          dimension_size_type y,
+          dimension_size_type s,
+          dimension_size_type plane)
+  {
+    return static_cast<double>(((x * 3) + (y * 5) + (s * 64) + (plane * 17)) % 256) / 255.0;
+  }
+
+  /// Scene parameters.
+  struct Scene
+  {
+    /// Scene name.
+    const char *name;
+    /// Pixel type.
+    PixelType::enum_value pixelType;
+    /// Samples per pixel.
+    dimension_size_type samples;
+    /// Largest sample value.
+    double range;
+    /// Camera zoom (negative values minify, exercising mipmaps).
+    int zoom;
+  };
+
+  std::ostream&
+  operator<< (std::ostream& os,
+              const Scene&  scene)
+  {
+    return os << scene.name;
+  }
+
+  /*
+   * Write a synthetic OME-TIFF dataset.
+   */
+  template<typename T>
+  void
+  write_dataset(const boost::filesystem::path& path,
+                const Scene&                   scene)
+  {
+    std::shared_ptr<ome::xml::meta::OMEXMLMetadata> meta(std::make_shared<ome::xml::meta::OMEXMLMetadata>());
+    std::shared_ptr<ome::files::CoreMetadata> core(std::make_shared<ome::files::CoreMetadata>());
+    core->sizeX = dataset_xy;
+    core->sizeY = dataset_xy;
+    core->sizeT = dataset_planes;
+    core->sizeC.assign(1, scene.samples);
+    core->imageCount = dataset_planes;
+    core->pixelType = scene.pixelType;
+    core->interleaved = true;
+    core->bitsPerPixel = static_cast<ome::files::pixel_size_type>(sizeof(T) * 8);
+    core->dimensionOrder = DimensionOrder::XYZTC;
+    std::vector<std::shared_ptr<ome::files::CoreMetadata>> seriesList;
+    seriesList.push_back(core);
+    ome::files::fillMetadata(*meta, seriesList);
+
+    std::shared_ptr<ome::files::out::OMETIFFWriter> writer(std::make_shared<ome::files::out::OMETIFFWriter>());
+    std::shared_ptr<ome::xml::meta::MetadataRetrieve> retrieve(std::static_pointer_cast<ome::xml::meta::MetadataRetrieve>(meta));
+    writer->setMetadataRetrieve(retrieve);
+    writer->setInterleaved(true);
+    writer->setId(path);
+    writer->setSeries(0);
+
+    std::shared_ptr<PixelBuffer<T>> buffer
+      (std::make_shared<PixelBuffer<T>>(boost::extents[dataset_xy][dataset_xy][1][1][1][1][1][1][scene.samples],
+                                        scene.pixelType, ome::files::ENDIAN_NATIVE,
+                                        PixelBufferBase::make_storage_order(DimensionOrder::XYZTC, true)));
+    VariantPixelBuffer vbuffer(buffer);
+    for (dimension_size_type p = 0; p < dataset_planes; ++p)
+      {
+        T *data = buffer->data();
+        for (dimension_size_type y = 0; y < dataset_xy; ++y)
+          for (dimension_size_type x = 0; x < dataset_xy; ++x)
+            for (dimension_size_type s = 0; s < scene.samples; ++s)
+              *data++ = static_cast<T>(pattern(x, y, s, p) * scene.range);
+        writer->saveBytes(p, vbuffer);
+      }
+    writer->close();
+  }
+
+  /// Summary of a time distribution (ms).
+  struct Timing
+  {
+    /// Median.
+    double median;
+    /// 90th percentile.
+    double p90;
+    /// Maximum.
+    double max;
+  };
+
+  Timing
+  summarise(std::vector<double> times)
+  {
+    Timing timing = { 0.0, 0.0, 0.0 };
+    if (times.empty())
+      return timing;
+    std::sort(times.begin(), times.end());
+    timing.median = times[times.size() / 2];
+    timing.p90 = times[(times.size() * 9) / 10];
+    timing.max = times.back();
+    return timing;
+  }
+
+  QJsonObject
+  to_json(const Timing& timing)
+  {
+    QJsonObject object;
+    object["median"] = timing.median;
+    object["p90"] = timing.p90;
+    object["max"] = timing.max;
+    return object;
+  }
+
+  /*
+   * Compare a frame with a golden image.
+   *
+   * @returns the fraction of mismatched pixels.
+   */
+  double
+  mismatch(const QImage& frame,
+           const QImage& golden)
+  {
+    QImage a(frame.convertToFormat(QImage::Format_RGBA8888));
+    QImage b(golden.convertToFormat(QImage::Format_RGBA8888));
+    if (a.size() != b.size())
+      return 1.0;
+
+    std::size_t count = 0;
+    for (int y = 0; y < a.height(); ++y)
+      {
+        const uchar *ra = a.constScanLine(y);
+        const uchar *rb = b.constScanLine(y);
+        for (int x = 0; x < a.width() * 4; x += 4)
+          for (int c = 0; c < 4; ++c)
+            if (std::abs(static_cast<int>(ra[x + c]) - static_cast<int>(rb[x + c])) > pixel_tolerance)
+              {
+                ++count;
+                break;
+              }
+      }
+    return static_cast<double>(count) / static_cast<double>(a.width() * a.height());
+  }
+
+  double
+  elapsed_ms(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+}
+
+::testing::Environment *qt_environment = ::testing::AddGlobalTestEnvironment(new QtEnvironment);
+
+class RenderTest : public ::testing::TestWithParam<Scene>
+{
+public:
+  boost::filesystem::path path;
+  std::shared_ptr<ome::files::FormatReader> reader;
+
+  virtual void
+  SetUp()
+  {
+    const Scene& scene(GetParam());
+    path = boost::filesystem::path(PROJECT_BINARY_DIR "/test/ome-qtwidgets") /
+      (std::string("render-") + scene.name + ".ome.tiff");
+
+    switch(scene.pixelType)
+      {
+      case PixelType::UINT8:
+        write_dataset<uint8_t>(path, scene);
+        break;
+      case PixelType::UINT16:
+        write_dataset<uint16_t>(path, scene);
+        break;
+      case PixelType::FLOAT:
+        write_dataset<float>(path, scene);
+        break;
+      default:
+        FAIL() << "Unsupported pixel type";
+      }
+
+    reader = std::make_shared<ome::files::in::OMETIFFReader>();
+    reader->setId(path);
+  }
+
+  virtual void
+  TearDown()
+  {
+    if (reader)
+      reader->close();
+    boost::system::error_code ec;
+    boost::filesystem::remove(path, ec);
+  }
+};
+
+TEST_P(RenderTest, GoldenImage)
+{
+  const Scene& scene(GetParam());
+
+  OffscreenRenderer2D renderer(reader, 0, QSize(frame_size, frame_size));
+  ASSERT_TRUE(renderer.isValid());
+
+  Camera2D camera;
+  camera.zoom = scene.zoom;
+  QImage frame(renderer.render(camera, 0, glm::vec3(0.0f), glm::vec3(1.0f)));
+  ASSERT_FALSE(frame.isNull());
+
+  QString golden(golden_dir() + "/" + scene.name + ".png");
+  if (golden_update())
+    {
+      QDir().mkpath(golden_dir());
+      ASSERT_TRUE(frame.save(golden));
+      std::cout << "Recorded golden image " << golden.toStdString() << std::endl;
+      return;
+    }
+  ASSERT_TRUE(QFile::exists(golden))
+    << "Missing golden image " << golden.toStdString()
+    << "; record with OME_QTWIDGETS_GOLDEN_UPDATE=true";
+
+  QImage reference(golden);
+  ASSERT_FALSE(reference.isNull());
+  double fraction = mismatch(frame, reference);
+  if (fraction > mismatch_tolerance)
+    {
+      QString actual(QString(PROJECT_BINARY_DIR "/test/ome-qtwidgets/render-%1.png").arg(scene.name));
+      frame.save(actual);
+      ADD_FAILURE() << "Frame differs from " << golden.toStdString()
+                    << " in " << fraction * 100.0 << "% of pixels; rendered frame saved as "
+                    << actual.toStdString();
+    }
+}
+
+TEST_P(RenderTest, FrameTime)
+{
+  const Scene& scene(GetParam());
+
+  OffscreenRenderer2D renderer(reader, 0, QSize(frame_size, frame_size));
+  ASSERT_TRUE(renderer.isValid());
+
+  Camera2D camera;
+  camera.zoom = scene.zoom;
+  std::vector<uint8_t> pixels;
+
+  // The first render of each plane includes the texture upload.
+  std::vector<double> upload;
+  for (dimension_size_type p = 0; p < dataset_planes; ++p)
+    {
+      std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+      renderer.render(camera, p, glm::vec3(0.0f), glm::vec3(1.0f), pixels);
+      upload.push_back(elapsed_ms(start));
+    }
+
+  std::vector<double> frames;
+  for (unsigned int f = 0; f < frame_count; ++f)
+    {
+      std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+      renderer.render(camera, f % dataset_planes, glm::vec3(0.0f), glm::vec3(1.0f), pixels);
+      frames.push_back(elapsed_ms(start));
+    }
+  ASSERT_FALSE(pixels.empty());
+
+  Timing uploadTiming(summarise(upload));
+  Timing frameTiming(summarise(frames));
+
+  QJsonObject current;
+  current["upload"] = to_json(uploadTiming);
+  current["frame"] = to_json(frameTiming);
+
+  // Record the distributions for comparison between runs.
+  QFile out(QString(PROJECT_BINARY_DIR "/test/ome-qtwidgets/render-%1-timing.json").arg(scene.name));
+  if (out.open(QIODevice::WriteOnly))
+    out.write(QJsonDocument(current).toJson());
+
+  QString baselineFile(timing_dir() + "/" + scene.name + "-timing.json");
+  if (golden_update() || !QFile::exists(baselineFile))
+    {
+      QDir().mkpath(timing_dir());
+      QFile baselineOut(baselineFile);
+      ASSERT_TRUE(baselineOut.open(QIODevice::WriteOnly));
+      baselineOut.write(QJsonDocument(current).toJson());
+      std::cout << "Recorded timing baseline " << baselineFile.toStdString() << std::endl;
+      return;
+    }
+  QFile in(baselineFile);
+  ASSERT_TRUE(in.open(QIODevice::ReadOnly))
+    << "Failed to read timing baseline " << baselineFile.toStdString();
+
+  QJsonObject baseline(QJsonDocument::fromJson(in.readAll()).object());
+  const double threshold = regression_threshold();
+  const char *kinds[] = { "upload", "frame" };
+  for (const char *kind : kinds)
+    {
+      double reference = baseline[kind].toObject()["median"].toDouble();
+      double measured = current[kind].toObject()["median"].toDouble();
+      if (reference > 0.0 &&
+          measured > reference * (1.0 + threshold) &&
+          measured - reference > time_noise)
+        ADD_FAILURE() << scene.name << " " << kind << " median time regressed from "
+                      << reference << " ms to " << measured << " ms (threshold "
+                      << threshold * 100.0 << "%)";
+    }
+}
+
+const Scene scenes[] =
+  {
+    { "uint8", PixelType::UINT8, 1, 255.0, 0 },
+    { "uint16", PixelType::UINT16, 1, 65535.0, 0 },
+    { "float", PixelType::FLOAT, 1, 1.0, 0 },
+    { "rgb8", PixelType::UINT8, 3, 255.0, 0 },
+    { "uint8-minified", PixelType::UINT8, 1, 255.0, -600 },
+    { "uint16-minified", PixelType::UINT16, 1, 65535.0, -600 }
+  };
+
+// Work around a missing prototype in INSTANTIATE_TEST_CASE_P.
+#ifdef __GNUC__
+#  pragma GCC diagnostic ignored "-Wmissing-declarations"
+#endif
+
+INSTANTIATE_TEST_CASE_P(RenderVariants, RenderTest, ::testing::ValuesIn(scenes));
+
+/*
+ * Local Variables:
+ * mode:C++
+ * End:
+ */